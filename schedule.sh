@@ -27,7 +27,7 @@ ising_1d() {
 ising_2d() {
     echo -e "\033[31mRunning 2D simulations:\033[37m"
     out/ising 2d first_and_last configs/first_and_last_ising_2d.toml
-    python src/plots/question_2.py first_and_last pub/data/first_and_last_ising_2d.csv
+    python src/plots/question_2.py first_and_last
     echo -e "\t - First and last!"
     out/ising 2d physical_parameters configs/physical_parameters_ising_2d.toml
     echo -e "\t - Physical Parameters!"
@@ -38,8 +38,16 @@ ising_2d() {
 }
 
 
+ising_nd() {
+    echo -e "\033[31mRunning ND simulations:\033[37m"
+    out/ising nd physical_parameters configs/physical_parameters_ising_nd.toml
+    echo -e "\t - Physical Parameters!"
+}
+
+
 schedule() {
     ising_1d
     ising_2d
+    ising_nd
     plot
 }
@@ -2,8 +2,14 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include"include/toml.h"
+#include"include/rng.h"
 #include"include/utils.h"
 #include"include/1d_ising.h"
+#include"include/accumulator.h"
+#include"include/geometry.h"
+#include"include/kernels.h"
+#include"include/telemetry.h"
+#include"include/equilibration.h"
 
 
 
@@ -23,20 +29,150 @@
  */
 Ising1D* init_ising_1d(int length, float temperature)
 {
-    int *ensemble = (int*) calloc(length, sizeof(int));
+    Ising1D* system = (Ising1D*) malloc(sizeof(Ising1D));
+    split_random(&system -> random);
+
+    Geometry *geometry = init_geometry(CHAIN_SHAPE, length, 1, 1);
+    int8_t *ensemble = (int8_t*) malloc(length * sizeof(int8_t));
     for (int spin = 0; spin < length; spin++)
     {
-        ensemble[spin] = random_spin();
+        ensemble[spin] = random_spin(&system -> random);
     }
 
-    Ising1D* system = (Ising1D*) malloc(sizeof(Ising1D));
     system -> length = length;
     system -> temperature = temperature;
+    system -> geometry = geometry;
     system -> ensemble = ensemble;
+    build_transitions(&system -> transitions, METROPOLIS, 2, temperature, 1., 0.);
+    recount_ising_1d(system);
     return system;
 }
 
 
+/*
+ * free_ising_1d
+ * -------------
+ * Release the spins and the ring of a system.
+ *
+ * parameters
+ * ----------
+ * Ising1D *system: The system to free.
+ */
+void free_ising_1d(Ising1D *system)
+{
+    free_geometry(system -> geometry);
+    free(system -> ensemble);
+    free(system);
+}
+
+
+/*
+ * set_temperature_ising_1d
+ * ------------------------
+ * Change the temperature of the system and rebuild the table of flip 
+ * probabilities.
+ *
+ * parameters
+ * ----------
+ * Ising1D *system: The system to modify.
+ * float temperature: The new temperature.
+ */
+void set_temperature_ising_1d(Ising1D *system, float temperature)
+{
+    system -> temperature = temperature;
+    build_transitions(&system -> transitions, system -> transitions.rule, 
+        2, temperature, 1., 0.);
+}
+
+
+/*
+ * set_rule_ising_1d
+ * -----------------
+ * Change the acceptance rule used to evolve the system.
+ *
+ * parameters
+ * ----------
+ * Ising1D *system: The system to modify.
+ * Rule rule: The new acceptance rule.
+ */
+void set_rule_ising_1d(Ising1D *system, Rule rule)
+{
+    build_transitions(&system -> transitions, rule, 2, 
+        system -> temperature, 1., 0.);
+}
+
+
+/*
+ * rule_ising_1d
+ * -------------
+ * Read the acceptance rule from the configuration. The metropolis rule is 
+ * used if no rule is specified.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ *
+ * returns
+ * -------
+ * Rule rule: The selected acceptance rule.
+ */
+Rule rule_ising_1d(Config *config)
+{
+    return parse_rule(find_default(config, "rule", "metropolis"));
+}
+
+
+/*
+ * recount_ising_1d
+ * ----------------
+ * Recalculate the running totals of the system from its spins. This is 
+ * only needed after the spins have been modified directly.
+ *
+ * parameters
+ * ----------
+ * Ising1D *system: The system to recount.
+ */
+void recount_ising_1d(Ising1D *system)
+{
+    Sites sites = geometry_sites(system -> geometry, system -> ensemble);
+    Totals totals = recount_kernel(&sites, 2);
+    system -> magnetisation = totals.magnetisation;
+    system -> aligned = totals.aligned;
+}
+
+
+/*
+ * check_ising_1d
+ * --------------
+ * A debugging utility that compares the running totals of the system 
+ * against a full recount. This does nothing unless compiled with 
+ * ISING_DEBUG defined.
+ *
+ * parameters
+ * ----------
+ * const Ising1D *system: The system to check.
+ */
+void check_ising_1d(const Ising1D *system)
+{
+#ifdef ISING_DEBUG
+    Ising1D recount = *system;
+    recount_ising_1d(&recount);
+
+    if ((recount.magnetisation != system -> magnetisation) || 
+        (recount.aligned != system -> aligned) ||
+        (system -> temperature != system -> transitions.temperature))
+    {
+        printf("Error: Running totals (%i, %i) do not match (%i, %i)!", 
+            system -> magnetisation, system -> aligned, 
+            recount.magnetisation, recount.aligned);
+        exit(1);
+    }
+#else
+    (void) system;
+#endif
+}
+
+
 /*
  * spin_energy_ising_1d
  * --------------------
@@ -55,11 +191,9 @@ Ising1D* init_ising_1d(int length, float temperature)
  */
 int spin_energy_ising_1d(Ising1D* system, int spin)
 {
-    int *ensemble = system -> ensemble;
-    int length = system -> length;
-    return ensemble[spin] * (
-        ensemble[modulo(spin + 1, length)] + 
-        ensemble[modulo(spin - 1, length)]);
+    const int8_t *ensemble = system -> ensemble;
+    const int32_t *neighbours = neighbours_geometry(system -> geometry, spin);
+    return ensemble[spin] * (ensemble[neighbours[0]] + ensemble[neighbours[1]]);
 }
 
 
@@ -78,14 +212,9 @@ int spin_energy_ising_1d(Ising1D* system, int spin)
  */
 float energy_ising_1d(Ising1D* system)
 {
-    int energy = 0;
-
-    for (int spin = 0; spin < system -> length; spin++) 
-    {
-        energy -= spin_energy_ising_1d(system, spin);
-    }
-
-    return (float) energy / (float) 2;
+    check_ising_1d(system);
+    return energy_kernel(system -> length, system -> aligned, 
+        system -> magnetisation, 1., 0.);
 }
 
 
@@ -104,24 +233,7 @@ float energy_ising_1d(Ising1D* system)
  */
 float entropy_ising_1d(Ising1D* system) 
 {
-    int length = system -> length;
-    int* ensemble = system -> ensemble; 
-    int up_spins = 0;
-
-    for (int spin = 0; spin < length; spin++)
-    {
-        if (ensemble[spin] == (ensemble[modulo(spin + 1, length)]))
-        {
-            up_spins++;
-        }
-    }
-
-    int down_spins = length - up_spins;
-
-    float entropy = length * log(length) - up_spins * log(up_spins) 
-        - down_spins * log(down_spins);
-    
-    return entropy;
+    return bond_entropy_kernel(system -> length, system -> aligned);
 }
 
 
@@ -157,6 +269,8 @@ float free_energy_ising_1d(Ising1D* system)
  */
 void flip_spin_ising_1d(Ising1D *system, int spin)
 {
+    system -> magnetisation -= 2 * system -> ensemble[spin];
+    system -> aligned -= spin_energy_ising_1d(system, spin);
     system -> ensemble[spin] *= -1;
 }
 
@@ -164,7 +278,8 @@ void flip_spin_ising_1d(Ising1D *system, int spin)
 /*
  * metropolis_step
  * ---------------
- * Evolve the spin state according to a metropolis algorithm. 
+ * Evolve the spin state by proposing to flip a random spin, accepting 
+ * with the tabulated probability of the system's rule. 
  *
  * parameters
  * ----------
@@ -172,25 +287,66 @@ void flip_spin_ising_1d(Ising1D *system, int spin)
  */
 void metropolis_step_ising_1d(Ising1D* system)
 {
-    int spin = random_index(system -> length);
-    // TODO: I think that the problem is here. I am not sure if I am 
-    // Counting this energy change correctly or if I am accounting for 
-    // the spins too many times. Need to carefully think this through 
-    // slash just try and change it to see what happens. 
-    float energy_change = 2. * spin_energy_ising_1d(system, spin);
-    float temperature = system -> temperature;
+    metropolis_batch_ising_1d(system, 1);
+}
 
-    if (energy_change < 0)
-    {
-        flip_spin_ising_1d(system, spin);
-    } 
-    else if (exp(- energy_change / temperature) > normalised_random()) 
-    {
-        flip_spin_ising_1d(system, spin);
-    }
+
+/*
+ * metropolis_batch_ising_1d
+ * -------------------------
+ * Perform many metropolis steps with the neighbour table kernel of the 
+ * kernel library. The chain is identical to calling 
+ * metropolis_step_ising_1d steps times. The flips are added to the 
+ * telemetry counters of the calling thread.
+ *
+ * parameters
+ * ----------
+ * Ising1D *system: The spin ensamble to evolve.
+ * long steps: The number of attempted flips.
+ */
+void metropolis_batch_ising_1d(Ising1D *system, long steps)
+{
+    Sites sites = geometry_sites(system -> geometry, system -> ensemble);
+    Totals changes = metropolis_kernel(&sites, &system -> transitions, 
+        &system -> random, steps);
+
+    system -> magnetisation += changes.magnetisation;
+    system -> aligned += changes.aligned;
+    count_telemetry(steps, changes.accepted);
 }
 
 
+/*
+ * burn_in_ising_1d
+ * ----------------
+ * Evolve the system towards equilibrium, stopping early once its energy 
+ * and magnetisation are stationary if the burn-in is automatic.
+ *
+ * parameters
+ * ----------
+ * Ising1D *system: The system to burn in.
+ * const BurnIn *burn_in: The burn-in options of the workflow.
+ * long steps: The fixed burn-in of the workflow.
+ *
+ * returns
+ * -------
+ * long steps: The number of steps the system was evolved for.
+ */
+long burn_in_ising_1d(Ising1D *system, const BurnIn *burn_in, long steps)
+{
+    Equilibration equilibration;
+    long spacing = init_equilibration(&equilibration, burn_in, steps, 
+        system -> length, 1);
+
+    do
+    {
+        metropolis_batch_ising_1d(system, spacing);
+    } while (!add_equilibration(&equilibration, energy_ising_1d(system), 
+        fabs(magnetisation_ising_1d(system))));
+
+    return free_equilibration(&equilibration);
+}
+
 
 /*
  * magnetisation
@@ -203,17 +359,12 @@ void metropolis_step_ising_1d(Ising1D* system)
  *
  * returns
  * -------
- * int magnetisation: The net magnetisation.
+ * float magnetisation: The net magnetisation.
  */
 float magnetisation_ising_1d(Ising1D* system)
 {
-    int length = system -> length;
-    float magnetisation = 0;
-    for (int spin = 0; spin < length; spin++)
-    {
-        magnetisation += (system -> ensemble)[spin];
-    }
-    return magnetisation / length;
+    check_ising_1d(system);
+    return (float) system -> magnetisation;
 }
 
 
@@ -229,7 +380,7 @@ float magnetisation_ising_1d(Ising1D* system)
 void print_ising_1d(Ising1D *system)
 {
     int length = system -> length;
-    int *ensemble = system -> ensemble;
+    const int8_t *ensemble = system -> ensemble;
     
     printf("1D Ising System:\n");
     for (int spin = 0; spin < length; spin++)
@@ -254,7 +405,7 @@ void print_ising_1d(Ising1D *system)
 void save_ising_1d(const Ising1D *system, FILE *file)
 {
     int length = system -> length;
-    int *ensemble = system -> ensemble;
+    const int8_t *ensemble = system -> ensemble;
     float temperature = system -> temperature;
 
     fprintf(file, "# Temperature: %f\n", temperature);
@@ -277,6 +428,9 @@ void save_ising_1d(const Ising1D *system, FILE *file)
  * What do you notice about the size of the chunks of color at 
  * low temperatures compared to high temperatures. 
  *
+ * The system stops evolving once it is stationary, see read_burn_in, and 
+ * the burn-in at each temperature is written to a telemetry sidecar.
+ *
  * parameters
  * ----------
  * Config *config: The configuration file detailing the setup of the system. 
@@ -288,10 +442,14 @@ void first_and_last_ising_1d(Config *config)
     float start = atof(find(config, "lowest_temperature"));
     float stop = atof(find(config, "highest_temperature"));
     float step = atof(find(config, "temperature_step"));
+    Rule rule = rule_ising_1d(config);
+    BurnIn burn_in = read_burn_in(config);
+    int num_temps = (int) ((stop - start) / step);
+    Telemetry *telemetry = config_telemetry(config, save_file_name, 
+        "first_and_last_ising_1d", num_temps);
 
     free(config);
 
-    int num_temps = (int) ((stop - start) / step);
     FILE *save_file = fopen(save_file_name, "w");
 
     int ind;
@@ -299,20 +457,28 @@ void first_and_last_ising_1d(Config *config)
 
     for (temp = start, ind = 0; temp < stop; temp += step, ind++)
     {
+        reset_telemetry();
         Ising1D* system = init_ising_1d(num_spins, temp);
+        set_rule_ising_1d(system, rule);
 
+        start_telemetry(IO_PHASE);
         save_ising_1d(system, save_file);
 
-        // Running the metropolis algorithm over the system. 
-        for (int epoch = 0; epoch <= num_spins * 1e3; epoch++)
-        { 
-            metropolis_step_ising_1d(system);
-        }
+        // Running the metropolis algorithm until the system settles. 
+        start_telemetry(BURN_IN_PHASE);
+        burn_in_ising_1d(system, &burn_in, num_spins * 1e3 + 1);
 
+        start_telemetry(IO_PHASE);
         save_ising_1d(system, save_file);
-        free(system -> ensemble);
-        free(system);
+        free_ising_1d(system);
+
+        char point[64];
+        snprintf(point, sizeof(point), "\"temperature\": %.4f", temp);
+        record_telemetry(telemetry, point);
     }
+
+    fclose(save_file);
+    close_telemetry(telemetry);
 }
 
 
@@ -330,6 +496,9 @@ void first_and_last_ising_1d(Config *config)
  * and make sure that the system reaches thermodynamic equilibrium
  * before taking measurements. Present against the analytic solutions.
  *
+ * The burn-in stops once the system is stationary, see read_burn_in, and 
+ * it is written to a telemetry sidecar with the time at each temperature.
+ *
  * parameters
  * ----------
  * Config *config: The configuration file detailing the simulation. 
@@ -344,60 +513,64 @@ void physical_parameters_ising_1d(Config* config)
 
     int num_temps = (int) ((stop - start) / step);
     int epochs = 1e3 * spins, runs = 100;
-
-    float energies[num_temps][2];
-    float entropies[num_temps][2];
-    float free_energies[num_temps][2];
-    float heat_capacities[num_temps][2];
+    Rule rule = rule_ising_1d(config);
+    BurnIn burn_in = read_burn_in(config);
+    Telemetry *telemetry = config_telemetry(config, save_file_name, 
+        "physical_parameters_ising_1d", num_temps);
+
+    double energies[num_temps][2];
+    double entropies[num_temps][2];
+    double free_energies[num_temps][2];
+    double heat_capacities[num_temps][2];
     
     int ind;    
     float temp;
 
+    // The burn-in is recorded with the first temperature.
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
     Ising1D *system = init_ising_1d(spins, stop - step);
+    set_rule_ising_1d(system, rule);
     
     // Running the burnin period. 
-    for (int epoch = 0; epoch <= epochs; epoch++)
-    { 
-        metropolis_step_ising_1d(system);
-    }
+    burn_in_ising_1d(system, &burn_in, epochs + 1);
 
     for (temp = stop - step, ind = 0; temp >= start; temp -= step, ind++)
     {
-        system -> temperature = temp;
+        start_telemetry(MEASUREMENT_PHASE);
+        set_temperature_ising_1d(system, temp);
 
-        float _energies[runs];
-        float _entropies[runs];
-        float _heat_capacities[runs];
+        double _energies[runs];
+        double _entropies[runs];
+        double _heat_capacities[runs];
         
         for (int run = 0; run < runs; run++)
         {
-            float __energies[epochs];
-            float __entropies[epochs];
+            Accumulator __energies, __entropies;
+            init_accumulator(&__energies);
+            init_accumulator(&__entropies);
 
             for (int epoch = 0; epoch < epochs; epoch++)
             { 
                 metropolis_step_ising_1d(system);
-                float energy = energy_ising_1d(system);
-                float entropy = entropy_ising_1d(system);
-
-                __energies[epoch] = energy;
-                __entropies[epoch] = entropy;
+                add_accumulator(&__energies, energy_ising_1d(system));
+                add_accumulator(&__entropies, entropy_ising_1d(system));
             }
 
-            _energies[run] = mean(__energies, epochs);
-            _entropies[run] = mean(__entropies, epochs);
-            _heat_capacities[run] = variance(__energies, __energies[run], epochs) / temp / temp;
+            _energies[run] = mean_accumulator(&__energies);
+            _entropies[run] = mean_accumulator(&__entropies);
+            _heat_capacities[run] = variance_accumulator(&__energies) / temp / temp;
         }
 
-        float energy_est = mean(_energies, runs);
-        float entropy_est = mean(_entropies, runs);
-        float free_energy_est =  energy_est - temp * entropy_est;
-        float heat_capacity_est = mean(_heat_capacities, runs);
+        double energy_est = mean(_energies, runs);
+        double entropy_est = mean(_entropies, runs);
+        double free_energy_est =  energy_est - temp * entropy_est;
+        double heat_capacity_est = mean(_heat_capacities, runs);
 
-        float energy_err = sqrt(variance(_energies, energy_est, runs));
-        float entropy_err = sqrt(variance(_entropies, entropy_est, runs));
-        float free_energy_err = energy_err + temp * entropy_err;
-        float heat_capacity_err = sqrt(variance(_heat_capacities, heat_capacity_est, runs));
+        double energy_err = sqrt(variance(_energies, energy_est, runs));
+        double entropy_err = sqrt(variance(_entropies, entropy_est, runs));
+        double free_energy_err = energy_err + temp * entropy_err;
+        double heat_capacity_err = sqrt(variance(_heat_capacities, heat_capacity_est, runs));
 
         energies[ind][1] = energy_err / spins;
         energies[ind][0] = energy_est / spins;
@@ -407,10 +580,14 @@ void physical_parameters_ising_1d(Config* config)
         free_energies[ind][0] = free_energy_est / spins;
         heat_capacities[ind][1] = heat_capacity_err / spins / 2;
         heat_capacities[ind][0] = heat_capacity_est / spins / 2;
+
+        char point[64];
+        snprintf(point, sizeof(point), "\"temperature\": %.4f", temp);
+        record_telemetry(telemetry, point);
     }
 
-    free(system -> ensemble);
-    free(system);
+    free_ising_1d(system);
+    start_telemetry(IO_PHASE);
 
 	// Writing the data to the file
 	FILE* data = fopen(save_file_name, "w");
@@ -442,6 +619,7 @@ void physical_parameters_ising_1d(Config* config)
 	}
 	
 	fclose(data);
+    close_telemetry(telemetry);
 }
 
 
@@ -450,7 +628,9 @@ void physical_parameters_ising_1d(Config* config)
  * histogram
  * ---------
  * Create a histogram of the m values you obtain by running a 
- * simulation of 500 spins at 1., 2. and 3. temperatures 100 times.
+ * simulation of 500 spins at 1., 2. and 3. temperatures 100 times. The 
+ * burn-in of each size stops once it is stationary, see read_burn_in, and 
+ * it is written to a telemetry sidecar.
  *
  * parameters
  * ----------
@@ -464,9 +644,13 @@ void magnetisation_vs_temperature_ising_1d(Config* config)
     float start = atof(find(config, "lowest_temperature"));
     float stop = atof(find(config, "highest_temperature"));
     float step = atof(find(config, "temperature_step"));
+    Rule rule = rule_ising_1d(config);
+    BurnIn burn_in = read_burn_in(config);
    
     int length = (int) ((stop - start) / step); 
     float magnetisations[length][reps_per_temp][2]; 
+    Telemetry *telemetry = config_telemetry(config, save_file_name, 
+        "magnetisation_vs_temperature_ising_1d", 2 * length);
 
     for (int number = 0; number < 2; number++)
     {
@@ -474,38 +658,46 @@ void magnetisation_vs_temperature_ising_1d(Config* config)
         float temp;
         int num_epochs = 1e3 * num_spins[number];
 
+        reset_telemetry();
+        start_telemetry(BURN_IN_PHASE);
         Ising1D *system = init_ising_1d(num_spins[number], stop - step);
+        set_rule_ising_1d(system, rule);
 
         // Running the burnin period. 
-        for (int epoch = 0; epoch <= num_epochs; epoch++)
-        { 
-            metropolis_step_ising_1d(system);
-        }
+        burn_in_ising_1d(system, &burn_in, num_epochs + 1);
 
         for (temp = stop - step, ind = 0; temp >= start; temp -= step, ind++)
         {
-            system -> temperature = temp;
+            start_telemetry(MEASUREMENT_PHASE);
+            set_temperature_ising_1d(system, temp);
 
             for (int rep = 0; rep < reps_per_temp; rep++)
             {
                 // Running the simulation 
-                float sim_magnetisation[num_epochs];
+                Accumulator sim_magnetisation;
+                init_accumulator(&sim_magnetisation);
 
                 for (int epoch = 0; epoch < num_epochs; epoch++)
                 { 
                     metropolis_step_ising_1d(system);
-                    sim_magnetisation[epoch] = magnetisation_ising_1d(system);
+                    add_accumulator(&sim_magnetisation, 
+                        magnetisation_ising_1d(system) / system -> length);
                 }
 
-                float mean_magnetisation = mean(sim_magnetisation, num_epochs);
-                magnetisations[ind][rep][number] = mean_magnetisation;
+                magnetisations[ind][rep][number] = mean_accumulator(&sim_magnetisation);
             }
+
+            char point[64];
+            snprintf(point, sizeof(point), 
+                "\"length\": %i, \"temperature\": %.4f", num_spins[number], temp);
+            record_telemetry(telemetry, point);
         }
 
-        free(system -> ensemble);
-        free(system);
+        free_ising_1d(system);
     }
 
+    start_telemetry(IO_PHASE);
+
 
     // Opening the data file. 
     FILE* data = fopen(save_file_name, "w");
@@ -546,4 +738,5 @@ void magnetisation_vs_temperature_ising_1d(Config* config)
 
     // Closing the file
     fclose(data);
+    close_telemetry(telemetry);
 }
@@ -2,10 +2,27 @@
 #include<math.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
 #include<unistd.h>
 #include"include/toml.h"
+#include"include/rng.h"
 #include"include/utils.h"
+#include"include/lattice.h"
 #include"include/2d_ising.h"
+#include"include/multispin.h"
+#include"include/wolff.h"
+#include"include/runner.h"
+#include"include/accumulator.h"
+#include"include/analysis.h"
+#include"include/checkpoint.h"
+#include"include/trajectory.h"
+#include"include/writer.h"
+#include"include/columns.h"
+#include"include/telemetry.h"
+#include"include/equilibration.h"
+#include"include/sampling.h"
+#include"include/reweighting.h"
+#include"include/kernels.h"
 
 
 /*
@@ -23,28 +40,152 @@
  */
 Ising2D* init_ising_2d(int length, float temperature)
 {
-    int **ensemble = (int**) calloc(length, sizeof(int*));  
-    for (int col = 0; col < length; col++)
-    {
-        ensemble[col] = (int*) calloc(length, sizeof(int));
-    } 
+    Ising2D* system = (Ising2D*) calloc(1, sizeof(Ising2D));
+    split_random(&system -> random);
 
-    for (int row = 0; row < length; row++)
-    {
-        for (int col = 0; col < length; col++)
-        {
-            ensemble[row][col] = random_spin();
-        }
-    }
+    Lattice *ensemble = init_lattice(length);
+    randomise_lattice(ensemble, &system -> random);
 
-    Ising2D* system = (Ising2D*) calloc(1, sizeof(Ising2D));
     system -> length = length;
     system -> temperature = temperature;
     system -> ensemble = ensemble;
+    build_transitions(&system -> transitions, METROPOLIS, 4, temperature, 1., 0.);
+    recount_ising_2d(system);
     return system;
 }
 
 
+/*
+ * set_temperature_ising_2d
+ * ------------------------
+ * Change the temperature of the system and rebuild the table of flip 
+ * probabilities.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to modify.
+ * float temperature: The new temperature.
+ */
+void set_temperature_ising_2d(Ising2D *system, float temperature)
+{
+    system -> temperature = temperature;
+    build_transitions(&system -> transitions, system -> transitions.rule, 
+        4, temperature, 1., 0.);
+}
+
+
+/*
+ * set_rule_ising_2d
+ * -----------------
+ * Change the acceptance rule used to evolve the system.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to modify.
+ * Rule rule: The new acceptance rule.
+ */
+void set_rule_ising_2d(Ising2D *system, Rule rule)
+{
+    build_transitions(&system -> transitions, rule, 4, 
+        system -> temperature, 1., 0.);
+}
+
+
+/*
+ * rule_ising_2d
+ * -------------
+ * Read the acceptance rule from the configuration. The metropolis rule is 
+ * used if no rule is specified.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ *
+ * returns
+ * -------
+ * Rule rule: The selected acceptance rule.
+ */
+Rule rule_ising_2d(Config *config)
+{
+    return parse_rule(find_default(config, "rule", "metropolis"));
+}
+
+
+/*
+ * recount_ising_2d
+ * ----------------
+ * Recalculate the running totals of the system from its spins. This is 
+ * only needed after the spins have been modified directly.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to recount.
+ */
+void recount_ising_2d(Ising2D *system)
+{
+    system -> magnetisation = magnetisation_lattice(system -> ensemble);
+    system -> aligned = aligned_bonds_lattice(system -> ensemble);
+}
+
+
+/*
+ * unpack_ising_2d
+ * ---------------
+ * Copy the spins and random stream back from the packed copy of the 
+ * multispin engine if it has evolved the system since they were last 
+ * unpacked. Anything that reads the lattice directly calls this first.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to bring up to date.
+ */
+void unpack_ising_2d(Ising2D *system)
+{
+    if (system -> packed)
+    {
+        unpack_multispin_2d(system -> multispin, system);
+        system -> packed = 0;
+    }
+}
+
+
+/*
+ * check_ising_2d
+ * --------------
+ * A debugging utility that compares the running totals of the system 
+ * against a full recount. This does nothing unless compiled with 
+ * ISING_DEBUG defined.
+ *
+ * parameters
+ * ----------
+ * const Ising2D *system: The system to check.
+ */
+void check_ising_2d(const Ising2D *system)
+{
+#ifdef ISING_DEBUG
+    if (system -> packed)
+    {
+        return;
+    }
+
+    int magnetisation = magnetisation_lattice(system -> ensemble);
+    int aligned = aligned_bonds_lattice(system -> ensemble);
+
+    if ((magnetisation != system -> magnetisation) || 
+        (aligned != system -> aligned) ||
+        (system -> temperature != system -> transitions.temperature))
+    {
+        printf("Error: Running totals (%i, %i) do not match (%i, %i)!", 
+            system -> magnetisation, system -> aligned, 
+            magnetisation, aligned);
+        exit(1);
+    }
+#else
+    (void) system;
+#endif
+}
+
+
 /*
  * spin_energy_ising_2d
  * --------------------
@@ -62,13 +203,9 @@ Ising2D* init_ising_2d(int length, float temperature)
  */
 float spin_energy_ising_2d(const Ising2D *system, int row, int col)
 {
-    int **ensemble = system -> ensemble;
-    int length = system -> length;
-    return ensemble[row][col] * (
-        ensemble[modulo(row + 1, length)][col] +
-        ensemble[modulo(row - 1, length)][col] +
-        ensemble[row][modulo(col + 1, length)] +
-        ensemble[row][modulo(col - 1, length)]);
+    const Lattice *ensemble = system -> ensemble;
+    return spin_lattice(ensemble, row, col) * 
+        neighbours_lattice(ensemble, row, col);
 }
 
 
@@ -88,18 +225,9 @@ float spin_energy_ising_2d(const Ising2D *system, int row, int col)
  */
 float energy_ising_2d(const Ising2D *system)
 {
-    int length = system -> length;
-    float energy = 0;
-
-    for (int row = 0; row < length; row++)
-    {
-        for (int col = 0; col < length; col++)
-        {
-            energy -= spin_energy_ising_2d(system, row, col);
-        }
-    }
-
-    return energy / 2.;
+    long bonds = 2l * system -> length * system -> length;
+    check_ising_2d(system);
+    return energy_kernel(bonds, system -> aligned, system -> magnetisation, 1., 0.);
 }
 
 
@@ -116,7 +244,12 @@ float energy_ising_2d(const Ising2D *system)
  */
 void flip_spin_ising_2d(Ising2D *system, int row, int col)
 {
-    system -> ensemble[row][col] *= -1;
+    int spin = spin_lattice(system -> ensemble, row, col);
+    int neighbours = neighbours_lattice(system -> ensemble, row, col);
+
+    system -> magnetisation -= 2 * spin;
+    system -> aligned -= spin * neighbours;
+    flip_spin_lattice(system -> ensemble, row, col);
 }
 
 
@@ -132,15 +265,16 @@ void flip_spin_ising_2d(Ising2D *system, int row, int col)
  */
 void print_ising_2d(Ising2D *system)
 {
+    unpack_ising_2d(system);
     int length = system -> length;
-    int **ensemble = system -> ensemble;
+    const Lattice *ensemble = system -> ensemble;
     
     printf("2D Ising System at %f:\n", system -> temperature);
     for (int row = 0; row < length; row++)
     {
         for (int col = 0; col < length; col++)
         {
-            printf("%i", ensemble[row][col] > 0);
+            printf("%i", spin_lattice(ensemble, row, col) > 0);
         }
         printf("\n");
     }
@@ -150,7 +284,10 @@ void print_ising_2d(Ising2D *system)
 /*
  * metropolis_step
  * ---------------
- * Evolve the spin state according to a metropolis algorithm. 
+ * Evolve the spin state by proposing to flip a random spin, accepting 
+ * with the tabulated probability of the system's rule. Every step draws 
+ * a row, a column and a uniform deviate in that order, even when the flip 
+ * is certain, so that metropolis_batch_ising_2d reproduces it exactly.
  *
  * parameters
  * ----------
@@ -158,100 +295,337 @@ void print_ising_2d(Ising2D *system)
  */
 void metropolis_step_ising_2d(Ising2D *system)
 {
-    int length = system -> length;
-    int **ensemble = system -> ensemble;
-    float temperature = system -> temperature;
+    metropolis_batch_ising_2d(system, 1);
+}
+
 
-    int row = random_index(length);
-    int col = random_index(length);
+/*
+ * metropolis_batch_ising_2d
+ * -------------------------
+ * Perform many metropolis steps with the square lattice kernel of the 
+ * kernel library, which draws the random sites and deviates for a block 
+ * of steps at once and prefetches the rows around each site before they 
+ * are needed. The flips are still applied strictly in order so the chain 
+ * is identical to calling metropolis_step_ising_2d steps times.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The spin ensamble to evolve.
+ * long steps: The number of attempted flips.
+ */
+void metropolis_batch_ising_2d(Ising2D *system, long steps)
+{
+    Sites sites = lattice_sites(system -> ensemble);
+    Totals changes = metropolis_kernel(&sites, &system -> transitions, 
+        &system -> random, steps);
 
-    int spin = ensemble[row][col];
-    int neighbours = 
-        ensemble[modulo(row + 1, length)][col] + 
-        ensemble[modulo(row - 1, length)][col] + 
-        ensemble[row][modulo(col + 1, length)] + 
-        ensemble[row][modulo(col - 1, length)];
+    system -> magnetisation += changes.magnetisation;
+    system -> aligned += changes.aligned;
+    system -> accepted += changes.accepted;
+}
 
-    float energy_change = 2 * neighbours * spin;
 
-    if ((energy_change < 0) || 
-        (exp(- energy_change / temperature) > normalised_random()))
+/*
+ * engine_ising_2d
+ * ---------------
+ * Read the algorithm used to evolve the system from the configuration. 
+ * The metropolis algorithm is used if no engine is specified.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ *
+ * returns
+ * -------
+ * Engine2D engine: The selected algorithm.
+ */
+Engine2D engine_ising_2d(Config *config)
+{
+    char *engine = find_default(config, "engine", "metropolis");
+
+    if (strcmp(engine, "metropolis") == 0)
     {
-        ensemble[row][col] *= -1;
+        return METROPOLIS_2D;
     }
+    else if (strcmp(engine, "multispin") == 0)
+    {
+        return MULTISPIN_2D;
+    }
+    else if (strcmp(engine, "checkerboard") == 0)
+    {
+        return CHECKERBOARD_2D;
+    }
+    else if (strcmp(engine, "wolff") == 0)
+    {
+        return WOLFF_2D;
+    }
+
+    printf("Error: Unknown engine '%s'!", engine);
+    exit(1);
 }
 
 
 /*
- * entropy_ising_2d
- * ----------------
- * Calculate the entropy of a two dimensional ising model.
+ * evolve_ising_2d
+ * ---------------
+ * Evolve the system by a number of attempted spin flips using the chosen 
+ * algorithm. Sweeping engines attempt every spin once per sweep so they 
+ * perform steps / length^2 whole sweeps, and only the steps of those are 
+ * counted by the system and the telemetry. The cluster engine grows enough 
+ * clusters to flip around steps spins. The multispin engine packs the 
+ * spins once and keeps them packed, along with the random stream, until 
+ * another engine or anything that reads the lattice unpacks them. The 
+ * flips are added to the telemetry counters of the calling thread.
  *
  * parameters
  * ----------
- * Ising2D *system: The system to calculate the entropy of.
- * 
- * returns
- * -------
- * float entropy: The entropy of the system. 
+ * Ising2D *system: The system to evolve.
+ * long steps: The number of attempted spin flips.
+ * Engine2D engine: The algorithm to use.
  */
-float entropy_ising_2d(Ising2D *system)
+void evolve_ising_2d(Ising2D *system, long steps, Engine2D engine)
 {
-    int len = system -> length;
-    int **ensemble = system -> ensemble; 
-    int up = 0;
+    long number = (long) system -> length * system -> length;
+    long accepted = system -> accepted;
+    long performed = steps;
+
+    if (engine != MULTISPIN_2D)
+    {
+        unpack_ising_2d(system);
+    }
 
-    for (int row = 0; row < len; row++)
+    if (engine == MULTISPIN_2D)
     {
-        for (int col = 0; col < len; col++)
+        if (system -> multispin == NULL)
         {
-            up += ensemble[row][col] == ensemble[modulo(row + 1, len)][col];
-            up += ensemble[row][col] == ensemble[row][modulo(col + 1, len)];
+            system -> multispin = init_multispin_2d(system -> length, 
+                system -> temperature);
+        }
+
+        // The spins stay packed between calls until the lattice is read.
+        MultiSpin2D *packed = system -> multispin;
+        if (!system -> packed)
+        {
+            pack_multispin_2d(packed, system);
+            system -> packed = 1;
+        }
+        else if (packed -> rule != system -> transitions.rule)
+        {
+            packed -> rule = system -> transitions.rule;
+            build_thresholds_multispin_2d(packed);
         }
-    }
-        
-    int total = 2 * len * len;
-    int down = total - up;
 
-    if (up == 0 || up == total)
+        packed -> temperature = system -> temperature;
+        packed -> accepted = 0;
+        performed = steps / number * number;
+
+        for (long sweep = 0; sweep < steps / number; sweep++)
+        {
+            sweep_multispin_2d(packed);
+        }
+
+        int anti = ((int) energy_multispin_2d(packed) + 2 * number) / 2;
+        system -> magnetisation = magnetisation_multispin_2d(packed);
+        system -> aligned = 2 * number - anti;
+        system -> accepted += packed -> accepted;
+    }
+    else if (engine == CHECKERBOARD_2D)
     {
-        return log(2);
+        performed = steps / number * number;
+        for (long sweep = 0; sweep < steps / number; sweep++)
+        {
+            checkerboard_sweep_ising_2d(system);
+        }
+    }
+    else if (engine == WOLFF_2D)
+    {
+        if (system -> wolff == NULL)
+        {
+            system -> wolff = init_wolff_2d(system -> length);
+        }
+
+        evolve_wolff_2d(system -> wolff, system, steps);
     }
     else
     {
-        return total * log(total) - up * log(up) - down * log(down);
+        metropolis_batch_ising_2d(system, steps);
     }
+
+    system -> steps += performed;
+    count_telemetry(performed, system -> accepted - accepted);
 }
 
 
 /*
- * magnetisation_ising_2d
- * ----------------------
- * Calculate the magnetisation of the 2D ising model. 
+ * burn_in_ising_2d
+ * ----------------
+ * Evolve the system towards equilibrium, stopping early once its energy 
+ * and magnetisation are stationary if the burn-in is automatic. The 
+ * sweeping engines are sampled once a sweep at the most.
  *
  * parameters
  * ----------
- * Ising2D *system: The system to calculate the total magnetisation of.
+ * Ising2D *system: The system to burn in.
+ * const BurnIn *burn_in: The burn-in options of the workflow.
+ * long steps: The fixed burn-in of the workflow.
+ * Engine2D engine: The algorithm to use.
  *
  * returns
  * -------
- * int magnetisation: The magetisation of the system. 
+ * long steps: The number of steps the system was evolved for.
  */
-int magnetisation_ising_2d(const Ising2D *system)
+long burn_in_ising_2d(
+    Ising2D *system, 
+    const BurnIn *burn_in, 
+    long steps, 
+    Engine2D engine)
+{
+    long number = (long) system -> length * system -> length;
+    int sweeping = (engine == MULTISPIN_2D) || (engine == CHECKERBOARD_2D);
+    Equilibration equilibration;
+    long spacing = init_equilibration(&equilibration, burn_in, steps, 
+        number, sweeping ? number : 1);
+
+    do
+    {
+        evolve_ising_2d(system, spacing, engine);
+    } while (!add_equilibration(&equilibration, energy_ising_2d(system), 
+        abs(magnetisation_ising_2d(system))));
+
+    return free_equilibration(&equilibration);
+}
+
+
+/*
+ * measurement_interval_ising_2d
+ * -----------------------------
+ * The smallest number of attempted spin flips an engine can perform 
+ * between two measurements.
+ *
+ * parameters
+ * ----------
+ * const Ising2D *system: The system that is getting measured.
+ * Engine2D engine: The algorithm evolving the system.
+ *
+ * returns
+ * -------
+ * long interval: One step for single spin engines and a whole sweep 
+ *      otherwise.
+ */
+long measurement_interval_ising_2d(const Ising2D *system, Engine2D engine)
+{
+    if (engine == METROPOLIS_2D)
+    {
+        return 1;
+    }
+
+    return (long) system -> length * system -> length;
+}
+
+
+/*
+ * checkerboard_sweep_ising_2d
+ * ---------------------------
+ * Attempt to flip every spin once. The lattice is coloured like a 
+ * checkerboard so that the neighbours of a spin are always of the other 
+ * colour. All of the spins of one colour are independent and are updated 
+ * in parallel before moving on to the other colour. Every row draws from 
+ * its own random number stream so the result does not depend on how the 
+ * rows are shared between threads. An odd length does not colour across 
+ * the periodic boundary, so those lattices are swept by a single thread.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The spin ensamble to evolve.  
+ */
+void checkerboard_sweep_ising_2d(Ising2D *system)
 {
     int length = system -> length;
-    int **ensemble = system -> ensemble;
-    int magnetisation = 0;
+    Lattice *ensemble = system -> ensemble;
+    const Transitions *transitions = &system -> transitions;
 
-    for (int row = 0; row < length; row++)
+    if (system -> num_streams != length)
     {
-        for (int col = 0; col < length; col++)
+        system -> streams = (Random*) realloc(system -> streams, 
+            length * sizeof(Random));
+        split_streams_random(&system -> random, system -> streams, length);
+        system -> num_streams = length;
+    }
+
+    int magnetisation = 0, aligned = 0;
+    long accepted = 0;
+    int parallel = length % 2 == 0;
+
+    for (int colour = 0; colour < 2; colour++)
+    {
+        # pragma omp parallel for schedule(static) if(parallel) \
+            reduction(+: magnetisation, aligned, accepted)
+        for (int row = 0; row < length; row++)
         {
-            magnetisation += ensemble[row][col];
+            Random *stream = &system -> streams[row];
+
+            for (int col = (row + colour) & 1; col < length; col += 2)
+            {
+                int spin = spin_lattice(ensemble, row, col);
+                int neighbours = neighbours_lattice(ensemble, row, col);
+                float probability = transition_probability(transitions, 
+                    spin, neighbours);
+
+                if ((probability >= 1) || 
+                    (probability > normalised_random(stream)))
+                {
+                    magnetisation -= 2 * spin;
+                    aligned -= spin * neighbours;
+                    accepted++;
+                    flip_spin_lattice(ensemble, row, col);
+                }
+            }
         }
     }
 
-    return magnetisation; 
+    system -> magnetisation += magnetisation;
+    system -> aligned += aligned;
+    system -> accepted += accepted;
+}
+
+
+/*
+ * entropy_ising_2d
+ * ----------------
+ * Calculate the entropy of a two dimensional ising model.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to calculate the entropy of.
+ * 
+ * returns
+ * -------
+ * float entropy: The entropy of the system. 
+ */
+float entropy_ising_2d(Ising2D *system)
+{
+    long bonds = 2l * system -> length * system -> length;
+    return bond_entropy_kernel(bonds, system -> aligned);
+}
+
+
+/*
+ * magnetisation_ising_2d
+ * ----------------------
+ * Calculate the magnetisation of the 2D ising model. 
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to calculate the total magnetisation of.
+ *
+ * returns
+ * -------
+ * int magnetisation: The magetisation of the system. 
+ */
+int magnetisation_ising_2d(const Ising2D *system)
+{
+    check_ising_2d(system);
+    return system -> magnetisation;
 }
 
 
@@ -267,29 +641,142 @@ int magnetisation_ising_2d(const Ising2D *system)
  */
 void save_ising_2d(Ising2D *system, FILE *save_file)
 {
-    int length = system -> length;
-    int **ensemble = system -> ensemble;
     float temp = system -> temperature;
+    unpack_ising_2d(system);
     
     fprintf(save_file, "# Temperature = %f\n", temp);
+    save_lattice(system -> ensemble, save_file, 0);
+}
 
-    for (int row = 0; row < length; row++)
+
+/*
+ * write_frame_ising_2d
+ * --------------------
+ * Append the current state of the system to a trajectory.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The writer thread to hand a copy of the spins to, or 
+ *      NULL to write the frame immediately.
+ * TrajectoryWriter *trajectory: The open trajectory.
+ * Ising2D *system: The ising model.
+ */
+void write_frame_ising_2d(
+    Writer *writer, 
+    TrajectoryWriter *trajectory, 
+    Ising2D *system)
+{
+    unpack_ising_2d(system);
+
+    Frame frame;
+    frame.temperature = system -> temperature;
+    frame.epsilon = 1.;
+    frame.magnetic_field = 0.;
+    frame.steps = system -> steps;
+
+    if (writer != NULL)
     {
-        for(int col = 0; col < length - 1; col++)
-        {
-            fprintf(save_file, "%i,", ensemble[row][col]);
-        }
-        
-        fprintf(save_file, "%i\n", ensemble[row][length - 1]);
+        frame_writer(writer, trajectory, system -> ensemble, &frame);
+    }
+    else
+    {
+        write_frame_trajectory(trajectory, system -> ensemble, &frame);
+    }
+}
+
+
+/*
+ * save_checkpoint_ising_2d
+ * ------------------------
+ * Save the complete state of the system, including the row streams of 
+ * the parallel sweep, to a binary checkpoint so that it can be restored 
+ * exactly with load_checkpoint_ising_2d.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The writer thread to hand a copy of the state to, or 
+ *      NULL to write the checkpoint immediately.
+ * Ising2D *system: The ising model.
+ * const char *file_name: The file to write.
+ */
+void save_checkpoint_ising_2d(
+    Writer *writer, 
+    Ising2D *system, 
+    const char *file_name)
+{
+    unpack_ising_2d(system);
+
+    Checkpoint header;
+    init_checkpoint(&header, system -> length, system -> num_streams);
+    header.rule = system -> transitions.rule;
+    header.temperature = system -> temperature;
+    header.epsilon = 1.;
+    header.magnetic_field = 0.;
+    header.steps = system -> steps;
+    header.random = system -> random;
+    header.accepted = system -> accepted;
+
+    if (writer != NULL)
+    {
+        checkpoint_writer(writer, file_name, &header, system -> ensemble, system -> streams);
+    }
+    else
+    {
+        write_checkpoint(file_name, &header, system -> ensemble, system -> streams);
     }
 }
 
 
+/*
+ * load_checkpoint_ising_2d
+ * ------------------------
+ * Restore a system saved with save_checkpoint_ising_2d.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The checkpoint to read.
+ *
+ * returns
+ * -------
+ * Ising2D *system: The restored model.
+ */
+Ising2D *load_checkpoint_ising_2d(const char *file_name)
+{
+    const Checkpoint *header = map_checkpoint(file_name);
+    int length = header -> length;
+
+    Ising2D *system = (Ising2D*) calloc(1, sizeof(Ising2D));
+    system -> length = length;
+    system -> temperature = header -> temperature;
+    system -> ensemble = init_lattice(length);
+    read_lattice_checkpoint(header, system -> ensemble);
+    build_transitions(&system -> transitions, (Rule) header -> rule, 4, 
+        system -> temperature, 1., 0.);
+
+    if (header -> num_streams > 0)
+    {
+        system -> num_streams = header -> num_streams;
+        system -> streams = (Random*) malloc(system -> num_streams * sizeof(Random));
+        memcpy(system -> streams, streams_checkpoint(header), 
+            system -> num_streams * sizeof(Random));
+    }
+
+    system -> random = header -> random;
+    system -> steps = header -> steps;
+    system -> accepted = header -> accepted;
+    unmap_checkpoint(header);
+    recount_ising_2d(system);
+
+    return system;
+}
+
+
 /*
  * first_and_last_ising_2d
  * -----------------------
  * Simulate an Ising system at multiple temperatures allowing them 
- * to relax to equilibrium. 
+ * to relax to equilibrium. The first and last state at each temperature 
+ * are stored as consecutive frames of a trajectory.
  *
  * parameters
  * ----------
@@ -302,46 +789,295 @@ void first_and_last_ising_2d(Config *config)
     float start = atof(find(config, "lowest_temperature"));
     float stop = atof(find(config, "highest_temperature"));
     float step = atof(find(config, "temperature_step"));
+    Engine2D engine = engine_ising_2d(config);
+    Rule rule = rule_ising_2d(config);
+    BurnIn burn_in = read_burn_in(config);
+    Telemetry *telemetry = config_telemetry(config, save_file_name, 
+        "first_and_last_ising_2d", (long) ((stop - start) / step));
 
     free(config);
 
-    int num_temps = (int) ((stop - start) / step);
-    int epochs = num_spins * num_spins * 1e3;
-    FILE *save_file = fopen(save_file_name, "w");
+    long epochs = num_spins * num_spins * 1e3;
 
-    int ind;
-    float temp;
+    // Each pair of first and last states shares a keyframe.
+    TrajectoryWriter *trajectory = open_trajectory(save_file_name, num_spins, 2);
+    Writer *writer = init_writer(16);
 
-    for (temp = start, ind = 0; temp < stop; temp += step, ind++)
+    for (float temp = start; temp < stop; temp += step)
     {
+        reset_telemetry();
         Ising2D* system = init_ising_2d(num_spins, temp);
+        set_rule_ising_2d(system, rule);
 
-        save_ising_2d(system, save_file);
+        start_telemetry(IO_PHASE);
+        write_frame_ising_2d(writer, trajectory, system);
 
-        // Running the metropolis algorithm over the system. 
-        for (int epoch = 0; epoch < epochs; epoch++)
-        { 
-            metropolis_step_ising_2d(system);
-        }
+        // Running the metropolis algorithm until the system settles. 
+        start_telemetry(BURN_IN_PHASE);
+        burn_in_ising_2d(system, &burn_in, epochs, engine);
+
+        start_telemetry(IO_PHASE);
+        write_frame_ising_2d(writer, trajectory, system);
+        free_ising_2d(system);
 
-        save_ising_2d(system, save_file);
+        char point[64];
+        snprintf(point, sizeof(point), "\"temperature\": %.4f", temp);
+        record_telemetry(telemetry, point);
     } 
 
-    fclose(save_file);
+    free_writer(writer);
+    close_trajectory(trajectory);
+    close_telemetry(telemetry);
+}
+
+
+void free_ising_2d(Ising2D *system)
+{
+    free(system -> streams);
+
+    if (system -> wolff != NULL)
+    {
+        free_wolff_2d(system -> wolff);
+    }
+
+    if (system -> multispin != NULL)
+    {
+        free_multispin_2d(system -> multispin);
+    }
+
+    free_lattice(system -> ensemble);
+    free(system);
 }
 
 
-void free_ising_2d(Ising2D *system)
-{
-    int length = system -> length;
+/*
+ * Parameters2D
+ * ------------
+ * The shared state of the tasks of physical_parameters_ising_2d. Each 
+ * task follows one run at one lattice size down the temperature grid and 
+ * stores its averages at [(num_spin * runs + run) * length + temp].
+ *
+ * parameters
+ * ----------
+ * const int *spin_nums: The three lattice sizes.
+ * int runs: The number of independent runs at each size.
+ * int length: The number of temperatures.
+ * float stop: The highest temperature.
+ * float step: The spacing of the temperatures.
+ * Engine2D engine: The algorithm used to evolve the systems.
+ * Rule rule: The acceptance rule used to evolve the systems.
+ * BurnIn burn_in: How long each run is evolved before it is measured.
+ * Sampling sampling: How many measurements each run takes.
+ * double target: The relative error each run should reach.
+ * double *difficulties: How hard each task is to measure at each 
+ *      temperature, only used by the pilot of a budget.
+ * double *energies: The mean energy of each task at each temperature.
+ * double *entropies: The mean entropy of each task at each temperature.
+ * double *heat_capacities: The heat capacity of each task at each 
+ *      temperature.
+ * double *susceptibilities: The susceptibility of each task at each 
+ *      temperature.
+ * double *autocorrelations: The integrated autocorrelation time of the 
+ *      energy of each task at each temperature in sweeps.
+ * double *effective_samples: The number of independent energy samples 
+ *      of each task at each temperature.
+ * int time_series: True if the raw measurements are to be kept.
+ * long *series_lengths: The number of measurements of each task at each 
+ *      temperature, only used with time_series.
+ * double **energy_series: The energy measurements of each task at each 
+ *      temperature, only used with time_series.
+ * double **magnetisation_series: The magnetisation measurements of each 
+ *      task at each temperature, only used with time_series.
+ * Histogram *histograms: The histogram of the aligned bonds and 
+ *      magnetisation of each task at each temperature, or NULL unless 
+ *      they are saved.
+ * Telemetry *telemetry: Where each run at each temperature is recorded, 
+ *      or NULL.
+ */
+typedef struct Parameters2D
+{
+    const int   *spin_nums;
+    int         runs;
+    int         length;
+    float       stop;
+    float       step;
+    Engine2D    engine;
+    Rule        rule;
+    BurnIn      burn_in;
+    Sampling    sampling;
+    double      target;
+    double      *difficulties;
+    double      *energies;
+    double      *entropies;
+    double      *heat_capacities;
+    double      *susceptibilities;
+    double      *autocorrelations;
+    double      *effective_samples;
+    int         time_series;
+    long        *series_lengths;
+    double      **energy_series;
+    double      **magnetisation_series;
+    Histogram   *histograms;
+    Telemetry   *telemetry;
+} Parameters2D;
+
+
+/*
+ * parameters_task_ising_2d
+ * ------------------------
+ * Equilibrate a single run and measure it at every temperature. The 
+ * spacing of the measurements is set from the autocorrelation time of 
+ * the energy at the previous temperature so that the samples are close 
+ * to independent, while the number of steps at each temperature stays 
+ * the same unless the sampling asks for a precision or a budget. At least 
+ * 4 BLOCKING_MINIMUM measurements are taken at each temperature so that 
+ * the stride can always be found.
+ *
+ * parameters
+ * ----------
+ * void *context: The Parameters2D of the workflow.
+ * int task: The index of the run, num_spin * runs + run.
+ */
+static void parameters_task_ising_2d(void *context, int task)
+{
+    Parameters2D *parameters = (Parameters2D*) context;
+    Engine2D engine = parameters -> engine;
+    int num_spins = parameters -> spin_nums[task / parameters -> runs];
+    int length = parameters -> length;
+    float stop = parameters -> stop;
+    float step = parameters -> step;
+    int epochs = num_spins * 1e3;
+    int pilot = parameters -> sampling.mode == PILOT_SAMPLING;
+    int time_series = parameters -> time_series && !pilot;
+    int histograms = (parameters -> histograms != NULL) && !pilot;
+    Telemetry *telemetry = pilot ? NULL : parameters -> telemetry;
+
+    // The burn-in is recorded with the first temperature.
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
+    Ising2D *system = init_ising_2d(num_spins, stop - step);
+    set_rule_ising_2d(system, parameters -> rule);
+    burn_in_ising_2d(system, &parameters -> burn_in, epochs, engine);
+
+    // The sweeping engines take 1000 / L sweeps at each temperature, which 
+    // is raised so that tau is always found from enough samples.
+    long interval = measurement_interval_ising_2d(system, engine);
+    long samples = epochs / interval > 4 * BLOCKING_MINIMUM ? 
+        epochs / interval : 4 * BLOCKING_MINIMUM;
+    long longest = samples / (4 * BLOCKING_MINIMUM);
+    long stride = 1;
+
+    for (int temp = 0; temp < length; temp++)
+    {
+        float temperature = stop - (temp + 1) * step;
+        int index = task * length + temp;
+        long measurements = samples / stride > 2 ? samples / stride : 2;
+        start_telemetry(MEASUREMENT_PHASE);
+        set_temperature_ising_2d(system, temperature);
+
+        Accumulator energies, entropies, squares;
+        Sampler sampler;
+        init_accumulator(&energies);
+        init_accumulator(&entropies);
+        init_accumulator(&squares);
+        init_sampler(&sampler, &parameters -> sampling, parameters -> target, 
+            measurements);
+        Blocking *blocking = &sampler.energies;
+
+        if (engine == WOLFF_2D)
+        {
+            reset_wolff_2d(system -> wolff);
+        }
+
+        Histogram *histogram = histograms ? 
+            &parameters -> histograms[index] : NULL;
+        if (histograms)
+        {
+            init_histogram(histogram, temperature, 0., 1., 
+                2l * num_spins * num_spins, num_spins * num_spins);
+            histogram -> run = task % parameters -> runs;
+        }
+
+        // The series grow if the sampling takes more than the fixed number.
+        long capacity = measurements;
+        if (time_series)
+        {
+            parameters -> energy_series[index] = (double*) malloc(
+                capacity * sizeof(double));
+            parameters -> magnetisation_series[index] = (double*) malloc(
+                capacity * sizeof(double));
+        }
+      
+        int done = 0;
+        for (long sample = 0; !done; sample++)
+        { 
+            evolve_ising_2d(system, stride * interval, engine);
+            double energy = energy_ising_2d(system);
+            double magnetisation = magnetisation_ising_2d(system);
+
+            if (time_series && (sample == capacity))
+            {
+                capacity *= 2;
+                parameters -> energy_series[index] = (double*) realloc(
+                    parameters -> energy_series[index], capacity * sizeof(double));
+                parameters -> magnetisation_series[index] = (double*) realloc(
+                    parameters -> magnetisation_series[index], capacity * sizeof(double));
+            }
+
+            if (time_series)
+            {
+                parameters -> energy_series[index][sample] = energy;
+                parameters -> magnetisation_series[index][sample] = magnetisation;
+            }
+
+            add_accumulator(&energies, energy);
+            add_accumulator(&entropies, entropy_ising_2d(system));
+            add_accumulator(&squares, magnetisation * magnetisation);
+            done = add_sampler(&sampler, energy, fabs(magnetisation));
+
+            if (histograms)
+            {
+                add_histogram(histogram, system -> aligned, system -> magnetisation);
+            }
+        }
+
+        if (time_series)
+        {
+            parameters -> series_lengths[index] = count_sampler(&sampler);
+        }
+
+        if (histograms)
+        {
+            finish_histogram(histogram);
+            histogram -> inefficiency = 2 * autocorrelation_blocking(blocking);
+        }
 
-    for (int row = 0; row < length; row++)
-    {
-        free(system -> ensemble[row]);
+        parameters -> energies[index] = mean_accumulator(&energies);
+        parameters -> entropies[index] = mean_accumulator(&entropies);
+        parameters -> heat_capacities[index] = 
+            variance_accumulator(&energies) / temperature / temperature;
+
+        // The cluster sizes give a less noisy estimate of <M^2>.
+        parameters -> susceptibilities[index] = (engine == WOLFF_2D) ?
+            susceptibility_wolff_2d(system -> wolff, temperature) :
+            mean_accumulator(&squares) / temperature;
+
+        parameters -> autocorrelations[index] = autocorrelation_blocking(blocking) * 
+            stride * interval / ((double) num_spins * num_spins);
+        parameters -> effective_samples[index] = effective_blocking(blocking);
+        parameters -> difficulties[index] = difficulty_sampler(&sampler);
+        stride = stride_blocking(blocking, stride, longest);
+
+        char point[192];
+        snprintf(point, sizeof(point), 
+            "\"length\": %i, \"run\": %i, \"temperature\": %.4f, "
+            "\"samples\": %li, \"relative_error\": %.6g", 
+            num_spins, task % parameters -> runs, temperature, 
+            count_sampler(&sampler), error_sampler(&sampler));
+        record_telemetry(telemetry, point);
     }
 
-    free(system -> ensemble);
-    free(system);
+    free_ising_2d(system);
 }
 
 
@@ -358,6 +1094,23 @@ void free_ising_2d(Ising2D *system)
  * and make sure that the system reaches thermodynamic equilibrium
  * before taking measurements. Present against the analytic solutions.
  *
+ * The runs at every size are independent and are shared between the 
+ * threads by the task runner.
+ *
+ * The results are written as csv unless the optional `output_format` 
+ * key is `columns`, in which case a columnar file is written that can 
+ * be mapped straight into numpy. With `time_series = true` the columnar 
+ * file also keeps every energy and magnetisation measurement of every 
+ * run. The time and flips of every run at every temperature are written 
+ * to a telemetry sidecar of the results, see config_telemetry, along 
+ * with the burn-in of each run, see read_burn_in.
+ *
+ * The optional `runs` key (5) is the number of runs at each size and the 
+ * sampling keys, see read_sampling, choose how long each run measures 
+ * each temperature. With the optional `histogram_file` key the histogram 
+ * of the aligned bonds and magnetisation of every run at every 
+ * temperature is saved there for wham_ising_2d.
+ *
  * parameters
  * ----------
  * Config *config: The configuration file detailing the simulation. 
@@ -372,76 +1125,106 @@ void physical_parameters_ising_2d(Config* config)
     float start = atof(find(config, "lowest_temperature"));
     float stop = atof(find(config, "highest_temperature"));
     float step = atof(find(config, "temperature_step"));
+    Engine2D engine = engine_ising_2d(config);
+    Rule rule = rule_ising_2d(config);
+    OutputFormat format = parse_output_format(find_default(config, "output_format", "csv"));
+    int time_series = strcmp(find_default(config, "time_series", "false"), "true") == 0;
+    char *histogram_file_name = find_default(config, "histogram_file", NULL);
 
-    int length = (int) ((stop - start) / step);
-    int runs = 5;
+    if (time_series && (format != COLUMNS_OUTPUT))
+    {
+        printf("Error: time_series needs output_format = columns");
+        exit(1);
+    }
 
-    float energies[length][2][3];
-    float entropies[length][2][3];
-    float free_energies[length][2][3];
-    float heat_capacities[length][2][3];
+    int length = (int) ((stop - start) / step);
+    int runs = atoi(find_default(config, "runs", "5"));
+    int tasks = 3 * runs;
+
+    double energies[length][2][3];
+    double entropies[length][2][3];
+    double free_energies[length][2][3];
+    double heat_capacities[length][2][3];
+    double susceptibilities[length][2][3];
+    double autocorrelations[length][3];
+    double effective_samples[length][3];
+
+    Parameters2D parameters;
+    parameters.spin_nums = spin_nums;
+    parameters.runs = runs;
+    parameters.length = length;
+    parameters.stop = stop;
+    parameters.step = step;
+    parameters.engine = engine;
+    parameters.rule = rule;
+    parameters.burn_in = read_burn_in(config);
+    parameters.sampling = read_sampling(config);
+    parameters.target = parameters.sampling.precision * sqrt(runs);
+    parameters.difficulties = (double*) calloc(tasks * length, sizeof(double));
+    parameters.energies = (double*) calloc(tasks * length, sizeof(double));
+    parameters.entropies = (double*) calloc(tasks * length, sizeof(double));
+    parameters.heat_capacities = (double*) calloc(tasks * length, sizeof(double));
+    parameters.susceptibilities = (double*) calloc(tasks * length, sizeof(double));
+    parameters.autocorrelations = (double*) calloc(tasks * length, sizeof(double));
+    parameters.effective_samples = (double*) calloc(tasks * length, sizeof(double));
+    parameters.time_series = time_series;
+    parameters.series_lengths = (long*) calloc(tasks * length, sizeof(long));
+    parameters.energy_series = (double**) calloc(tasks * length, sizeof(double*));
+    parameters.magnetisation_series = (double**) calloc(tasks * length, sizeof(double*));
+    parameters.histograms = (histogram_file_name == NULL) ? NULL : 
+        (Histogram*) calloc(tasks * length, sizeof(Histogram));
+    parameters.telemetry = config_telemetry(config, save_file_name, 
+        "physical_parameters_ising_2d", tasks * length);
+
+    // Every run takes 1000 L steps at each temperature and in the burn-in, 
+    // or 128 sweeps for the sweeping engines if that is more.
+    double costs[tasks];
+    for (int task = 0; task < tasks; task++)
+    {
+        costs[task] = 1e3 * spin_nums[task / runs] * (length + 1);
+    }
 
-    Ising2D **systems = (Ising2D**) calloc(runs, sizeof(Ising2D*));
+    run_sampling(parameters_task_ising_2d, &parameters, tasks, costs, 
+        &parameters.sampling, &parameters.target, parameters.difficulties, 
+        tasks * length);
     
     for (int num_spin = 0; num_spin < 3; num_spin++)
     {
         int num_spins = spin_nums[num_spin];
-        int epochs = num_spins * 1e3;
-
-        for (int run = 0; run < runs; run++)
-        {
-            systems[run] = init_ising_2d(num_spins, stop - step);
-
-            for (int epoch = 0; epoch < epochs; epoch++)
-            {
-                metropolis_step_ising_2d(systems[run]);
-            }
-        }
 
         for (int temp = 0; temp < length; temp++)
         {
             float temperature = stop - (temp + 1) * step;
-            float _energies[runs];
-            float _entropies[runs];
-            float _heat_capacities[runs];
-
-            printf("Temperature: %.2f\n", temperature);
-            for (int run = 0; run < runs; run++)
-            {
-                systems[run] -> temperature = temperature;
-            }
+            double _energies[runs];
+            double _entropies[runs];
+            double _heat_capacities[runs];
+            double _susceptibilities[runs];
+            double _autocorrelations[runs];
+            double _effective_samples[runs];
 
             for (int run = 0; run < runs; run++)
             {
-                float *__energies = (float*) calloc(epochs, sizeof(float));
-                float *__entropies = (float*) calloc(epochs, sizeof(float));
-              
-                for (int epoch = 0; epoch < epochs; epoch++)
-                { 
-                    metropolis_step_ising_2d(systems[run]);
-                    float energy = energy_ising_2d(systems[run]);
-                    float entropy = entropy_ising_2d(systems[run]);
-
-                    __energies[epoch] = energy;
-                    __entropies[epoch] = entropy;
-                }
-
-                _energies[run] = mean(__energies, epochs);
-                _entropies[run] = mean(__entropies, epochs);
-                _heat_capacities[run] = variance(__energies, _energies[run], epochs) / 
-                    temperature / temperature;
+                int index = (num_spin * runs + run) * length + temp;
+                _energies[run] = parameters.energies[index];
+                _entropies[run] = parameters.entropies[index];
+                _heat_capacities[run] = parameters.heat_capacities[index];
+                _susceptibilities[run] = parameters.susceptibilities[index];
+                _autocorrelations[run] = parameters.autocorrelations[index];
+                _effective_samples[run] = parameters.effective_samples[index];
             }
 
-            float number = num_spins * num_spins;
-            float energy_est = mean(_energies, runs);
-            float entropy_est = mean(_entropies, runs);
-            float free_energy_est = energy_est - temperature * entropy_est;
-            float heat_capacity_est = mean(_heat_capacities, runs);
+            double number = num_spins * num_spins;
+            double energy_est = mean(_energies, runs);
+            double entropy_est = mean(_entropies, runs);
+            double free_energy_est = energy_est - temperature * entropy_est;
+            double heat_capacity_est = mean(_heat_capacities, runs);
 
-            float energy_err = sqrt(variance(_energies, energy_est, runs) / runs);
-            float entropy_err = sqrt(variance(_entropies, entropy_est, runs) / runs);
-            float free_energy_err = energy_err + temperature * entropy_err;
-            float heat_capacity_err = sqrt(variance(_heat_capacities, heat_capacity_est, runs) / runs);
+            double energy_err = sqrt(variance(_energies, energy_est, runs) / runs);
+            double entropy_err = sqrt(variance(_entropies, entropy_est, runs) / runs);
+            double free_energy_err = energy_err + temperature * entropy_err;
+            double heat_capacity_err = sqrt(variance(_heat_capacities, heat_capacity_est, runs) / runs);
+            double susceptibility_est = mean(_susceptibilities, runs);
+            double susceptibility_err = sqrt(variance(_susceptibilities, susceptibility_est, runs) / runs);
 
             energies[temp][1][num_spin] = energy_err / number;
             energies[temp][0][num_spin] = energy_est / number;
@@ -451,15 +1234,98 @@ void physical_parameters_ising_2d(Config* config)
             free_energies[temp][0][num_spin] = free_energy_est / number;
             heat_capacities[temp][0][num_spin] = heat_capacity_est / number;
             heat_capacities[temp][1][num_spin] = heat_capacity_err / number;
+            susceptibilities[temp][0][num_spin] = susceptibility_est / number;
+            susceptibilities[temp][1][num_spin] = susceptibility_err / number;
+            autocorrelations[temp][num_spin] = mean(_autocorrelations, runs);
+            effective_samples[temp][num_spin] = mean(_effective_samples, runs);
+        }
+    }
+
+    free(parameters.difficulties);
+    free(parameters.energies);
+    free(parameters.entropies);
+    free(parameters.heat_capacities);
+    free(parameters.susceptibilities);
+    free(parameters.autocorrelations);
+    free(parameters.effective_samples);
+    start_telemetry(IO_PHASE);
+
+    if (histogram_file_name != NULL)
+    {
+        save_histograms(histogram_file_name, parameters.histograms, 
+            tasks * length);
+
+        for (int index = 0; index < tasks * length; index++)
+        {
+            free_histogram(&parameters.histograms[index]);
+        }
+
+        free(parameters.histograms);
+    }
+
+    if (format == COLUMNS_OUTPUT)
+    {
+        const char *names[] = {"Number", "Temperature", 
+            "Energy", "Energy Error", 
+            "Entropy", "Entropy Error", 
+            "Free Energy", "Free Energy Error", 
+            "Heat Capacity", "Heat Capacity Error", 
+            "Susceptibility", "Susceptibility Error", 
+            "Autocorrelation Time", "Effective Samples"};
+        Columns *columns = init_columns(14, names);
+
+        for (int num_spin = 0; num_spin < 3; num_spin++)
+        {
+            for (int temp = 0; temp < length; temp++)
+            {
+                double row[] = {spin_nums[num_spin], stop - (temp + 1) * step,
+                    energies[temp][0][num_spin], energies[temp][1][num_spin],
+                    entropies[temp][0][num_spin], entropies[temp][1][num_spin],
+                    free_energies[temp][0][num_spin], free_energies[temp][1][num_spin],
+                    heat_capacities[temp][0][num_spin], heat_capacities[temp][1][num_spin],
+                    susceptibilities[temp][0][num_spin], susceptibilities[temp][1][num_spin],
+                    autocorrelations[temp][num_spin], effective_samples[temp][num_spin]};
+                add_row_columns(columns, row);
+            }
         }
 
-        for (int run = 0; run < runs; run++)
+        // The series are named after the size, run and temperature.
+        for (int index = 0; time_series && (index < tasks * length); index++)
         {
-            free_ising_2d(systems[run]);
+            char name[COLUMN_NAME_LENGTH];
+            int task = index / length;
+            int temp = index % length;
+            float temperature = stop - (temp + 1) * step;
+
+            snprintf(name, COLUMN_NAME_LENGTH, "Energy L%i R%i T%.3f", 
+                spin_nums[task / runs], task % runs, temperature);
+            add_series_columns(columns, name, parameters.energy_series[index], 
+                parameters.series_lengths[index]);
+            snprintf(name, COLUMN_NAME_LENGTH, "Magnetisation L%i R%i T%.3f", 
+                spin_nums[task / runs], task % runs, temperature);
+            add_series_columns(columns, name, parameters.magnetisation_series[index], 
+                parameters.series_lengths[index]);
         }
+
+        save_columns(columns, save_file_name);
+        free_columns(columns);
+    }
+
+    for (int index = 0; index < tasks * length; index++)
+    {
+        free(parameters.energy_series[index]);
+        free(parameters.magnetisation_series[index]);
     }
 
-    free(systems);
+    free(parameters.series_lengths);
+    free(parameters.energy_series);
+    free(parameters.magnetisation_series);
+
+    if (format == COLUMNS_OUTPUT)
+    {
+        close_telemetry(parameters.telemetry);
+        return;
+    }
 
 	// Writing the data to the file
 	FILE* data = fopen(save_file_name, "w");
@@ -475,7 +1341,9 @@ void physical_parameters_ising_2d(Config* config)
     fprintf(data, "Energy, Energy Error, "); 
     fprintf(data, "Entropy, Entropy Error, "); 
     fprintf(data, "Free Energy, Free Energy Error, "); 
-    fprintf(data, "Heat Capacity, Heat Capacity Error\n");
+    fprintf(data, "Heat Capacity, Heat Capacity Error, ");
+    fprintf(data, "Susceptibility, Susceptibility Error, ");
+    fprintf(data, "Autocorrelation Time, Effective Samples\n");
 
     // TODO: Change the 3D tensors into two 2D tensors. 
     for (int num_spin = 0; num_spin < 3; num_spin++)
@@ -492,36 +1360,355 @@ void physical_parameters_ising_2d(Config* config)
             fprintf(data, "%f, ", free_energies[temp][0][num_spin]);
             fprintf(data, "%f, ", free_energies[temp][1][num_spin]);
             fprintf(data, "%f, ", heat_capacities[temp][0][num_spin]);
-            fprintf(data, "%f\n", heat_capacities[temp][1][num_spin]);
+            fprintf(data, "%f, ", heat_capacities[temp][1][num_spin]);
+            fprintf(data, "%f, ", susceptibilities[temp][0][num_spin]);
+            fprintf(data, "%f, ", susceptibilities[temp][1][num_spin]);
+            fprintf(data, "%f, ", autocorrelations[temp][num_spin]);
+            fprintf(data, "%f\n", effective_samples[temp][num_spin]);
         }
     }
 	
 	fclose(data);
+    close_telemetry(parameters.telemetry);
+}
+
+
+/*
+ * wham_ising_2d
+ * -------------
+ * Combine the histograms saved by physical_parameters_ising_2d into 
+ * smooth curves of the energy, magnetisation, heat capacity and 
+ * susceptibility per spin against temperature without any more 
+ * simulation. The histograms of each size are combined with init_wham and 
+ * solve_wham, and the errors are jackknife errors over the runs, leaving 
+ * out every histogram of one run in turn. 
+ *
+ * The `histogram_file` key is the saved histograms and the curves are 
+ * written to `save_file`. The optional keys are `lowest_temperature` and 
+ * `highest_temperature` (the sampled range), `temperature_step` (0.001), 
+ * `wham_tolerance` (1e-7), `wham_iterations` (100000) and 
+ * `output_format`. A point is marked unreliable when it is too far beyond 
+ * the sampled temperatures or falls in a gap between two histograms that 
+ * do not overlap, see reweight_wham. The histograms are weighted by 
+ * their statistical inefficiency, which physical_parameters_ising_2d 
+ * saves from the autocorrelation time of each run.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the analysis.
+ */
+void wham_ising_2d(Config *config)
+{
+    char *histogram_file_name = find(config, "histogram_file");
+    char *save_file_name = find(config, "save_file");
+    char *lowest_key = find_default(config, "lowest_temperature", NULL);
+    char *highest_key = find_default(config, "highest_temperature", NULL);
+    double step = atof(find_default(config, "temperature_step", "0.001"));
+    double tolerance = atof(find_default(config, "wham_tolerance", "1e-7"));
+    int limit = atoi(find_default(config, "wham_iterations", "100000"));
+    OutputFormat format = parse_output_format(find_default(config, "output_format", "csv"));
+
+    int number;
+    Histogram *histograms = load_histograms(histogram_file_name, &number);
+    double start = INFINITY, stop = 0;
+    int num_sizes = 0;
+    long sizes[number];
+
+    for (int index = 0; index < number; index++)
+    {
+        double temperature = histograms[index].temperature;
+        long sites = histograms[index].sites;
+        int size = 0;
+
+        start = (temperature < start) ? temperature : start;
+        stop = (temperature > stop) ? temperature : stop;
+
+        // The sizes are kept in increasing order.
+        while ((size < num_sizes) && (sizes[size] < sites))
+        {
+            size++;
+        }
+
+        if ((size == num_sizes) || (sizes[size] != sites))
+        {
+            for (int later = num_sizes++; later > size; later--)
+            {
+                sizes[later] = sizes[later - 1];
+            }
+
+            sizes[size] = sites;
+        }
+    }
+
+    start = (lowest_key == NULL) ? start : atof(lowest_key);
+    stop = (highest_key == NULL) ? stop : atof(highest_key);
+
+    if ((step <= 0) || (stop < start))
+    {
+        printf("Error: The temperatures must be increasing!");
+        exit(1);
+    }
+
+    // The grid ends on stop if it is a whole number of steps from start, 
+    // which is only found to within the rounding of the saved temperatures.
+    double steps = (stop - start) / step;
+    int whole = fabs(steps - round(steps)) < 1e-3;
+    int length = (int) (whole ? round(steps) : floor(steps)) + 1;
+    double *grid = (double*) malloc(length * sizeof(double));
+
+    for (int temp = 0; temp < length; temp++)
+    {
+        grid[temp] = (whole && (temp == length - 1)) ? stop : start + temp * step;
+    }
+
+    double *rows = (double*) calloc(num_sizes * length * 11, sizeof(double));
+
+    for (int size = 0; size < num_sizes; size++)
+    {
+        Histogram group[number];
+        int run_ids[number];
+        int count = 0, runs = 0;
+
+        for (int index = 0; index < number; index++)
+        {
+            if (histograms[index].sites != sizes[size])
+            {
+                continue;
+            }
+
+            int run = 0;
+            while ((run < runs) && (run_ids[run] != histograms[index].run))
+            {
+                run++;
+            }
+
+            run_ids[run] = histograms[index].run;
+            runs += (run == runs);
+            group[count++] = histograms[index];
+        }
+
+        Wham wham;
+        init_wham(&wham, group, count, -1);
+        int iterations = solve_wham(&wham, tolerance, limit);
+        printf("Number of spins %li: %i histograms at %i temperatures, "
+            "solved in %i iterations\n", sizes[size], count, 
+            wham.temperatures, iterations);
+
+        // The jackknife estimates of each observable at each temperature.
+        double *estimates = (double*) calloc(runs * length * 4, sizeof(double));
+
+        for (int run = 0; (runs > 1) && (run < runs); run++)
+        {
+            Wham jackknife;
+            init_wham(&jackknife, group, count, run_ids[run]);
+
+            if (jackknife.temperatures == wham.temperatures)
+            {
+                for (int temperature = 0; temperature < wham.temperatures; temperature++)
+                {
+                    jackknife.free_energies[temperature] = 
+                        wham.free_energies[temperature];
+                }
+            }
+
+            solve_wham(&jackknife, tolerance, limit);
+
+            for (int temp = 0; temp < length; temp++)
+            {
+                Reweighted reweighted = reweight_wham(&jackknife, grid[temp]);
+                double *estimate = estimates + (run * length + temp) * 4;
+                estimate[0] = reweighted.energy;
+                estimate[1] = reweighted.magnetisation;
+                estimate[2] = reweighted.heat_capacity;
+                estimate[3] = reweighted.susceptibility;
+            }
+
+            free_wham(&jackknife);
+        }
+
+        for (int temp = 0; temp < length; temp++)
+        {
+            double temperature = grid[temp];
+            Reweighted reweighted = reweight_wham(&wham, temperature);
+            double values[] = {reweighted.energy, reweighted.magnetisation, 
+                reweighted.heat_capacity, reweighted.susceptibility};
+            double *row = rows + (size * length + temp) * 11;
+
+            row[0] = (int) (sqrt(sizes[size]) + 0.5);
+            row[1] = temperature;
+            row[10] = reweighted.shift <= 1.;
+
+            for (int quantity = 0; quantity < 4; quantity++)
+            {
+                double centre = 0, spread = 0;
+
+                for (int run = 0; (runs > 1) && (run < runs); run++)
+                {
+                    centre += estimates[(run * length + temp) * 4 + quantity] / runs;
+                }
+
+                for (int run = 0; (runs > 1) && (run < runs); run++)
+                {
+                    double deviation = 
+                        estimates[(run * length + temp) * 4 + quantity] - centre;
+                    spread += deviation * deviation * (runs - 1) / runs;
+                }
+
+                row[2 + 2 * quantity] = values[quantity] / sizes[size];
+                row[3 + 2 * quantity] = sqrt(spread) / sizes[size];
+            }
+        }
+
+        free(estimates);
+        free_wham(&wham);
+    }
+
+    for (int index = 0; index < number; index++)
+    {
+        free_histogram(&histograms[index]);
+    }
+
+    free(histograms);
+    free(grid);
+
+    const char *names[] = {"Number", "Temperature", 
+        "Energy", "Energy Error", 
+        "Magnetisation", "Magnetisation Error", 
+        "Heat Capacity", "Heat Capacity Error", 
+        "Susceptibility", "Susceptibility Error", "Reliable"};
+
+    if (format == COLUMNS_OUTPUT)
+    {
+        Columns *columns = init_columns(11, names);
+
+        for (int row = 0; row < num_sizes * length; row++)
+        {
+            add_row_columns(columns, rows + row * 11);
+        }
+
+        save_columns(columns, save_file_name);
+        free_columns(columns);
+        free(rows);
+        return;
+    }
+
+    FILE *data = fopen(save_file_name, "w");
+
+    if (data == NULL)
+    {
+        printf("Error: Could not open '%s'", save_file_name);
+        exit(1);
+    }
+
+    for (int column = 0; column < 11; column++)
+    {
+        fprintf(data, (column < 10) ? "%s, " : "%s\n", names[column]);
+    }
+
+    for (int row = 0; row < num_sizes * length; row++)
+    {
+        double *values = rows + row * 11;
+        fprintf(data, "%i, ", (int) values[0]);
+
+        for (int column = 1; column < 10; column++)
+        {
+            fprintf(data, "%f, ", values[column]);
+        }
+
+        fprintf(data, "%i\n", (int) values[10]);
+    }
+
+    fclose(data);
+    free(rows);
 }
 
 
 /*
- * zeros
- * -----
- * Construct an array of zeros as floats.
+ * Magnetisation2D
+ * ---------------
+ * The shared state of the tasks of magnetisation_vs_temperature_ising_2d. 
+ * Each task follows one repetition at one lattice size down the 
+ * temperature grid and stores its magnetisations at 
+ * [(num * num_reps + iter) * length + temp].
  *
  * parameters
  * ----------
- * int size: The length of the one-dimensional array. 
+ * const int *spin_nums: The three lattice sizes.
+ * int num_reps: The number of repetitions at each size.
+ * int length: The number of temperatures.
+ * float stop: The highest temperature.
+ * float step: The spacing of the temperatures.
+ * Engine2D engine: The algorithm used to evolve the systems.
+ * Rule rule: The acceptance rule used to evolve the systems.
+ * BurnIn burn_in: How long each repetition is evolved before it is 
+ *      measured.
+ * double *magnetisations: The magnetisation of each task at each 
+ *      temperature.
+ * Telemetry *telemetry: Where each repetition at each temperature is 
+ *      recorded, or NULL.
+ */
+typedef struct Magnetisation2D
+{
+    const int   *spin_nums;
+    int         num_reps;
+    int         length;
+    float       stop;
+    float       step;
+    Engine2D    engine;
+    Rule        rule;
+    BurnIn      burn_in;
+    double      *magnetisations;
+    Telemetry   *telemetry;
+} Magnetisation2D;
+
+
+/*
+ * magnetisation_task_ising_2d
+ * ---------------------------
+ * Equilibrate a single repetition and record its magnetisation at every 
+ * temperature.
  *
- * returns
- * float *arr: A floating point array full of zeros. 
+ * parameters
+ * ----------
+ * void *context: The Magnetisation2D of the workflow.
+ * int task: The index of the repetition, num * num_reps + iter.
  */
-float *zeros(int size)
+static void magnetisation_task_ising_2d(void *context, int task)
 {
-    float *zeros = (float*) calloc(size, sizeof(float));
+    Magnetisation2D *magnetisation = (Magnetisation2D*) context;
+    Engine2D engine = magnetisation -> engine;
+    int num_spins = magnetisation -> spin_nums[task / magnetisation -> num_reps];
+    int length = magnetisation -> length;
+    float stop = magnetisation -> stop;
+    float step = magnetisation -> step;
+    int epochs = 1e3 * num_spins * num_spins;
+
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
+    Ising2D *system = init_ising_2d(num_spins, stop - step);
+    set_rule_ising_2d(system, magnetisation -> rule);
     
-    for (int elem = 0; elem < size; elem++)
+    // Running the burnin-period.  
+    burn_in_ising_2d(system, &magnetisation -> burn_in, epochs, engine);
+
+    for (int temp = 0; temp < length; temp++)
     {
-        zeros[elem] = 0.0;
+        float temperature = system -> temperature;
+        start_telemetry(MEASUREMENT_PHASE);
+        evolve_ising_2d(system, 1e3 * num_spins, engine);
+
+        magnetisation -> magnetisations[task * length + temp] = 
+            (double) magnetisation_ising_2d(system);
+        set_temperature_ising_2d(system, stop - ((float) (temp + 1)) * step);
+
+        char point[128];
+        snprintf(point, sizeof(point), 
+            "\"length\": %i, \"repetition\": %i, \"temperature\": %.4f", 
+            num_spins, task % magnetisation -> num_reps, temperature);
+        record_telemetry(magnetisation -> telemetry, point);
     }
 
-    return zeros;
+    free_ising_2d(system);
 }
 
 
@@ -529,7 +1716,12 @@ float *zeros(int size)
  * magnetisation_vs_temperature
  * ----------------------------
  * This maps the positive and negative magnetisations of the system to 
- * the temperature. 
+ * the temperature. The repetitions at every size are independent and are 
+ * shared between the threads by the task runner. The results are written 
+ * as csv unless the optional `output_format` key is `columns`, and the 
+ * time and flips of each repetition at each temperature are written to 
+ * a telemetry sidecar along with the burn-in of each repetition, see 
+ * read_burn_in.
  *
  * parameters
  * ----------
@@ -547,90 +1739,90 @@ void magnetisation_vs_temperature_ising_2d(Config* config)
     float step = atof(find(config, "temperature_step"));
     int length = (int) ((stop - start) / step);
     int num_reps = 100;
+    Engine2D engine = engine_ising_2d(config);
+    Rule rule = rule_ising_2d(config);
+    OutputFormat format = parse_output_format(find_default(config, "output_format", "csv"));
+
+    double magnetisations[3][length][2][2]; // Num, temp, sign, est/err
+    int tasks = 3 * num_reps;
+
+    Magnetisation2D magnetisation;
+    magnetisation.spin_nums = spin_nums;
+    magnetisation.num_reps = num_reps;
+    magnetisation.length = length;
+    magnetisation.stop = stop;
+    magnetisation.step = step;
+    magnetisation.engine = engine;
+    magnetisation.rule = rule;
+    magnetisation.burn_in = read_burn_in(config);
+    magnetisation.magnetisations = (double*) calloc(tasks * length, sizeof(double));
+    magnetisation.telemetry = config_telemetry(config, save_file_name, 
+        "magnetisation_vs_temperature_ising_2d", tasks * length);
+
+    // The burn-in of 1000 sweeps dominates the 1000 L steps per temperature.
+    double costs[tasks];
+    for (int task = 0; task < tasks; task++)
+    {
+        double num_spins = spin_nums[task / num_reps];
+        costs[task] = 1e3 * num_spins * (num_spins + length);
+    }
 
-    float magnetisations[3][length][2][2]; // Num, temp, sign, est/err
-    Ising2D *system;
+    run_tasks(magnetisation_task_ising_2d, &magnetisation, tasks, costs);
 
     for (int num = 0; num < 3; num++)
     {
-        float sim_mags[length][num_reps];
-        int epochs = 1e3 * spin_nums[num] * spin_nums[num];
-        
-        for (int iter = 0; iter < num_reps; iter++)
-        {
-            system = init_ising_2d(spin_nums[num], stop - step);
-            
-            // Running the burnin-period.  
-            for (int epoch = 0; epoch < epochs; epoch++)
-            {
-                metropolis_step_ising_2d(system);
-            }
-
-            for (int temp = 0; temp < length; temp++)
-            {
-                for (int _ = 0; _ < 1e3 * spin_nums[num]; _++)
-                {
-                    metropolis_step_ising_2d(system);
-                }
-
-                sim_mags[temp][iter] = (float) magnetisation_ising_2d(system);
-                system -> temperature = (stop - ((float) (temp + 1)) * step);
-            }
-       }
-
         for (int temp = 0; temp < length; temp++)
         {
-            int num_pos = 0;
+            Accumulator positives, negatives;
+            init_accumulator(&positives);
+            init_accumulator(&negatives);
 
             for (int iter = 0; iter < num_reps; iter++)
             {
-                num_pos += (sim_mags[temp][iter] > 0);
-            } 
-    
-            int num_neg = num_reps - num_pos;
+                double sim_mag = magnetisation.magnetisations[
+                    (num * num_reps + iter) * length + temp];
+                add_accumulator((sim_mag > 0) ? &positives : &negatives, sim_mag);
+            }
 
-            if ((num_neg == 0) || (num_pos == 0))
+            if ((negatives.count == 0) || (positives.count == 0))
             {
                 printf("Error: Either no negative or positive runs occurred");
                 exit(1);
             }
 
-            float *positives = zeros(num_pos);
-            float *negatives = zeros(num_neg);
-
-            int pos = 0, neg = 0;
-            for (int iter = 0; iter < num_reps; iter++)
-            {
-                if (sim_mags[temp][iter] > 0)
-                {
-                    positives[pos] = sim_mags[temp][iter];
-                    pos++;
-                }
-                else
-                {
-                    negatives[neg] = sim_mags[temp][iter];
-                    neg++;
-                }
-            }
-
-            float pos_mag_est = mean(positives, num_pos);
-            float pos_mag_err = variance(positives, pos_mag_est, num_pos);
+            magnetisations[num][temp][0][0] = mean_accumulator(&positives);
+            magnetisations[num][temp][0][1] = error_accumulator(&positives);
+            magnetisations[num][temp][1][0] = mean_accumulator(&negatives);
+            magnetisations[num][temp][1][1] = error_accumulator(&negatives);
+        }
+    }
 
-            float neg_mag_est = mean(negatives, num_neg);
-            float neg_mag_err = variance(negatives, neg_mag_est, num_neg);
+    free(magnetisation.magnetisations);
+    start_telemetry(IO_PHASE);
 
-            free(positives);
-            free(negatives);
+    if (format == COLUMNS_OUTPUT)
+    {
+        const char *names[] = {"Number", "Temperature", 
+            "Positive Magnetisation", "Positive Magnetisation Error", 
+            "Negative Magnetisation", "Negative Magnetisation Error"};
+        Columns *columns = init_columns(6, names);
 
-            // TODO: Improve the error by dividing by sqrt(reps)
-            magnetisations[num][temp][0][0] = pos_mag_est;
-            magnetisations[num][temp][0][1] = sqrt(pos_mag_err / (float) num_pos);
-            magnetisations[num][temp][1][0] = neg_mag_est;
-            magnetisations[num][temp][1][1] = sqrt(neg_mag_err / (float) num_neg);
+        for (int num = 0; num < 3; num++)
+        {
+            for (int temp = 0; temp < length; temp++)
+            {
+                double row[] = {spin_nums[num], stop - (temp + 1) * step,
+                    magnetisations[num][temp][0][0], magnetisations[num][temp][0][1],
+                    magnetisations[num][temp][1][0], magnetisations[num][temp][1][1]};
+                add_row_columns(columns, row);
+            }
         }
-    }
 
-    free_ising_2d(system);
+        save_columns(columns, save_file_name);
+        free_columns(columns);
+        close_telemetry(magnetisation.telemetry);
+        return;
+    }
 
     FILE *save_file = fopen(save_file_name, "w");
 
@@ -654,6 +1846,38 @@ void magnetisation_vs_temperature_ising_2d(Config* config)
     }
     
     fclose(save_file); 
+    close_telemetry(magnetisation.telemetry);
+}
+
+
+/*
+ * settle_ising_2d
+ * ---------------
+ * Burn the system in at its current temperature and record the burn-in 
+ * as a point of the telemetry.
+ *
+ * parameters
+ * ----------
+ * Ising2D *system: The system to settle.
+ * const BurnIn *burn_in: The burn-in options of the workflow.
+ * long steps: The fixed burn-in of the workflow.
+ * Engine2D engine: The algorithm to use.
+ * Telemetry *telemetry: Where the burn-in is recorded, or NULL.
+ */
+static void settle_ising_2d(
+    Ising2D *system, 
+    const BurnIn *burn_in, 
+    long steps, 
+    Engine2D engine, 
+    Telemetry *telemetry)
+{
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
+    burn_in_ising_2d(system, burn_in, steps, engine);
+
+    char point[64];
+    snprintf(point, sizeof(point), "\"temperature\": %.4f", system -> temperature);
+    record_telemetry(telemetry, point);
 }
 
 
@@ -661,7 +1885,9 @@ void magnetisation_vs_temperature_ising_2d(Config* config)
  * cooling_and_heating
  * -------------------
  * Steadily heat and then cool the system to observe the phase transistion 
- * in each direction.
+ * in each direction. The system is burnt in at every temperature, see 
+ * read_burn_in, and the burn-in of each temperature is written to a 
+ * telemetry sidecar.
  *
  * parameters
  * ----------
@@ -675,43 +1901,98 @@ void heating_and_cooling_ising_2d(Config *config)
     float stop = atof(find(config, "highest_temperature"));
     float step = atof(find(config, "temperature_step"));
     int length = (int) ((stop - start) / step);
-    int epochs = num_spins * num_spins * 1e3;
+    long epochs = num_spins * num_spins * 1e3;
+    Engine2D engine = engine_ising_2d(config);
+    Rule rule = rule_ising_2d(config);
+    BurnIn burn_in = read_burn_in(config);
+    Telemetry *telemetry = config_telemetry(config, save_file_name, 
+        "heating_and_cooling_ising_2d", 3 * length);
 
     Ising2D *system = init_ising_2d(num_spins, stop);
+    set_rule_ising_2d(system, rule);
     FILE *save_file = fopen(save_file_name, "w");
 
     do
     {
-        system -> temperature -= step;
-        for (int epoch = 0; epoch < epochs; epoch++)
-        {
-            metropolis_step_ising_2d(system);
-        }
+        set_temperature_ising_2d(system, system -> temperature - step);
+        settle_ising_2d(system, &burn_in, epochs, engine, telemetry);
     } while (system -> temperature > (start + step));
 
     save_ising_2d(system, save_file);
 
     while (system -> temperature < stop)
     {
-        system -> temperature += step;
-        for (int epoch = 0; epoch < epochs; epoch++)
-        {
-            metropolis_step_ising_2d(system);
-        }
+        set_temperature_ising_2d(system, system -> temperature + step);
+        settle_ising_2d(system, &burn_in, epochs, engine, telemetry);
     }
 
     save_ising_2d(system, save_file);
 
     do
     {
-        system -> temperature -= step;
-        for (int epoch = 0; epoch < epochs; epoch++)
-        {
-            metropolis_step_ising_2d(system);
-        }
+        set_temperature_ising_2d(system, system -> temperature - step);
+        settle_ising_2d(system, &burn_in, epochs, engine, telemetry);
     } while (system -> temperature > (start + step));
 
     save_ising_2d(system, save_file);
     fclose(save_file);
     free_ising_2d(system);
+    close_telemetry(telemetry);
+}
+
+
+/*
+ * long_run_ising_2d
+ * -----------------
+ * Evolve a single system for a long time at a fixed temperature, saving 
+ * a checkpoint at regular intervals. If the checkpoint file already 
+ * exists the run carries on from it, so a run that is interrupted can be 
+ * restarted with the same configuration and finishes in the same state 
+ * as if it had never stopped. The checkpoints are written by a 
+ * background thread while the run carries on.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the system.
+ */
+void long_run_ising_2d(Config *config)
+{
+    int num_spins = atoi(find(config, "number_of_spins"));
+    float temperature = atof(find(config, "temperature"));
+    long steps = atol(find(config, "steps"));
+    char *checkpoint_file = find(config, "checkpoint_file");
+    long interval = atol(find_default(config, "checkpoint_interval", "0"));
+    Engine2D engine = engine_ising_2d(config);
+    Rule rule = rule_ising_2d(config);
+
+    if (interval <= 0)
+    {
+        interval = steps;
+    }
+
+    Ising2D *system;
+    Writer *writer = init_writer(2);
+
+    if (access(checkpoint_file, F_OK) == 0)
+    {
+        system = load_checkpoint_ising_2d(checkpoint_file);
+        printf("Restarting from step %li\n", system -> steps);
+    }
+    else
+    {
+        system = init_ising_2d(num_spins, temperature);
+        set_rule_ising_2d(system, rule);
+    }
+
+    while (system -> steps < steps)
+    {
+        long remaining = steps - system -> steps;
+        evolve_ising_2d(system, remaining < interval ? remaining : interval, engine);
+        save_checkpoint_ising_2d(writer, system, checkpoint_file);
+        printf("Step %li of %li: energy %f, magnetisation %i\n", system -> steps, 
+            steps, energy_ising_2d(system), magnetisation_ising_2d(system));
+    }
+
+    free_writer(writer);
+    free_ising_2d(system);
 }
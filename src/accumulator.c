@@ -0,0 +1,249 @@
+#include<math.h>
+#include"include/accumulator.h"
+
+
+/*
+ * compensated_sum
+ * ---------------
+ * Add to a running sum with Kahan compensation.
+ *
+ * parameters
+ * ----------
+ * double *sum: The running sum.
+ * double *error: The rounding error of the running sum.
+ * double term: The value to add.
+ */
+static inline void compensated_sum(double *sum, double *error, double term)
+{
+    double corrected = term - *error;
+    double total = *sum + corrected;
+    *error = (total - *sum) - corrected;
+    *sum = total;
+}
+
+
+/*
+ * init_accumulator
+ * ----------------
+ * Empty an accumulator.
+ *
+ * parameters
+ * ----------
+ * Accumulator *accumulator: The accumulator to reset.
+ */
+void init_accumulator(Accumulator *accumulator)
+{
+    accumulator -> count = 0;
+    accumulator -> mean = 0.;
+    accumulator -> mean_error = 0.;
+    accumulator -> second = 0.;
+    accumulator -> second_error = 0.;
+    accumulator -> third = 0.;
+    accumulator -> fourth = 0.;
+}
+
+
+/*
+ * add_accumulator
+ * ---------------
+ * Add a sample to the accumulator. The higher moments are updated before 
+ * the lower ones because their updates depend on the old values.
+ *
+ * parameters
+ * ----------
+ * Accumulator *accumulator: The accumulator to update.
+ * double sample: The new sample.
+ */
+void add_accumulator(Accumulator *accumulator, double sample)
+{
+    double count = (double) ++accumulator -> count;
+    double delta = sample - (accumulator -> mean - accumulator -> mean_error);
+    double scaled = delta / count;
+    double squared = scaled * scaled;
+    double term = delta * scaled * (count - 1.);
+    double second = accumulator -> second - accumulator -> second_error;
+
+    accumulator -> fourth += term * squared * (count * count - 3. * count + 3.) + 
+        6. * squared * second - 4. * scaled * accumulator -> third;
+    accumulator -> third += term * scaled * (count - 2.) - 3. * scaled * second;
+    compensated_sum(&accumulator -> second, &accumulator -> second_error, term);
+    compensated_sum(&accumulator -> mean, &accumulator -> mean_error, scaled);
+}
+
+
+/*
+ * merge_accumulator
+ * -----------------
+ * Combine the samples of another accumulator into this one. The result 
+ * is the same as if every sample had been added to a single accumulator, 
+ * up to rounding.
+ *
+ * parameters
+ * ----------
+ * Accumulator *accumulator: The accumulator to update.
+ * const Accumulator *other: The accumulator to merge in.
+ */
+void merge_accumulator(Accumulator *accumulator, const Accumulator *other)
+{
+    if (other -> count == 0)
+    {
+        return;
+    }
+
+    if (accumulator -> count == 0)
+    {
+        *accumulator = *other;
+        return;
+    }
+
+    double first = (double) accumulator -> count;
+    double last = (double) other -> count;
+    double count = first + last;
+
+    double mean = accumulator -> mean - accumulator -> mean_error;
+    double other_mean = other -> mean - other -> mean_error;
+    double second = accumulator -> second - accumulator -> second_error;
+    double other_second = other -> second - other -> second_error;
+    double third = accumulator -> third, other_third = other -> third;
+
+    double delta = other_mean - mean;
+    double delta_2 = delta * delta;
+    double product = first * last;
+
+    accumulator -> fourth += other -> fourth + 
+        delta_2 * delta_2 * product * (first * first - product + last * last) / 
+        (count * count * count) + 
+        6. * delta_2 * (first * first * other_second + last * last * second) / 
+        (count * count) + 
+        4. * delta * (first * other_third - last * third) / count;
+    accumulator -> third += other_third + 
+        delta_2 * delta * product * (first - last) / (count * count) + 
+        3. * delta * (first * other_second - last * second) / count;
+    accumulator -> second = second + other_second + delta_2 * product / count;
+    accumulator -> second_error = 0.;
+    accumulator -> mean = mean + delta * last / count;
+    accumulator -> mean_error = 0.;
+    accumulator -> count += other -> count;
+}
+
+
+/*
+ * mean_accumulator
+ * ----------------
+ * The mean of the samples.
+ *
+ * parameters
+ * ----------
+ * const Accumulator *accumulator: The accumulator to read.
+ *
+ * returns
+ * -------
+ * double mean: The mean, or zero if there are no samples.
+ */
+double mean_accumulator(const Accumulator *accumulator)
+{
+    return accumulator -> mean - accumulator -> mean_error;
+}
+
+
+/*
+ * variance_accumulator
+ * --------------------
+ * The unbiased variance of the samples.
+ *
+ * parameters
+ * ----------
+ * const Accumulator *accumulator: The accumulator to read.
+ *
+ * returns
+ * -------
+ * double variance: The variance, or zero with fewer than two samples.
+ */
+double variance_accumulator(const Accumulator *accumulator)
+{
+    if (accumulator -> count < 2)
+    {
+        return 0.;
+    }
+
+    double second = accumulator -> second - accumulator -> second_error;
+    return second / (accumulator -> count - 1);
+}
+
+
+/*
+ * error_accumulator
+ * -----------------
+ * The standard error of the mean assuming independent samples.
+ *
+ * parameters
+ * ----------
+ * const Accumulator *accumulator: The accumulator to read.
+ *
+ * returns
+ * -------
+ * double error: The standard error, or zero with fewer than two samples.
+ */
+double error_accumulator(const Accumulator *accumulator)
+{
+    if (accumulator -> count < 2)
+    {
+        return 0.;
+    }
+
+    return sqrt(variance_accumulator(accumulator) / accumulator -> count);
+}
+
+
+/*
+ * skewness_accumulator
+ * --------------------
+ * The sample skewness, m_3 / m_2^(3/2).
+ *
+ * parameters
+ * ----------
+ * const Accumulator *accumulator: The accumulator to read.
+ *
+ * returns
+ * -------
+ * double skewness: The skewness, or zero if the samples do not vary.
+ */
+double skewness_accumulator(const Accumulator *accumulator)
+{
+    double second = accumulator -> second - accumulator -> second_error;
+
+    if (second <= 0.)
+    {
+        return 0.;
+    }
+
+    return sqrt((double) accumulator -> count) * accumulator -> third / 
+        pow(second, 1.5);
+}
+
+
+/*
+ * kurtosis_accumulator
+ * --------------------
+ * The sample excess kurtosis, m_4 / m_2^2 - 3. This is the quantity 
+ * behind the Binder cumulant of the magnetisation.
+ *
+ * parameters
+ * ----------
+ * const Accumulator *accumulator: The accumulator to read.
+ *
+ * returns
+ * -------
+ * double kurtosis: The excess kurtosis, or zero if the samples do not vary.
+ */
+double kurtosis_accumulator(const Accumulator *accumulator)
+{
+    double second = accumulator -> second - accumulator -> second_error;
+
+    if (second <= 0.)
+    {
+        return 0.;
+    }
+
+    return accumulator -> count * accumulator -> fourth / (second * second) - 3.;
+}
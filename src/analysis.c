@@ -0,0 +1,207 @@
+#include<math.h>
+#include"include/accumulator.h"
+#include"include/analysis.h"
+
+
+/*
+ * init_blocking
+ * -------------
+ * Empty a binning analysis.
+ *
+ * parameters
+ * ----------
+ * Blocking *blocking: The analysis to reset.
+ */
+void init_blocking(Blocking *blocking)
+{
+    blocking -> levels = 0;
+
+    for (int level = 0; level < BLOCKING_LEVELS; level++)
+    {
+        blocking -> waiting[level] = 0;
+        blocking -> pending[level] = 0.;
+        init_accumulator(&blocking -> accumulators[level]);
+    }
+}
+
+
+/*
+ * add_blocking
+ * ------------
+ * Add a sample to the time series. The sample is added to the lowest
+ * level and every completed pair is averaged and carried upwards.
+ *
+ * parameters
+ * ----------
+ * Blocking *blocking: The analysis to update.
+ * double sample: The next sample of the time series.
+ */
+void add_blocking(Blocking *blocking, double sample)
+{
+    for (int level = 0; level < BLOCKING_LEVELS; level++)
+    {
+        add_accumulator(&blocking -> accumulators[level], sample);
+
+        if (level >= blocking -> levels)
+        {
+            blocking -> levels = level + 1;
+        }
+
+        if (!blocking -> waiting[level])
+        {
+            blocking -> pending[level] = sample;
+            blocking -> waiting[level] = 1;
+            return;
+        }
+
+        sample = (blocking -> pending[level] + sample) / 2.;
+        blocking -> waiting[level] = 0;
+    }
+}
+
+
+/*
+ * mean_blocking
+ * -------------
+ * The mean of the time series.
+ *
+ * parameters
+ * ----------
+ * const Blocking *blocking: The analysis to read.
+ *
+ * returns
+ * -------
+ * double mean: The mean of every sample.
+ */
+double mean_blocking(const Blocking *blocking)
+{
+    return mean_accumulator(&blocking -> accumulators[0]);
+}
+
+
+/*
+ * error_blocking
+ * --------------
+ * The standard error of the mean allowing for correlations. The naive
+ * error grows with the block length until the blocks are longer than the
+ * autocorrelation time. The first level whose error is within its own
+ * statistical uncertainty of the next level's is taken as the plateau,
+ * or the last level with enough blocks to be trusted if there is none.
+ *
+ * parameters
+ * ----------
+ * const Blocking *blocking: The analysis to read.
+ *
+ * returns
+ * -------
+ * double error: The standard error of the mean.
+ */
+double error_blocking(const Blocking *blocking)
+{
+    double error = error_accumulator(&blocking -> accumulators[0]);
+
+    for (int level = 0; level + 1 < blocking -> levels; level++)
+    {
+        const Accumulator *blocks = &blocking -> accumulators[level];
+        const Accumulator *next = &blocking -> accumulators[level + 1];
+
+        if (next -> count < BLOCKING_MINIMUM)
+        {
+            break;
+        }
+
+        error = error_accumulator(blocks);
+        double uncertainty = error / sqrt(2. * (blocks -> count - 1));
+        double blocked = error_accumulator(next);
+
+        if (blocked <= error + uncertainty)
+        {
+            return error;
+        }
+
+        error = blocked;
+    }
+
+    return error;
+}
+
+
+/*
+ * autocorrelation_blocking
+ * ------------------------
+ * The integrated autocorrelation time of the time series from the ratio
+ * of the blocked and naive variances of the mean,
+ *
+ *      tau = (error_blocking / error_naive)^2 / 2.
+ *
+ * parameters
+ * ----------
+ * const Blocking *blocking: The analysis to read.
+ *
+ * returns
+ * -------
+ * double tau: The autocorrelation time in samples. Independent samples
+ *      give 1/2, as does a constant series.
+ */
+double autocorrelation_blocking(const Blocking *blocking)
+{
+    double naive = error_accumulator(&blocking -> accumulators[0]);
+
+    if (naive <= 0.)
+    {
+        return .5;
+    }
+
+    double ratio = error_blocking(blocking) / naive;
+    return .5 * ratio * ratio;
+}
+
+
+/*
+ * effective_blocking
+ * ------------------
+ * The number of independent samples the time series is worth.
+ *
+ * parameters
+ * ----------
+ * const Blocking *blocking: The analysis to read.
+ *
+ * returns
+ * -------
+ * double effective: The number of samples divided by 2 tau.
+ */
+double effective_blocking(const Blocking *blocking)
+{
+    double count = (double) blocking -> accumulators[0].count;
+    return count / (2. * autocorrelation_blocking(blocking));
+}
+
+
+/*
+ * stride_blocking
+ * ---------------
+ * Choose the spacing of the next series of measurements so that
+ * successive samples are roughly independent, which is a spacing of
+ * 2 tau. Nearby state points have similar autocorrelation times so the
+ * stride found at one temperature is a good guess for the next.
+ *
+ * parameters
+ * ----------
+ * const Blocking *blocking: The analysis of the last series.
+ * long stride: The spacing the last series was measured with.
+ * long longest: The largest stride allowed, so that enough samples are
+ *      still taken to estimate tau.
+ *
+ * returns
+ * -------
+ * long stride: The spacing for the next series, at least one.
+ */
+long stride_blocking(const Blocking *blocking, long stride, long longest)
+{
+    double spacing = 2. * autocorrelation_blocking(blocking) * stride;
+    long next = lround(spacing);
+
+    if (next > longest) next = longest;
+    if (next < 1) next = 1;
+    return next;
+}
@@ -0,0 +1,820 @@
+#include<omp.h>
+#include<stdio.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<sys/ioctl.h>
+#include<sys/syscall.h>
+#include<linux/perf_event.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/1d_ising.h"
+#include"include/2d_ising.h"
+#include"include/multispin.h"
+#include"include/external_field.h"
+#include"include/nd_ising.h"
+#include"include/bench.h"
+
+// The temperatures the kernels are timed at, close to the critical
+// point of the two dimensional model so that roughly half of the flips
+// are accepted.
+#define BENCH_TEMPERATURE_1D 1.0
+#define BENCH_TEMPERATURE_2D 2.269
+
+
+// Keeps the measurements from being optimised away.
+static volatile float sink_bench;
+
+
+/*
+ * The state and kernel of each benchmark. A step kernel performs one
+ * attempted flip per site for every iteration so that all of the
+ * kernels are compared per site.
+ */
+static void *init_ising_1d_bench(int size)
+{
+    return init_ising_1d(size, BENCH_TEMPERATURE_1D);
+}
+
+
+static void free_ising_1d_bench(void *state)
+{
+    free_ising_1d((Ising1D*) state);
+}
+
+
+static void metropolis_step_ising_1d_bench(void *state, long iterations)
+{
+    Ising1D *system = (Ising1D*) state;
+    long steps = iterations * system -> length;
+
+    for (long step = 0; step < steps; step++)
+    {
+        metropolis_step_ising_1d(system);
+    }
+}
+
+
+static void metropolis_batch_ising_1d_bench(void *state, long iterations)
+{
+    Ising1D *system = (Ising1D*) state;
+    metropolis_batch_ising_1d(system, iterations * system -> length);
+}
+
+
+static void *init_ising_2d_bench(int size)
+{
+    return init_ising_2d(size, BENCH_TEMPERATURE_2D);
+}
+
+
+static void free_ising_2d_bench(void *state)
+{
+    free_ising_2d((Ising2D*) state);
+}
+
+
+static void metropolis_step_ising_2d_bench(void *state, long iterations)
+{
+    Ising2D *system = (Ising2D*) state;
+    long steps = iterations * system -> length * system -> length;
+
+    for (long step = 0; step < steps; step++)
+    {
+        metropolis_step_ising_2d(system);
+    }
+}
+
+
+static void metropolis_batch_ising_2d_bench(void *state, long iterations)
+{
+    Ising2D *system = (Ising2D*) state;
+    metropolis_batch_ising_2d(system, iterations * system -> length * system -> length);
+}
+
+
+static void checkerboard_sweep_ising_2d_bench(void *state, long iterations)
+{
+    for (long iteration = 0; iteration < iterations; iteration++)
+    {
+        checkerboard_sweep_ising_2d((Ising2D*) state);
+    }
+}
+
+
+static void energy_ising_2d_bench(void *state, long iterations)
+{
+    for (long iteration = 0; iteration < iterations; iteration++)
+    {
+        sink_bench = energy_ising_2d((Ising2D*) state);
+    }
+}
+
+
+static void entropy_ising_2d_bench(void *state, long iterations)
+{
+    for (long iteration = 0; iteration < iterations; iteration++)
+    {
+        sink_bench = entropy_ising_2d((Ising2D*) state);
+    }
+}
+
+
+static void *init_multispin_2d_bench(int size)
+{
+    Ising2D *lattice = init_ising_2d(size, BENCH_TEMPERATURE_2D);
+    MultiSpin2D *system = init_multispin_2d(size, BENCH_TEMPERATURE_2D);
+    pack_multispin_2d(system, lattice);
+    free_ising_2d(lattice);
+    return system;
+}
+
+
+static void free_multispin_2d_bench(void *state)
+{
+    free_multispin_2d((MultiSpin2D*) state);
+}
+
+
+static void sweep_multispin_2d_bench(void *state, long iterations)
+{
+    for (long iteration = 0; iteration < iterations; iteration++)
+    {
+        sweep_multispin_2d((MultiSpin2D*) state);
+    }
+}
+
+
+static void *init_ising_t_bench(int size)
+{
+    return init_ising_t(BENCH_TEMPERATURE_2D, 0., 1., size);
+}
+
+
+static void free_ising_t_bench(void *state)
+{
+    free_ising_t((ising_t*) state);
+}
+
+
+static void metropolis_step_ising_t_bench(void *state, long iterations)
+{
+    ising_t *system = (ising_t*) state;
+    long steps = iterations * system -> length * system -> length;
+
+    for (long step = 0; step < steps; step++)
+    {
+        metropolis_step_ising_t(system);
+    }
+}
+
+
+static void metropolis_batch_ising_t_bench(void *state, long iterations)
+{
+    ising_t *system = (ising_t*) state;
+    metropolis_batch_ising_t(system, iterations * system -> length * system -> length);
+}
+
+
+static void swendsen_wang_ising_t_bench(void *state, long iterations)
+{
+    ising_t *system = (ising_t*) state;
+    long number = (long) system -> length * system -> length;
+    evolve_ising_t(system, iterations * number, SWENDSEN_WANG_T);
+}
+
+
+static void magnetisation_ising_t_bench(void *state, long iterations)
+{
+    for (long iteration = 0; iteration < iterations; iteration++)
+    {
+        sink_bench = magnetisation_ising_t((ising_t*) state);
+    }
+}
+
+
+static void *init_ising_nd_bench(int size)
+{
+    Geometry *geometry = init_geometry(RECTANGULAR_SHAPE, size, size, 1);
+    return init_ising_nd(geometry, BENCH_TEMPERATURE_2D, 0.);
+}
+
+
+static void free_ising_nd_bench(void *state)
+{
+    IsingND *system = (IsingND*) state;
+    free_geometry((Geometry*) system -> geometry);
+    free_ising_nd(system);
+}
+
+
+static void metropolis_batch_ising_nd_bench(void *state, long iterations)
+{
+    IsingND *system = (IsingND*) state;
+    metropolis_batch_ising_nd(system, iterations * system -> geometry -> sites);
+}
+
+
+static const Kernel KERNELS[] = {
+    {"metropolis_step_ising_1d", 1, 1, REPLICATED_BENCH,
+        init_ising_1d_bench, metropolis_step_ising_1d_bench, free_ising_1d_bench},
+    {"metropolis_batch_ising_1d", 1, 1, REPLICATED_BENCH,
+        init_ising_1d_bench, metropolis_batch_ising_1d_bench, free_ising_1d_bench},
+    {"metropolis_step_ising_2d", 2, 1, REPLICATED_BENCH,
+        init_ising_2d_bench, metropolis_step_ising_2d_bench, free_ising_2d_bench},
+    {"metropolis_batch_ising_2d", 2, 1, REPLICATED_BENCH,
+        init_ising_2d_bench, metropolis_batch_ising_2d_bench, free_ising_2d_bench},
+    {"metropolis_batch_ising_nd", 2, 1, REPLICATED_BENCH,
+        init_ising_nd_bench, metropolis_batch_ising_nd_bench, free_ising_nd_bench},
+    {"sweep_multispin_2d", 2, 1, REPLICATED_BENCH,
+        init_multispin_2d_bench, sweep_multispin_2d_bench, free_multispin_2d_bench},
+    {"checkerboard_sweep_ising_2d", 2, 1, PARALLEL_BENCH,
+        init_ising_2d_bench, checkerboard_sweep_ising_2d_bench, free_ising_2d_bench},
+    {"metropolis_step_ising_t", 2, 1, REPLICATED_BENCH,
+        init_ising_t_bench, metropolis_step_ising_t_bench, free_ising_t_bench},
+    {"metropolis_batch_ising_t", 2, 1, REPLICATED_BENCH,
+        init_ising_t_bench, metropolis_batch_ising_t_bench, free_ising_t_bench},
+    {"sweep_swendsen_wang", 2, 1, PARALLEL_BENCH,
+        init_ising_t_bench, swendsen_wang_ising_t_bench, free_ising_t_bench},
+    {"energy_ising_2d", 2, 0, SERIAL_BENCH,
+        init_ising_2d_bench, energy_ising_2d_bench, free_ising_2d_bench},
+    {"entropy_ising_2d", 2, 0, SERIAL_BENCH,
+        init_ising_2d_bench, entropy_ising_2d_bench, free_ising_2d_bench},
+    {"magnetisation_ising_t", 2, 0, SERIAL_BENCH,
+        init_ising_t_bench, magnetisation_ising_t_bench, free_ising_t_bench}
+};
+
+
+// The sizes run from a system that fits in the first level cache to
+// one that is several times larger than the last level cache.
+static const int SIZES_1D[] = {1 << 10, 1 << 14, 1 << 18, 1 << 22};
+static const int SIZES_2D[] = {32, 256, 1024, 4096};
+#define NUM_SIZES 4
+
+
+/*
+ * open_counters
+ * -------------
+ * Open the hardware counters of every thread of the team that will run
+ * the benchmark. A counter follows the thread that opened it, so they
+ * are opened from inside a parallel region of the same size.
+ *
+ * parameters
+ * ----------
+ * Counters *counters: The counters to open.
+ * int threads: The number of threads to count.
+ */
+static void open_counters(Counters *counters, int threads)
+{
+    static const uint64_t events[BENCH_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    int failures = 0;
+
+    counters -> threads = threads;
+    counters -> descriptors = (int*) malloc(threads * BENCH_COUNTERS * sizeof(int));
+
+    # pragma omp parallel num_threads(threads) reduction(+: failures)
+    {
+        int thread = omp_get_thread_num();
+
+        for (int event = 0; event < BENCH_COUNTERS; event++)
+        {
+            struct perf_event_attr attributes;
+            memset(&attributes, 0, sizeof(attributes));
+            attributes.size = sizeof(attributes);
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = events[event];
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+
+            int descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+            counters -> descriptors[thread * BENCH_COUNTERS + event] = descriptor;
+            failures += descriptor < 0;
+        }
+    }
+
+    counters -> available = failures == 0;
+}
+
+
+/*
+ * close_counters
+ * --------------
+ * Close the hardware counters.
+ *
+ * parameters
+ * ----------
+ * Counters *counters: The counters to close.
+ */
+static void close_counters(Counters *counters)
+{
+    for (int index = 0; index < counters -> threads * BENCH_COUNTERS; index++)
+    {
+        if (counters -> descriptors[index] >= 0)
+        {
+            close(counters -> descriptors[index]);
+        }
+    }
+
+    free(counters -> descriptors);
+}
+
+
+/*
+ * control_counters
+ * ----------------
+ * Apply a perf ioctl to every counter.
+ *
+ * parameters
+ * ----------
+ * Counters *counters: The counters.
+ * unsigned long request: The ioctl to apply.
+ */
+static void control_counters(Counters *counters, unsigned long request)
+{
+    for (int index = 0; counters -> available &&
+        (index < counters -> threads * BENCH_COUNTERS); index++)
+    {
+        ioctl(counters -> descriptors[index], request, 0);
+    }
+}
+
+
+/*
+ * read_counters
+ * -------------
+ * Total each counter over the threads.
+ *
+ * parameters
+ * ----------
+ * Counters *counters: The counters to read into counters -> values.
+ */
+static void read_counters(Counters *counters)
+{
+    for (int event = 0; event < BENCH_COUNTERS; event++)
+    {
+        counters -> values[event] = 0;
+
+        for (int thread = 0; counters -> available &&
+            (thread < counters -> threads); thread++)
+        {
+            uint64_t value = 0;
+            int descriptor = counters -> descriptors[thread * BENCH_COUNTERS + event];
+
+            if (read(descriptor, &value, sizeof(value)) != sizeof(value))
+            {
+                counters -> available = 0;
+            }
+
+            counters -> values[event] += value;
+        }
+    }
+}
+
+
+/*
+ * time_kernel
+ * -----------
+ * Time a number of iterations of a kernel.
+ *
+ * parameters
+ * ----------
+ * const Kernel *kernel: The kernel to run.
+ * void **states: One state per thread, or a single shared state.
+ * int threads: The number of threads to use.
+ * long iterations: The number of iterations each thread runs.
+ * Counters *counters: The counters to read, or NULL.
+ *
+ * returns
+ * -------
+ * double seconds: The time taken.
+ */
+static double time_kernel(
+    const Kernel *kernel,
+    void **states,
+    int threads,
+    long iterations,
+    Counters *counters)
+{
+    if (counters != NULL)
+    {
+        control_counters(counters, PERF_EVENT_IOC_RESET);
+        control_counters(counters, PERF_EVENT_IOC_ENABLE);
+    }
+
+    double start = omp_get_wtime();
+
+    if (kernel -> scaling == REPLICATED_BENCH)
+    {
+        # pragma omp parallel num_threads(threads)
+        kernel -> run(states[omp_get_thread_num()], iterations);
+    }
+    else
+    {
+        omp_set_num_threads(threads);
+        kernel -> run(states[0], iterations);
+    }
+
+    double seconds = omp_get_wtime() - start;
+
+    if (counters != NULL)
+    {
+        control_counters(counters, PERF_EVENT_IOC_DISABLE);
+        read_counters(counters);
+    }
+
+    return seconds;
+}
+
+
+/*
+ * measure_kernel
+ * --------------
+ * Benchmark a kernel at one size and thread count. The number of
+ * iterations is doubled until a run takes BENCH_MINIMUM_TIME and the
+ * fastest of BENCH_REPEATS runs of that length is kept.
+ *
+ * parameters
+ * ----------
+ * const Kernel *kernel: The kernel to benchmark.
+ * int size: The length of a side of the system.
+ * int threads: The number of threads to use.
+ *
+ * returns
+ * -------
+ * Measurement measurement: The result.
+ */
+static Measurement measure_kernel(const Kernel *kernel, int size, int threads)
+{
+    int replicas = (kernel -> scaling == REPLICATED_BENCH) ? threads : 1;
+    void **states = (void**) malloc(replicas * sizeof(void*));
+    long sites = kernel -> sweeps ? size : 1;
+    sites *= (kernel -> sweeps && (kernel -> dimension == 2)) ? size : 1;
+
+    // Each replica is built by the thread that runs it so its memory
+    // is local to that thread.
+    # pragma omp parallel num_threads(replicas)
+    states[omp_get_thread_num()] = kernel -> init(size);
+
+    long iterations = 1;
+    while (time_kernel(kernel, states, threads, iterations, NULL) < BENCH_MINIMUM_TIME)
+    {
+        iterations *= 2;
+    }
+
+    Counters counters;
+    open_counters(&counters, threads);
+    double seconds = -1;
+    double values[BENCH_COUNTERS] = {0};
+
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+    {
+        double time = time_kernel(kernel, states, threads, iterations, &counters);
+
+        if ((seconds < 0) || (time < seconds))
+        {
+            seconds = time;
+            memcpy(values, counters.values, sizeof(values));
+        }
+    }
+
+    double total = (double) iterations * sites * replicas;
+
+    Measurement measurement;
+    measurement.name = kernel -> name;
+    measurement.size = size;
+    measurement.sites = sites;
+    measurement.threads = threads;
+    measurement.iterations = iterations;
+    measurement.seconds = seconds;
+    measurement.ns_per_site = 1e9 * seconds / total;
+    measurement.flips_per_second = kernel -> sweeps ? total / seconds : 0.;
+    measurement.counted = counters.available && (values[0] > 0);
+    measurement.ipc = measurement.counted ? values[1] / values[0] : 0.;
+    measurement.misses_per_site = measurement.counted ? values[2] / total : 0.;
+
+    close_counters(&counters);
+
+    for (int replica = 0; replica < replicas; replica++)
+    {
+        kernel -> free(states[replica]);
+    }
+
+    free(states);
+    return measurement;
+}
+
+
+/*
+ * write_measurements
+ * ------------------
+ * Save the measurements as json with one measurement per line, so that
+ * they can be read back by compare_measurements.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The file to write.
+ * const Measurement *measurements: The results.
+ * int number: The number of results.
+ */
+static void write_measurements(
+    const char *file_name,
+    const Measurement *measurements,
+    int number)
+{
+    FILE *file = fopen(file_name, "w");
+
+    if (file == NULL)
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    fprintf(file, "{\n    \"max_threads\": %i,\n", omp_get_max_threads());
+    fprintf(file, "    \"results\": [\n");
+
+    for (int index = 0; index < number; index++)
+    {
+        const Measurement *result = &measurements[index];
+        fprintf(file, "        {\"name\": \"%s\", \"size\": %i, \"sites\": %li, ",
+            result -> name, result -> size, result -> sites);
+        fprintf(file, "\"threads\": %i, \"iterations\": %li, \"seconds\": %.6f, ",
+            result -> threads, result -> iterations, result -> seconds);
+        fprintf(file, "\"ns_per_site\": %.6g, ", result -> ns_per_site);
+
+        if (result -> flips_per_second > 0)
+        {
+            fprintf(file, "\"flips_per_second\": %.6g, ", result -> flips_per_second);
+        }
+        else
+        {
+            fprintf(file, "\"flips_per_second\": null, ");
+        }
+
+        if (result -> counted)
+        {
+            fprintf(file, "\"ipc\": %.4f, \"cache_misses_per_site\": %.6g}",
+                result -> ipc, result -> misses_per_site);
+        }
+        else
+        {
+            fprintf(file, "\"ipc\": null, \"cache_misses_per_site\": null}");
+        }
+
+        fprintf(file, (index < number - 1) ? ",\n" : "\n");
+    }
+
+    fprintf(file, "    ]\n}\n");
+    fclose(file);
+}
+
+
+/*
+ * compare_measurements
+ * --------------------
+ * Compare the time per site of each measurement against a baseline
+ * written by an earlier run. Measurements without a counterpart in the
+ * baseline are skipped. A missing baseline is not an error since none is 
+ * shipped, the timings depending on the machine, so a notice saying how 
+ * to store one is printed instead.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The baseline json.
+ * const char *output: The json the results were written to.
+ * const Measurement *measurements: The results.
+ * int number: The number of results.
+ * double tolerance: The fractional slow down that counts as a
+ *      regression.
+ *
+ * returns
+ * -------
+ * int regressions: The number of measurements slower than the baseline
+ *      by more than the tolerance.
+ */
+static int compare_measurements(
+    const char *file_name,
+    const char *output,
+    const Measurement *measurements,
+    int number,
+    double tolerance)
+{
+    FILE *file = fopen(file_name, "r");
+
+    if (file == NULL)
+    {
+        printf("Notice: There is no baseline at '%s' so nothing was compared. "
+            "Copy '%s' there to make these results the baseline.\n", 
+            file_name, output);
+        return 0;
+    }
+
+    char line[512];
+    int regressions = 0;
+    printf("\n%-28s %6s %7s %12s %12s %8s\n", "kernel", "size", "threads",
+        "baseline ns", "current ns", "change");
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char name[64];
+        int size, threads;
+        long sites;
+        char *field = strstr(line, "\"ns_per_site\": ");
+
+        if ((field == NULL) || (sscanf(line,
+            " {\"name\": \"%63[^\"]\", \"size\": %i, \"sites\": %li, \"threads\": %i",
+            name, &size, &sites, &threads) != 4))
+        {
+            continue;
+        }
+
+        double baseline = strtod(field + strlen("\"ns_per_site\": "), NULL);
+
+        for (int index = 0; index < number; index++)
+        {
+            const Measurement *result = &measurements[index];
+
+            if ((strcmp(result -> name, name) == 0) && (result -> size == size) &&
+                (result -> threads == threads))
+            {
+                double change = result -> ns_per_site / baseline - 1;
+                int slower = change > tolerance;
+                regressions += slower;
+                printf("%-28s %6i %7i %12.4g %12.4g %+7.1f%%%s\n", name, size,
+                    threads, baseline, result -> ns_per_site, 100 * change,
+                    slower ? "  REGRESSION" : "");
+            }
+        }
+    }
+
+    fclose(file);
+    return regressions;
+}
+
+
+/*
+ * check_checkerboard_bench
+ * ------------------------
+ * Check that the checkerboard sweep gives the same lattice with many 
+ * threads as with one and that its running totals match a recount. The 
+ * timings of a kernel that races are meaningless, and odd lengths, which 
+ * cannot be coloured across the periodic boundary, are the ones at risk.
+ *
+ * parameters
+ * ----------
+ * int length: The length of the lattice.
+ * int threads: The number of threads to compare against one.
+ *
+ * returns
+ * -------
+ * int failed: Whether the sweeps disagreed.
+ */
+static int check_checkerboard_bench(int length, int threads)
+{
+    Ising2D *systems[2];
+    int counts[2] = {1, threads};
+
+    for (int system = 0; system < 2; system++)
+    {
+        seed_master_random(length);
+        systems[system] = init_ising_2d(length, BENCH_TEMPERATURE_2D);
+        omp_set_num_threads(counts[system]);
+
+        for (int sweep = 0; sweep < 100; sweep++)
+        {
+            checkerboard_sweep_ising_2d(systems[system]);
+        }
+    }
+
+    omp_set_num_threads(threads);
+    int failed = 0;
+
+    for (int system = 0; system < 2; system++)
+    {
+        const Ising2D *sweeper = systems[system];
+        failed |= sweeper -> magnetisation != magnetisation_lattice(sweeper -> ensemble);
+        failed |= sweeper -> aligned != aligned_bonds_lattice(sweeper -> ensemble);
+    }
+
+    // Different lattices can share their totals so every site is compared.
+    for (int row = 0; row < length; row++)
+    {
+        for (int col = 0; col < length; col++)
+        {
+            failed |= spin_lattice(systems[0] -> ensemble, row, col) != 
+                spin_lattice(systems[1] -> ensemble, row, col);
+        }
+    }
+
+    free_ising_2d(systems[0]);
+    free_ising_2d(systems[1]);
+    return failed;
+}
+
+
+/*
+ * main
+ * ----
+ * Benchmark every kernel at every size, and the kernels that can use
+ * more threads at every power of two threads up to the number available.
+ *
+ * usage: bench [output] [baseline] [tolerance]
+ *
+ * The results are written to output, out/bench.json by default. If a
+ * baseline is given the results are compared against it and the program
+ * fails if any kernel is slower by more than the tolerance, 0.1 by
+ * default. The checkerboard sweep is checked against a single thread
+ * before anything is timed.
+ */
+int main(int num_args, char **args)
+{
+    if (num_args > 4)
+    {
+        printf("Error: Please provide at most an output file, a baseline ");
+        printf("and a tolerance.\n");
+        exit(1);
+    }
+
+    const char *output = (num_args >= 2) ? args[1] : "out/bench.json";
+    const char *baseline = (num_args >= 3) ? args[2] : NULL;
+    double tolerance = (num_args == 4) ? atof(args[3]) : 0.1;
+    int max_threads = omp_get_max_threads();
+    int num_kernels = sizeof(KERNELS) / sizeof(Kernel);
+
+    int thread_counts[64];
+    int num_counts = 0;
+    for (int threads = 1; threads < max_threads; threads *= 2)
+    {
+        thread_counts[num_counts++] = threads;
+    }
+    thread_counts[num_counts++] = max_threads;
+
+    int capacity = num_kernels * NUM_SIZES * num_counts;
+    Measurement *measurements = (Measurement*) malloc(capacity * sizeof(Measurement));
+    int number = 0;
+
+    // Both parities are checked, the odd lengths being those of the
+    // shipped configurations.
+    const int check_lengths[] = {5, 15, 16, 64};
+    int check_threads = (max_threads < 4) ? 4 : max_threads;
+    for (int check = 0; check < 4; check++)
+    {
+        if (check_checkerboard_bench(check_lengths[check], check_threads))
+        {
+            printf("Error: The checkerboard sweep of length %i depends on the "
+                "threads!\n", check_lengths[check]);
+            exit(1);
+        }
+    }
+
+    omp_set_num_threads(max_threads);
+    seed_master_random(1);
+    printf("%-28s %6s %7s %12s %14s %8s %10s\n", "kernel", "size", "threads",
+        "ns/site", "flips/s", "ipc", "misses/site");
+
+    for (int index = 0; index < num_kernels; index++)
+    {
+        const Kernel *kernel = &KERNELS[index];
+        const int *sizes = (kernel -> dimension == 1) ? SIZES_1D : SIZES_2D;
+        int counts = (kernel -> scaling == SERIAL_BENCH) ? 1 : num_counts;
+
+        for (int size = 0; size < NUM_SIZES; size++)
+        {
+            for (int count = 0; count < counts; count++)
+            {
+                Measurement result = measure_kernel(kernel, sizes[size],
+                    thread_counts[count]);
+                measurements[number++] = result;
+
+                printf("%-28s %6i %7i %12.4g %14.4g ", result.name, result.size,
+                    result.threads, result.ns_per_site, result.flips_per_second);
+
+                if (result.counted)
+                {
+                    printf("%8.3f %10.4g\n", result.ipc, result.misses_per_site);
+                }
+                else
+                {
+                    printf("%8s %10s\n", "-", "-");
+                }
+
+                fflush(stdout);
+            }
+        }
+    }
+
+    write_measurements(output, measurements, number);
+    int regressions = (baseline != NULL) ?
+        compare_measurements(baseline, output, measurements, number, tolerance) : 0;
+    free(measurements);
+
+    if (regressions > 0)
+    {
+        printf("Error: %i kernels are slower than the baseline\n", regressions);
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/checkpoint.h"
+
+_Static_assert(sizeof(Checkpoint) == 128, "The checkpoint header must be 128 bytes");
+
+
+/*
+ * aligned_offset
+ * --------------
+ * Round an offset up to the alignment of the sections of a checkpoint.
+ *
+ * parameters
+ * ----------
+ * uint64_t offset: The offset in bytes.
+ *
+ * returns
+ * -------
+ * uint64_t aligned: The next multiple of CHECKPOINT_ALIGNMENT.
+ */
+static inline uint64_t aligned_offset(uint64_t offset)
+{
+    return (offset + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT *
+        CHECKPOINT_ALIGNMENT;
+}
+
+
+/*
+ * init_checkpoint
+ * ---------------
+ * Fill in the layout of a checkpoint header. The physical parameters,
+ * step and flip counters and random state are left for the caller.
+ *
+ * parameters
+ * ----------
+ * Checkpoint *header: The header to fill.
+ * int length: The number of spins along one side of the lattice.
+ * int num_streams: The number of row streams to store.
+ */
+void init_checkpoint(Checkpoint *header, int length, int num_streams)
+{
+    memset(header, 0, sizeof(Checkpoint));
+    memcpy(header -> magic, CHECKPOINT_MAGIC, sizeof(header -> magic));
+
+    uint64_t words = (length + 63) / 64;
+    uint64_t spins = (uint64_t) length * words * sizeof(uint64_t);
+
+    header -> version = CHECKPOINT_VERSION;
+    header -> header_size = sizeof(Checkpoint);
+    header -> length = length;
+    header -> words = words;
+    header -> num_streams = num_streams;
+    header -> spins_offset = aligned_offset(sizeof(Checkpoint));
+    header -> streams_offset = aligned_offset(header -> spins_offset + spins);
+    header -> size = header -> streams_offset + num_streams * sizeof(Random);
+}
+
+
+/*
+ * pad_checkpoint
+ * --------------
+ * Write zeros until the file reaches an offset.
+ *
+ * parameters
+ * ----------
+ * FILE *file: The file being written.
+ * uint64_t written: The number of bytes written so far.
+ * uint64_t offset: The offset to pad up to.
+ */
+static void pad_checkpoint(FILE *file, uint64_t written, uint64_t offset)
+{
+    static const char zeros[CHECKPOINT_ALIGNMENT] = {0};
+    fwrite(zeros, 1, offset - written, file);
+}
+
+
+/*
+ * write_checkpoint
+ * ----------------
+ * Pack a lattice into a checkpoint file. The file is written under a
+ * temporary name and then renamed over the old checkpoint so that a run
+ * that is killed part way through a write can still be restarted from
+ * the previous checkpoint.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The file to write.
+ * const Checkpoint *header: The header built by init_checkpoint.
+ * const Lattice *lattice: The spins to store.
+ * const Random *streams: The header -> num_streams row streams.
+ */
+void write_checkpoint(
+    const char *file_name,
+    const Checkpoint *header,
+    const Lattice *lattice,
+    const Random *streams)
+{
+    int length = header -> length;
+    int words = header -> words;
+    size_t name_length = strlen(file_name) + 6;
+    char *part_name = (char*) malloc(name_length);
+    snprintf(part_name, name_length, "%s.part", file_name);
+
+    FILE *file = fopen(part_name, "wb");
+
+    if (file == NULL)
+    {
+        printf("Error: Could not open '%s'", part_name);
+        free(part_name);
+        exit(1);
+    }
+
+    fwrite(header, sizeof(Checkpoint), 1, file);
+    pad_checkpoint(file, sizeof(Checkpoint), header -> spins_offset);
+
+    size_t spins = (size_t) length * words;
+    uint64_t *packed = (uint64_t*) malloc(spins * sizeof(uint64_t));
+    pack_lattice(lattice, packed);
+    fwrite(packed, sizeof(uint64_t), spins, file);
+    free(packed);
+
+    uint64_t written = header -> spins_offset +
+        (uint64_t) length * words * sizeof(uint64_t);
+    pad_checkpoint(file, written, header -> streams_offset);
+    fwrite(streams, sizeof(Random), header -> num_streams, file);
+
+    if (ferror(file) || fclose(file) != 0 || rename(part_name, file_name) != 0)
+    {
+        printf("Error: Could not write the checkpoint '%s'", file_name);
+        free(part_name);
+        exit(1);
+    }
+
+    free(part_name);
+}
+
+
+/*
+ * map_checkpoint
+ * --------------
+ * Map a checkpoint file into memory read only and check that it is a
+ * checkpoint of this version.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The checkpoint to map.
+ *
+ * returns
+ * -------
+ * const Checkpoint *header: The header at the start of the mapping. It
+ *      must be released with unmap_checkpoint.
+ */
+const Checkpoint *map_checkpoint(const char *file_name)
+{
+    int descriptor = open(file_name, O_RDONLY);
+    struct stat status;
+
+    if ((descriptor < 0) || (fstat(descriptor, &status) != 0))
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    if (status.st_size < (off_t) sizeof(Checkpoint))
+    {
+        printf("Error: '%s' is too short to be a checkpoint", file_name);
+        exit(1);
+    }
+
+    void *mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE,
+        descriptor, 0);
+    close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        printf("Error: Could not map '%s'", file_name);
+        exit(1);
+    }
+
+    const Checkpoint *header = (const Checkpoint*) mapping;
+
+    if (memcmp(header -> magic, CHECKPOINT_MAGIC, sizeof(header -> magic)) != 0)
+    {
+        printf("Error: '%s' is not a checkpoint", file_name);
+        exit(1);
+    }
+
+    if ((header -> version != CHECKPOINT_VERSION) ||
+        (header -> header_size != sizeof(Checkpoint)) ||
+        (header -> size != (uint64_t) status.st_size))
+    {
+        printf("Error: '%s' is a different version or is truncated", file_name);
+        exit(1);
+    }
+
+    return header;
+}
+
+
+/*
+ * unmap_checkpoint
+ * ----------------
+ * Release a checkpoint mapped with map_checkpoint.
+ *
+ * parameters
+ * ----------
+ * const Checkpoint *header: The mapped checkpoint.
+ */
+void unmap_checkpoint(const Checkpoint *header)
+{
+    munmap((void*) header, header -> size);
+}
+
+
+/*
+ * read_lattice_checkpoint
+ * -----------------------
+ * Unpack the spins of a mapped checkpoint into a lattice of the same
+ * size.
+ *
+ * parameters
+ * ----------
+ * const Checkpoint *header: The mapped checkpoint.
+ * Lattice *lattice: The lattice to overwrite.
+ */
+void read_lattice_checkpoint(const Checkpoint *header, Lattice *lattice)
+{
+    if ((int) header -> length != lattice -> length)
+    {
+        printf("Error: The checkpoint has length %u not %i", header -> length, 
+            lattice -> length);
+        exit(1);
+    }
+
+    unpack_lattice(lattice, spins_checkpoint(header));
+}
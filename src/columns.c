@@ -0,0 +1,272 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include"include/columns.h"
+
+_Static_assert(sizeof(ColumnsHeader) == 64, "The columns header must be 64 bytes");
+_Static_assert(sizeof(ColumnDescriptor) == 64, "A column descriptor must be 64 bytes");
+
+
+/*
+ * parse_output_format
+ * -------------------
+ * Convert the name of an output format into an OutputFormat.
+ *
+ * parameters
+ * ----------
+ * const char *name: Either "csv" or "columns".
+ *
+ * returns
+ * -------
+ * OutputFormat format: The matching format.
+ */
+OutputFormat parse_output_format(const char *name)
+{
+    if (strcmp(name, "csv") == 0)
+    {
+        return CSV_OUTPUT;
+    }
+    else if (strcmp(name, "columns") == 0)
+    {
+        return COLUMNS_OUTPUT;
+    }
+
+    printf("Error: Unknown output format '%s', use csv or columns", name);
+    exit(1);
+}
+
+
+/*
+ * name_column
+ * -----------
+ * Fill in the name of a column, which must fit in the descriptor.
+ *
+ * parameters
+ * ----------
+ * ColumnDescriptor *descriptor: The descriptor to name.
+ * const char *name: The name of the column.
+ */
+static void name_column(ColumnDescriptor *descriptor, const char *name)
+{
+    if (strlen(name) >= COLUMN_NAME_LENGTH)
+    {
+        printf("Error: The column name '%s' is too long", name);
+        exit(1);
+    }
+
+    memset(descriptor -> name, 0, COLUMN_NAME_LENGTH);
+    strcpy(descriptor -> name, name);
+}
+
+
+/*
+ * add_column
+ * ----------
+ * Make room for another column.
+ *
+ * parameters
+ * ----------
+ * Columns *columns: The table to extend.
+ * const char *name: The name of the new column.
+ * int series: True if the column is a time series.
+ *
+ * returns
+ * -------
+ * int column: The index of the new column.
+ */
+static int add_column(Columns *columns, const char *name, int series)
+{
+    if (columns -> number == columns -> capacity)
+    {
+        columns -> capacity = 2 * columns -> capacity + 1;
+        columns -> descriptors = (ColumnDescriptor*) realloc(columns -> descriptors,
+            columns -> capacity * sizeof(ColumnDescriptor));
+        columns -> values = (double**) realloc(columns -> values,
+            columns -> capacity * sizeof(double*));
+    }
+
+    int column = columns -> number++;
+    ColumnDescriptor *descriptor = &columns -> descriptors[column];
+    name_column(descriptor, name);
+    descriptor -> series = series;
+    descriptor -> reserved = 0;
+    descriptor -> rows = 0;
+    descriptor -> offset = 0;
+    columns -> values[column] = NULL;
+    return column;
+}
+
+
+/*
+ * init_columns
+ * ------------
+ * Start a table with the given columns and no rows.
+ *
+ * parameters
+ * ----------
+ * int number: The number of table columns.
+ * const char **names: The name of each column.
+ *
+ * returns
+ * -------
+ * Columns *columns: The empty table.
+ */
+Columns *init_columns(int number, const char **names)
+{
+    Columns *columns = (Columns*) calloc(1, sizeof(Columns));
+
+    for (int column = 0; column < number; column++)
+    {
+        add_column(columns, names[column], 0);
+    }
+
+    return columns;
+}
+
+
+/*
+ * add_row_columns
+ * ---------------
+ * Append a row to the table columns.
+ *
+ * parameters
+ * ----------
+ * Columns *columns: The table to extend.
+ * const double *values: One value for every table column in order.
+ */
+void add_row_columns(Columns *columns, const double *values)
+{
+    if (columns -> rows == columns -> row_capacity)
+    {
+        columns -> row_capacity = 2 * columns -> row_capacity + 16;
+
+        for (int column = 0; column < columns -> number; column++)
+        {
+            if (!columns -> descriptors[column].series)
+            {
+                columns -> values[column] = (double*) realloc(columns -> values[column],
+                    columns -> row_capacity * sizeof(double));
+            }
+        }
+    }
+
+    int index = 0;
+    for (int column = 0; column < columns -> number; column++)
+    {
+        if (!columns -> descriptors[column].series)
+        {
+            columns -> values[column][columns -> rows] = values[index++];
+            columns -> descriptors[column].rows++;
+        }
+    }
+
+    columns -> rows++;
+}
+
+
+/*
+ * add_series_columns
+ * ------------------
+ * Append a time series as a column of its own length.
+ *
+ * parameters
+ * ----------
+ * Columns *columns: The table to extend.
+ * const char *name: The name of the series.
+ * const double *values: The samples, which are copied.
+ * long rows: The number of samples.
+ */
+void add_series_columns(Columns *columns, const char *name, const double *values, long rows)
+{
+    int column = add_column(columns, name, 1);
+    columns -> values[column] = (double*) malloc((rows > 0 ? rows : 1) * sizeof(double));
+    memcpy(columns -> values[column], values, rows * sizeof(double));
+    columns -> descriptors[column].rows = rows;
+}
+
+
+/*
+ * save_columns
+ * ------------
+ * Write a table to a columnar results file.
+ *
+ * parameters
+ * ----------
+ * const Columns *columns: The table to save.
+ * const char *file_name: The file to write.
+ */
+void save_columns(const Columns *columns, const char *file_name)
+{
+    static const char zeros[COLUMNS_ALIGNMENT] = {0};
+    int number = columns -> number;
+    FILE *file = fopen(file_name, "wb");
+
+    if (file == NULL)
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    ColumnDescriptor *descriptors = (ColumnDescriptor*) malloc(
+        (number > 0 ? number : 1) * sizeof(ColumnDescriptor));
+    uint64_t offset = sizeof(ColumnsHeader) + number * sizeof(ColumnDescriptor);
+
+    for (int column = 0; column < number; column++)
+    {
+        offset = (offset + COLUMNS_ALIGNMENT - 1) / COLUMNS_ALIGNMENT * COLUMNS_ALIGNMENT;
+        descriptors[column] = columns -> descriptors[column];
+        descriptors[column].offset = offset;
+        offset += descriptors[column].rows * sizeof(double);
+    }
+
+    ColumnsHeader header;
+    memset(&header, 0, sizeof(ColumnsHeader));
+    memcpy(header.magic, COLUMNS_MAGIC, sizeof(header.magic));
+    header.version = COLUMNS_VERSION;
+    header.header_size = sizeof(ColumnsHeader);
+    header.columns = number;
+    header.descriptor_size = sizeof(ColumnDescriptor);
+    header.rows = columns -> rows;
+    header.size = offset;
+
+    fwrite(&header, sizeof(ColumnsHeader), 1, file);
+    fwrite(descriptors, sizeof(ColumnDescriptor), number, file);
+
+    uint64_t written = sizeof(ColumnsHeader) + number * sizeof(ColumnDescriptor);
+    for (int column = 0; column < number; column++)
+    {
+        fwrite(zeros, 1, descriptors[column].offset - written, file);
+        fwrite(columns -> values[column], sizeof(double), descriptors[column].rows, file);
+        written = descriptors[column].offset + descriptors[column].rows * sizeof(double);
+    }
+
+    free(descriptors);
+
+    if (ferror(file) || fclose(file) != 0)
+    {
+        printf("Error: Could not write '%s'", file_name);
+        exit(1);
+    }
+}
+
+
+/*
+ * free_columns
+ * ------------
+ * Release the memory occupied by a table.
+ *
+ * parameters
+ * ----------
+ * Columns *columns: The table to free.
+ */
+void free_columns(Columns *columns)
+{
+    for (int column = 0; column < columns -> number; column++)
+    {
+        free(columns -> values[column]);
+    }
+
+    free(columns -> descriptors);
+    free(columns -> values);
+    free(columns);
+}
@@ -0,0 +1,99 @@
+#include<math.h>
+#include<stdio.h>
+#include<string.h>
+#include<stdlib.h>
+#include"include/dynamics.h"
+
+
+/*
+ * parse_rule
+ * ----------
+ * Convert the name of an acceptance rule from a configuration into a 
+ * Rule.
+ *
+ * parameters
+ * ----------
+ * const char *name: Either "metropolis" or "glauber".
+ *
+ * returns
+ * -------
+ * Rule rule: The named rule.
+ */
+Rule parse_rule(const char *name)
+{
+    if (strcmp(name, "metropolis") == 0)
+    {
+        return METROPOLIS;
+    }
+    else if (strcmp(name, "glauber") == 0)
+    {
+        return GLAUBER;
+    }
+
+    printf("Error: Unknown rule '%s'!", name);
+    exit(1);
+}
+
+
+/*
+ * build_transitions
+ * -----------------
+ * Tabulate the flip probabilities for every local configuration. With the 
+ * energy E = -epsilon * sum(s_i s_j) + magnetic_field * sum(s_i) flipping 
+ * a spin s with neighbour sum n changes the energy by 
+ * 2 * s * (epsilon * n - magnetic_field).
+ *
+ * parameters
+ * ----------
+ * Transitions *transitions: The table to fill.
+ * Rule rule: The acceptance rule.
+ * int coordination: The number of neighbours of every spin.
+ * float temperature: The temperature of the system.
+ * float epsilon: The coupling coefficient of the system.
+ * float magnetic_field: The external field of the system.
+ */
+void build_transitions(
+    Transitions *transitions, 
+    Rule rule, 
+    int coordination, 
+    float temperature, 
+    float epsilon, 
+    float magnetic_field)
+{
+    if (coordination > MAX_COORDINATION)
+    {
+        printf("Error: A coordination of %i is not supported!", coordination);
+        exit(1);
+    }
+
+    transitions -> rule = rule;
+    transitions -> coordination = coordination;
+    transitions -> temperature = temperature;
+    transitions -> epsilon = epsilon;
+    transitions -> magnetic_field = magnetic_field;
+
+    for (int up = 0; up < 2; up++)
+    {
+        int spin = up ? 1 : -1;
+
+        for (int neighbours = -coordination; neighbours <= coordination; neighbours++)
+        {
+            double energy_change = 
+                2. * spin * (epsilon * neighbours - magnetic_field);
+            double probability;
+
+            if (rule == GLAUBER)
+            {
+                probability = 1. / (1. + exp(energy_change / temperature));
+            }
+            else
+            {
+                probability = (energy_change <= 0) ? 
+                    1. : exp(- energy_change / temperature);
+            }
+
+            transitions -> probabilities[up][neighbours + coordination] = 
+                probability;
+        }
+    }
+}
@@ -0,0 +1,312 @@
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include"include/toml.h"
+#include"include/telemetry.h"
+#include"include/equilibration.h"
+
+// The marginal standard error rule is applied to the means of batches of
+// this many samples, which smooths the series without hiding a trend.
+#define BATCH_EQUILIBRATION 5
+
+// The fewest samples the series are tested with, twenty batches, and the
+// most samples a burn-in is divided into. A shorter cap is sampled more
+// often than once a sweep so that it can still be tested.
+#define MINIMUM_EQUILIBRATION 100
+#define SAMPLES_EQUILIBRATION 1000
+
+// The number of standard errors the windows of a stationary series may
+// differ by.
+#define GEWEKE_EQUILIBRATION 2.
+
+
+/*
+ * read_burn_in
+ * ------------
+ * Read the burn-in options of a workflow. The optional `burn_in` key is
+ * either "auto", the default, or "fixed" and the optional `burn_in_cap`
+ * key is the longest burn-in in sweeps. Without a cap each workflow is
+ * capped at the fixed burn-in it used to run.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ *
+ * returns
+ * -------
+ * BurnIn burn_in: The burn-in options.
+ */
+BurnIn read_burn_in(Config *config)
+{
+    const char *mode = find_default(config, "burn_in", "auto");
+    BurnIn burn_in = {AUTOMATIC_BURN_IN, 0};
+
+    if (strcmp(mode, "fixed") == 0)
+    {
+        burn_in.mode = FIXED_BURN_IN;
+    }
+    else if (strcmp(mode, "auto") != 0)
+    {
+        printf("Error: Unknown burn-in '%s'!", mode);
+        exit(1);
+    }
+
+    burn_in.cap = atof(find_default(config, "burn_in_cap", "0"));
+
+    if (burn_in.cap < 0)
+    {
+        printf("Error: The burn-in cap cannot be negative!");
+        exit(1);
+    }
+
+    return burn_in;
+}
+
+
+/*
+ * geweke_equilibration
+ * --------------------
+ * Compare the mean of the first tenth of a series of batch means with
+ * the mean of its last half. The batches are treated as independent, so
+ * a series whose correlations outlast a batch looks less stationary than
+ * it is and burns in for longer, which errs on the safe side.
+ *
+ * parameters
+ * ----------
+ * const double *means: The batch means.
+ * long batches: The number of batch means.
+ *
+ * returns
+ * -------
+ * int stationary: Whether the two windows agree within their errors.
+ */
+static int geweke_equilibration(const double *means, long batches)
+{
+    long lengths[2] = {batches / 10, batches / 2};
+    long starts[2] = {0, batches - batches / 2};
+    double centres[2], errors[2];
+
+    for (int window = 0; window < 2; window++)
+    {
+        double sum = 0, square = 0;
+        for (long batch = starts[window]; batch < starts[window] + lengths[window]; batch++)
+        {
+            sum += means[batch];
+            square += means[batch] * means[batch];
+        }
+
+        double centre = sum / lengths[window];
+        double variance = square / lengths[window] - centre * centre;
+        centres[window] = centre;
+        errors[window] = (variance > 0 ? variance : 0) / lengths[window];
+    }
+
+    double difference = fabs(centres[0] - centres[1]);
+    return difference <= GEWEKE_EQUILIBRATION * sqrt(errors[0] + errors[1]);
+}
+
+
+/*
+ * truncate_equilibration
+ * ----------------------
+ * Find where a series becomes stationary. The series is cut into batches
+ * and the MSER-5 rule chooses the truncation that minimises the squared
+ * standard error of the mean of the remaining batches, var / (n - d), out
+ * of those in the first half. An unfinished trend pushes the minimum to
+ * the end of that range. A slow drift can still leave the minimum early,
+ * so the remaining batches must also pass a Geweke comparison of their
+ * first tenth and last half.
+ *
+ * parameters
+ * ----------
+ * const double *series: The samples in the order they were taken.
+ * long count: The number of samples.
+ *
+ * returns
+ * -------
+ * long truncation: The number of samples to discard, or count if the
+ *      series is not yet stationary.
+ */
+long truncate_equilibration(const double *series, long count)
+{
+    long batches = count / BATCH_EQUILIBRATION;
+    long offset = count - batches * BATCH_EQUILIBRATION;
+
+    if (batches < 20)
+    {
+        return count;
+    }
+
+    // The batch means are aligned with the end of the series and their
+    // sums and the sums of their squares are accumulated backwards so
+    // every truncation is O(1).
+    double *means = (double*) malloc(batches * sizeof(double));
+    double *sums = (double*) malloc((batches + 1) * sizeof(double));
+    double *squares = (double*) malloc((batches + 1) * sizeof(double));
+    sums[batches] = squares[batches] = 0;
+
+    for (long batch = batches - 1; batch >= 0; batch--)
+    {
+        double total = 0;
+        for (int sample = 0; sample < BATCH_EQUILIBRATION; sample++)
+        {
+            total += series[offset + batch * BATCH_EQUILIBRATION + sample];
+        }
+
+        means[batch] = total / BATCH_EQUILIBRATION;
+        sums[batch] = sums[batch + 1] + means[batch];
+        squares[batch] = squares[batch + 1] + means[batch] * means[batch];
+    }
+
+    long best = 0;
+    double smallest = -1;
+
+    for (long truncation = 0; truncation <= batches / 2; truncation++)
+    {
+        double remaining = batches - truncation;
+        double mean = sums[truncation] / remaining;
+        double variance = squares[truncation] / remaining - mean * mean;
+        double error = (variance > 0 ? variance : 0) / remaining;
+
+        if ((smallest < 0) || (error < smallest))
+        {
+            smallest = error;
+            best = truncation;
+        }
+    }
+
+    int stationary = (best < batches / 2) && 
+        geweke_equilibration(means + best, batches - best);
+
+    free(means);
+    free(sums);
+    free(squares);
+
+    return stationary ? offset + best * BATCH_EQUILIBRATION : count;
+}
+
+
+/*
+ * init_equilibration
+ * ------------------
+ * Start the burn-in of a system. A fixed burn-in is a single sample after
+ * the whole cap, while an automatic one samples every sweep, or more
+ * often if the cap is short.
+ *
+ * parameters
+ * ----------
+ * Equilibration *equilibration: The burn-in to start.
+ * const BurnIn *burn_in: The burn-in options of the workflow.
+ * long steps: The fixed burn-in of the workflow, used as the cap unless
+ *      the options set one.
+ * long sweep: The number of steps in one sweep of the system.
+ * long minimum: The fewest steps between samples, a whole sweep for the
+ *      engines that can only evolve whole sweeps.
+ *
+ * returns
+ * -------
+ * long spacing: The number of steps to evolve the system for before each
+ *      call to add_equilibration.
+ */
+long init_equilibration(
+    Equilibration *equilibration,
+    const BurnIn *burn_in,
+    long steps,
+    long sweep,
+    long minimum)
+{
+    long cap = (burn_in -> cap > 0) ? (long) (burn_in -> cap * sweep) : steps;
+    cap = (cap > 1) ? cap : 1;
+
+    long spacing = cap / SAMPLES_EQUILIBRATION;
+    spacing = (spacing < sweep) ? spacing : sweep;
+    spacing = (spacing > minimum) ? spacing : minimum;
+    spacing = (spacing > 1) ? spacing : 1;
+
+    if (burn_in -> mode == FIXED_BURN_IN)
+    {
+        spacing = cap;
+    }
+
+    equilibration -> spacing = spacing;
+    equilibration -> sweep = sweep;
+    equilibration -> capacity = (cap + spacing - 1) / spacing;
+    equilibration -> count = 0;
+    equilibration -> check = MINIMUM_EQUILIBRATION;
+    equilibration -> energies = (double*) malloc(
+        equilibration -> capacity * sizeof(double));
+    equilibration -> magnetisations = (double*) malloc(
+        equilibration -> capacity * sizeof(double));
+
+    return spacing;
+}
+
+
+/*
+ * add_equilibration
+ * -----------------
+ * Add a sample of the system and decide whether the burn-in is over. The
+ * burn-in ends when the truncation of both series is in their first
+ * half, so that at least as much of the burn-in is stationary as is not,
+ * or when the cap is reached.
+ *
+ * parameters
+ * ----------
+ * Equilibration *equilibration: The burn-in.
+ * double energy: The energy of the system.
+ * double magnetisation: The absolute magnetisation of the system.
+ *
+ * returns
+ * -------
+ * int done: Whether the system should stop burning in.
+ */
+int add_equilibration(
+    Equilibration *equilibration,
+    double energy,
+    double magnetisation)
+{
+    long count = equilibration -> count;
+    equilibration -> energies[count] = energy;
+    equilibration -> magnetisations[count] = magnetisation;
+    equilibration -> count = ++count;
+
+    if (count >= equilibration -> capacity)
+    {
+        return 1;
+    }
+
+    if (count < equilibration -> check)
+    {
+        return 0;
+    }
+
+    equilibration -> check = count + count / 4;
+    return (truncate_equilibration(equilibration -> energies, count) < count) &&
+        (truncate_equilibration(equilibration -> magnetisations, count) < count);
+}
+
+
+/*
+ * free_equilibration
+ * ------------------
+ * End a burn-in, adding its length to the telemetry of the calling
+ * thread.
+ *
+ * parameters
+ * ----------
+ * Equilibration *equilibration: The burn-in to end.
+ *
+ * returns
+ * -------
+ * long steps: The number of steps the system was burnt in for.
+ */
+long free_equilibration(Equilibration *equilibration)
+{
+    long steps = equilibration -> count * equilibration -> spacing;
+    burn_in_telemetry((double) steps / equilibration -> sweep);
+
+    free(equilibration -> energies);
+    free(equilibration -> magnetisations);
+    return steps;
+}
@@ -2,30 +2,76 @@
 #include<stdio.h>
 #include<string.h>
 #include<stdlib.h>
+#include"include/rng.h"
 #include"include/utils.h"
+#include"include/lattice.h"
+#include"include/dynamics.h"
+#include"include/external_field.h"
+#include"include/swendsen_wang.h"
+#include"include/runner.h"
+#include"include/accumulator.h"
+#include"include/analysis.h"
+#include"include/checkpoint.h"
+#include"include/trajectory.h"
+#include"include/writer.h"
+#include"include/columns.h"
+#include"include/telemetry.h"
+#include"include/kernels.h"
+#include"include/equilibration.h"
+#include"include/reweighting.h"
+
+// The seconds between the progress lines of the long workflows.
+#define PROGRESS_INTERVAL_T 10.
 
 
 /*
- * ising_t
- * -------
- * Represents an arbitrary ising spin lattice in two dimensions. 
+ * recount_ising_t
+ * ---------------
+ * Recalculate the running totals of the system from its spins. This is 
+ * only needed after the spins have been modified directly.
  *
  * parameters
  * ----------
- * float temperature: The temperature of the lattice.
- * float epsilon: The coupling coefficient of the spins.
- * float magnetic_field: The external magentic field the system is in.
- * int length: The length along one side of the system.
- * int **ensemble: A pointer to the array of spins that represents the system. 
+ * ising_t *system: The system to recount.
  */
-typedef struct ising_t 
+void recount_ising_t(ising_t *system)
 {
-    float temperature;
-    float epsilon;
-    float magnetic_field;
-    int length;
-    int **ensemble;
-} ising_t;
+    system -> magnetisation = magnetisation_lattice(system -> ensemble);
+    system -> aligned = aligned_bonds_lattice(system -> ensemble);
+}
+
+
+/*
+ * check_ising_t
+ * -------------
+ * A debugging utility that compares the running totals of the system 
+ * against a full recount. This does nothing unless compiled with 
+ * ISING_DEBUG defined.
+ *
+ * parameters
+ * ----------
+ * const ising_t *system: The system to check.
+ */
+void check_ising_t(const ising_t *system)
+{
+#ifdef ISING_DEBUG
+    int magnetisation = magnetisation_lattice(system -> ensemble);
+    int aligned = aligned_bonds_lattice(system -> ensemble);
+
+    if ((magnetisation != system -> magnetisation) || 
+        (aligned != system -> aligned) ||
+        (system -> temperature != system -> transitions.temperature) ||
+        (system -> magnetic_field != system -> transitions.magnetic_field))
+    {
+        printf("Error: Running totals (%i, %i) do not match (%i, %i)!", 
+            system -> magnetisation, system -> aligned, 
+            magnetisation, aligned);
+        exit(1);
+    }
+#else
+    (void) system;
+#endif
+}
 
 
 /*
@@ -51,26 +97,63 @@ ising_t *init_ising_t(
     float epsilon, 
     int length)
 {
-    int **ensemble = (int**) calloc(length, sizeof(int*));
-
-    for (int row = 0; row < length; row++)
-        ensemble[row] = (int*) calloc(length, sizeof(int));
+    ising_t *system = (ising_t*) calloc(1, sizeof(ising_t));
+    split_random(&system -> random);
 
-    for (int row = 0; row < length; row++)
-        for (int col = 0; col < length; col++)
-            ensemble[row][col] = random_spin();
+    Lattice *ensemble = init_lattice(length);
+    randomise_lattice(ensemble, &system -> random);
 
-    ising_t *system = (ising_t*) malloc(sizeof(ising_t));
     system -> magnetic_field = magnetic_field;
     system -> temperature = temperature;
     system -> ensemble = ensemble;
     system -> epsilon = epsilon;
     system -> length = length;
+    build_transitions(&system -> transitions, METROPOLIS, 4, 
+        temperature, epsilon, magnetic_field);
+    recount_ising_t(system);
 
     return system;
 }
 
 
+/*
+ * set_temperature_ising_t
+ * -----------------------
+ * Change the temperature of the system and rebuild the table of flip 
+ * probabilities.
+ *
+ * parameters
+ * ----------
+ * ising_t *system: The system to modify.
+ * float temperature: The new temperature.
+ */
+void set_temperature_ising_t(ising_t *system, float temperature)
+{
+    system -> temperature = temperature;
+    build_transitions(&system -> transitions, system -> transitions.rule, 4, 
+        temperature, system -> epsilon, system -> magnetic_field);
+}
+
+
+/*
+ * set_magnetic_field_ising_t
+ * --------------------------
+ * Change the external field of the system and rebuild the table of flip 
+ * probabilities.
+ *
+ * parameters
+ * ----------
+ * ising_t *system: The system to modify.
+ * float magnetic_field: The new external field.
+ */
+void set_magnetic_field_ising_t(ising_t *system, float magnetic_field)
+{
+    system -> magnetic_field = magnetic_field;
+    build_transitions(&system -> transitions, system -> transitions.rule, 4, 
+        system -> temperature, system -> epsilon, magnetic_field);
+}
+
+
 /*
  * free_ising_t
  * ------------
@@ -82,12 +165,12 @@ ising_t *init_ising_t(
  */
 void free_ising_t(ising_t *system)
 {
-    int length = system -> length;
-
-    for (int row = 0; row < length; row++)
-        free(system -> ensemble[row]);
+    if (system -> clusters != NULL)
+    {
+        free_swendsen_wang(system -> clusters);
+    }
 
-    free(system -> ensemble);
+    free_lattice(system -> ensemble);
     free(system);
 }
 
@@ -97,7 +180,8 @@ void free_ising_t(ising_t *system)
  * -----------------------
  * Evolve the system according to a randomly weighted spin flip that 
  * compares the probability of the two states based on the Boltzmann 
- * distribution of the two systems. 
+ * distribution of the two systems. The probabilities are read from the 
+ * table of the system. 
  *
  * parameters
  * ----------
@@ -105,31 +189,169 @@ void free_ising_t(ising_t *system)
  */
 void metropolis_step_ising_t(ising_t *system)
 {
-    int length = system -> length;
-    int **ensemble = system -> ensemble;
-    float epsilon = system -> epsilon;
-    float temperature = system -> temperature;
-    float magnetic_field = system -> magnetic_field;
+    metropolis_batch_ising_t(system, 1);
+}
+
+
+/*
+ * metropolis_batch_ising_t
+ * ------------------------
+ * Perform many metropolis steps with the square lattice kernel of the 
+ * kernel library. The kernel is specialised for whether the system is 
+ * in a field, so without one the field never enters the updates.
+ *
+ * parameters
+ * ----------
+ * ising_t *system: The system to evolve.
+ * long steps: The number of attempted flips.
+ */
+void metropolis_batch_ising_t(ising_t *system, long steps)
+{
+    Sites sites = lattice_sites(system -> ensemble);
+    Totals changes = metropolis_kernel(&sites, &system -> transitions, 
+        &system -> random, steps);
+
+    system -> magnetisation += changes.magnetisation;
+    system -> aligned += changes.aligned;
+    system -> accepted += changes.accepted;
+}
+
+
+/*
+ * engine_ising_t
+ * --------------
+ * Parse the name of the algorithm used to evolve the system.
+ *
+ * parameters
+ * ----------
+ * const char *engine: Either `metropolis` or `swendsen_wang`.
+ *
+ * returns
+ * -------
+ * EngineT engine: The selected algorithm.
+ */
+EngineT engine_ising_t(const char *engine)
+{
+    if (strcmp(engine, "metropolis") == 0)
+    {
+        return METROPOLIS_T;
+    }
+    else if (strcmp(engine, "swendsen_wang") == 0)
+    {
+        return SWENDSEN_WANG_T;
+    }
+
+    printf("Error: Unknown engine '%s'!", engine);
+    exit(1);
+}
+
+
+/*
+ * evolve_ising_t
+ * --------------
+ * Evolve the system by a number of attempted spin flips using the chosen 
+ * algorithm. A Swendsen-Wang update visits every spin once so steps / N 
+ * whole updates are performed, and only the steps of those are counted by 
+ * the system and the telemetry. The flips are added to the telemetry 
+ * counters of the calling thread.
+ *
+ * parameters
+ * ----------
+ * ising_t *system: The system to evolve.
+ * long steps: The number of attempted spin flips.
+ * EngineT engine: The algorithm to use.
+ */
+void evolve_ising_t(ising_t *system, long steps, EngineT engine)
+{
+    long number = (long) system -> length * system -> length;
+    long accepted = system -> accepted;
+    long performed = steps;
+
+    if (engine == SWENDSEN_WANG_T)
+    {
+        if (system -> clusters == NULL)
+        {
+            system -> clusters = init_swendsen_wang(system);
+        }
 
-    int row = random_index(length);
-    int col = random_index(length);
+        performed = steps / number * number;
+        for (long sweep = 0; sweep < steps / number; sweep++)
+        {
+            sweep_swendsen_wang(system -> clusters, system);
+        }
+    }
+    else
+    {
+        metropolis_batch_ising_t(system, steps);
+    }
 
-    int spin = ensemble[row][col];
-    int neighbours = 
-        ensemble[modulo(row + 1, length)][col] + 
-        ensemble[modulo(row - 1, length)][col] + 
-        ensemble[row][modulo(col + 1, length)] + 
-        ensemble[row][modulo(col - 1, length)];
+    system -> steps += performed;
+    count_telemetry(performed, system -> accepted - accepted);
+}
 
-    float magnetic_change = -2 * spin * magnetic_field;
-    float interaction_change = 2 * epsilon * neighbours * spin;
-    float energy_change = magnetic_change + interaction_change;
 
-    if ((energy_change < 0) || 
-        (exp(- energy_change / temperature) > normalised_random()))
+/*
+ * measurement_interval_ising_t
+ * ----------------------------
+ * The smallest number of attempted spin flips an engine can perform 
+ * between two measurements.
+ *
+ * parameters
+ * ----------
+ * const ising_t *system: The system that is getting measured.
+ * EngineT engine: The algorithm evolving the system.
+ *
+ * returns
+ * -------
+ * long interval: One step for single spin engines and a whole update 
+ *      of the lattice otherwise.
+ */
+long measurement_interval_ising_t(const ising_t *system, EngineT engine)
+{
+    if (engine == METROPOLIS_T)
     {
-        system -> ensemble[row][col] *= -1;
+        return 1;
     }
+
+    return (long) system -> length * system -> length;
+}
+
+
+/*
+ * burn_in_ising_t
+ * ---------------
+ * Evolve the system towards equilibrium, stopping early once its energy 
+ * and magnetisation are stationary if the burn-in is automatic.
+ *
+ * parameters
+ * ----------
+ * ising_t *system: The system to burn in.
+ * const BurnIn *burn_in: The burn-in options of the workflow.
+ * long steps: The fixed burn-in of the workflow.
+ * EngineT engine: The algorithm to use.
+ *
+ * returns
+ * -------
+ * long steps: The number of steps the system was evolved for.
+ */
+long burn_in_ising_t(
+    ising_t *system, 
+    const BurnIn *burn_in, 
+    long steps, 
+    EngineT engine)
+{
+    Equilibration equilibration;
+    long spacing = init_equilibration(&equilibration, burn_in, steps, 
+        (long) system -> length * system -> length, 
+        measurement_interval_ising_t(system, engine));
+
+    do
+    {
+        evolve_ising_t(system, spacing, engine);
+    } while (!add_equilibration(&equilibration, energy_ising_t(system), 
+        fabs(magnetisation_ising_t(system))));
+
+    return free_equilibration(&equilibration);
 }
 
 
@@ -144,15 +366,8 @@ void metropolis_step_ising_t(ising_t *system)
  */
 float magnetisation_ising_t(ising_t *system)
 {
-    int **ensemble = system -> ensemble;
-    int length = system -> length;
-    float magnetisation = 0.;
-
-    for (int row = 0; row < length; row++)
-        for (int col = 0; col < length; col++)
-            magnetisation += (float) ensemble[row][col];
-
-    return magnetisation;
+    check_ising_t(system);
+    return (float) system -> magnetisation;
 }
 
 
@@ -167,29 +382,10 @@ float magnetisation_ising_t(ising_t *system)
  */
 float energy_ising_t(ising_t *system)
 {
-    int length = system -> length;
-    int **ensemble = system -> ensemble;
-    float epsilon = system -> epsilon;
-    float magnetic_field = system -> magnetic_field;
-    float magnetic = 0.0;
-    float interactions = 0.0;
-
-    for (int row = 0; row < length; row++)
-    {
-        for (int col = 0; col < length; col++)
-        {
-            float neighbours = 0.0;
-            neighbours += ensemble[modulo(row + 1, length)][col];
-            neighbours += ensemble[modulo(row - 1, length)][col];
-            neighbours += ensemble[row][modulo(col + 1, length)];
-            neighbours += ensemble[row][modulo(col - 1, length)];
-
-            magnetic += ensemble[row][col] * magnetic_field;
-            interactions -= neighbours * epsilon * ensemble[row][col];
-        }
-    }
-
-    return interactions / 2. + magnetic;
+    long bonds = 2l * system -> length * system -> length;
+    check_ising_t(system);
+    return energy_kernel(bonds, system -> aligned, system -> magnetisation, 
+        system -> epsilon, system -> magnetic_field);
 }
 
 
@@ -204,28 +400,8 @@ float energy_ising_t(ising_t *system)
  */
 float entropy_ferromagnetic(ising_t *system)
 {
-    int len = system -> length;
-    int **ensemble = system -> ensemble; 
-    int up = 0;
-
-    for (int row = 0; row < len; row++)
-    {
-        for (int col = 0; col < len; col++)
-        {
-            up += ensemble[row][col] == ensemble[modulo(row + 1, len)][col];
-            up += ensemble[row][col] == ensemble[row][modulo(col + 1, len)];
-        }
-    }
-        
-    int total = 2 * len * len;
-    int down = total - up;
-
-    if (up == total || up == 0)
-    {
-        return log(2);
-    }
-
-    return total * log(total) - up * log(up) - down * log(down);
+    long bonds = 2l * system -> length * system -> length;
+    return bond_entropy_kernel(bonds, system -> aligned);
 }
 
 
@@ -246,23 +422,8 @@ float entropy_ferromagnetic(ising_t *system)
  */
 float entropy_paramagnetic(ising_t *system)
 {
-    int len = system -> length;
-    int **ensemble = system -> ensemble; 
-    int up = 0;
-
-    for (int row = 0; row < len; row++)
-        for (int col = 0; col < len; col++)
-            up += ensemble[row][col] > 0;
-        
-    int total = len * len;
-    int down = total - up;
-
-    if (up == total || up == 0)
-    {
-        return 0;
-    }
-
-    return total * log(total) - up * log(up) - down * log(down);
+    long sites = (long) system -> length * system -> length;
+    return spin_entropy_kernel(sites, system -> magnetisation);
 }
 
 
@@ -306,7 +467,7 @@ float entropy_ising_t(ising_t *system)
 void print_ising_t(ising_t *system)
 {
     int length = system -> length;
-    int **ensemble = system -> ensemble;
+    const Lattice *ensemble = system -> ensemble;
 
     printf("Epsilon: %f\n", system -> epsilon);
     printf("Temperature: %f\n", system -> temperature);
@@ -316,7 +477,7 @@ void print_ising_t(ising_t *system)
     {
         for (int col = 0; col < length; col++)
         {
-            printf("%i,", ensemble[row][col] > 0);
+            printf("%i,", spin_lattice(ensemble, row, col) > 0);
         }
         printf("\n");
     }
@@ -339,21 +500,179 @@ void print_ising_t(ising_t *system)
  */
 void save_ising_t(FILE *save_file, ising_t *system)
 {
-    int length = system -> length;
-    int **ensemble = system -> ensemble;
-
     fprintf(save_file, "Epsilon: %f\n", system -> epsilon);
     fprintf(save_file, "Temperature: %f\n", system -> temperature);
     fprintf(save_file, "Magnetic Field: %f\n", system -> magnetic_field);
+    save_lattice(system -> ensemble, save_file, 1);
+}
 
-    for (int row = 0; row < length; row++)
+
+/*
+ * write_frame_ising_t
+ * -------------------
+ * Append the current spin configuration to a trajectory.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The writer thread to hand a copy of the spins to, or 
+ *      NULL to write the frame immediately.
+ * TrajectoryWriter *trajectory: The open trajectory.
+ * const ising_t *system: The system to save.
+ */
+void write_frame_ising_t(
+    Writer *writer, 
+    TrajectoryWriter *trajectory, 
+    const ising_t *system)
+{
+    Frame frame;
+    frame.temperature = system -> temperature;
+    frame.epsilon = system -> epsilon;
+    frame.magnetic_field = system -> magnetic_field;
+    frame.steps = system -> steps;
+
+    if (writer != NULL)
     {
-        for (int col = 0; col < length; col++)
-        {
-            fprintf(save_file, "%i,", ensemble[row][col]);
-        }
-        fprintf(save_file, "\n");
+        frame_writer(writer, trajectory, system -> ensemble, &frame);
+    }
+    else
+    {
+        write_frame_trajectory(trajectory, system -> ensemble, &frame);
+    }
+}
+
+
+/*
+ * save_checkpoint_ising_t
+ * -----------------------
+ * Save the complete state of the system to a binary checkpoint so that 
+ * it can be restored exactly with load_checkpoint_ising_t. The row 
+ * streams of the cluster algorithm are stored if it has been used.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The writer thread to hand a copy of the state to, or 
+ *      NULL to write the checkpoint immediately.
+ * const ising_t *system: The system to save.
+ * const char *file_name: The file to write.
+ */
+void save_checkpoint_ising_t(
+    Writer *writer, 
+    const ising_t *system, 
+    const char *file_name)
+{
+    int num_streams = (system -> clusters != NULL) ? system -> length : 0;
+    const Random *streams = (system -> clusters != NULL) ? 
+        system -> clusters -> streams : NULL;
+
+    Checkpoint header;
+    init_checkpoint(&header, system -> length, num_streams);
+    header.rule = system -> transitions.rule;
+    header.temperature = system -> temperature;
+    header.epsilon = system -> epsilon;
+    header.magnetic_field = system -> magnetic_field;
+    header.steps = system -> steps;
+    header.random = system -> random;
+    header.accepted = system -> accepted;
+
+    if (writer != NULL)
+    {
+        checkpoint_writer(writer, file_name, &header, system -> ensemble, streams);
+    }
+    else
+    {
+        write_checkpoint(file_name, &header, system -> ensemble, streams);
+    }
+}
+
+
+/*
+ * load_checkpoint_ising_t
+ * -----------------------
+ * Restore a system saved with save_checkpoint_ising_t.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The checkpoint to read.
+ *
+ * returns
+ * -------
+ * ising_t *system: The restored system.
+ */
+ising_t *load_checkpoint_ising_t(const char *file_name)
+{
+    const Checkpoint *header = map_checkpoint(file_name);
+    int length = header -> length;
+
+    ising_t *system = (ising_t*) calloc(1, sizeof(ising_t));
+    system -> magnetic_field = header -> magnetic_field;
+    system -> temperature = header -> temperature;
+    system -> epsilon = header -> epsilon;
+    system -> length = length;
+    system -> ensemble = init_lattice(length);
+    read_lattice_checkpoint(header, system -> ensemble);
+    build_transitions(&system -> transitions, (Rule) header -> rule, 4, 
+        system -> temperature, system -> epsilon, system -> magnetic_field);
+
+    if ((int) header -> num_streams == length)
+    {
+        system -> clusters = init_swendsen_wang(system);
+        memcpy(system -> clusters -> streams, streams_checkpoint(header), 
+            length * sizeof(Random));
     }
+
+    system -> random = header -> random;
+    system -> steps = header -> steps;
+    system -> accepted = header -> accepted;
+    unmap_checkpoint(header);
+    recount_ising_t(system);
+
+    return system;
+}
+
+
+/*
+ * SnapshotsT
+ * ----------
+ * The shared state of the tasks of snapshots.
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ * int length: The length along one side of the systems.
+ * int epochs: The number of steps each system is evolved for.
+ * ising_t **systems: The evolved system of each task.
+ */
+typedef struct SnapshotsT
+{
+    EngineT engine;
+    int length;
+    int epochs;
+    ising_t **systems;
+} SnapshotsT;
+
+
+/*
+ * snapshots_task_ising_t
+ * ----------------------
+ * Evolve a single system of the snapshots.
+ *
+ * parameters
+ * ----------
+ * void *context: The SnapshotsT of the workflow.
+ * int task: The index of the system, (_epsilon * 3 + _field) * 3 + 
+ *      _temperature.
+ */
+static void snapshots_task_ising_t(void *context, int task)
+{
+    SnapshotsT *snapshots = (SnapshotsT*) context;
+    float epsilon = (float) (task / 9) - 1.0;
+    float magnetic_field = (float) ((task / 3) % 3);
+    float temperature = (float) (task % 3) + 1.0;
+
+    ising_t *system = init_ising_t(temperature, magnetic_field, epsilon, 
+        snapshots -> length);
+    evolve_ising_t(system, snapshots -> epochs, snapshots -> engine);
+    snapshots -> systems[task] = system;
 }
 
 
@@ -361,37 +680,31 @@ void save_ising_t(FILE *save_file, ising_t *system)
  * snapshots
  * ---------
  * Take snapshots of a configuration of spins at different temperatures 
- * and magnetic field strengths. 
+ * and magnetic field strengths. The systems are evolved in parallel by 
+ * the task runner and saved in order.
  */
-void snapshots(void)
+void snapshots(EngineT engine)
 {
     int length = 100;
     int epochs = length * length * 1e3;
+    int tasks = 3 * 3 * 3;
     FILE *save_file = fopen("pub/data/external_field.txt", "w");
 
-    for (int _epsilon = 0; _epsilon < 3; _epsilon++)
-    {
-        for (int _field = 0; _field < 3; _field++)
-        {
-            for (int _temperature = 0; _temperature < 3; _temperature++)
-            {
-                float epsilon = (float) _epsilon - 1.0;
-                float magnetic_field = (float) _field;
-                float temperature = (float) _temperature + 1.0;
-
-                ising_t *system = init_ising_t(temperature, magnetic_field, epsilon, length);
+    SnapshotsT snapshots;
+    snapshots.engine = engine;
+    snapshots.length = length;
+    snapshots.epochs = epochs;
+    snapshots.systems = (ising_t**) calloc(tasks, sizeof(ising_t*));
 
-                for (int epoch = 0; epoch < epochs; epoch++)
-                {
-                    metropolis_step_ising_t(system);
-                }
+    run_tasks(snapshots_task_ising_t, &snapshots, tasks, NULL);
 
-                save_ising_t(save_file, system);
-                free_ising_t(system);
-            }
-        }
+    for (int task = 0; task < tasks; task++)
+    {
+        save_ising_t(save_file, snapshots.systems[task]);
+        free_ising_t(snapshots.systems[task]);
     }
 
+    free(snapshots.systems);
     fclose(save_file);
 }
 
@@ -399,19 +712,25 @@ void snapshots(void)
 /*
  * antiferromagnetic
  * -----------------
+ * Record the evolution of systems with each coupling as they are cooled 
+ * in several external fields. A frame is stored every sweep in a 
+ * trajectory so that the animation only costs the spins that changed. 
+ * The frames are encoded and written by a background thread so the 
+ * simulation does not wait on the disk.
  *
- *
- *
- *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
  */
-void antiferromagnet(void)
+void antiferromagnet(EngineT engine)
 {
     const int size = 100;
     const int its_per_frame = size * size;
     const int its = 100 * size * size;
-    const char *save_file_name = "pub/data/antiferromagnet.txt";
+    const char *save_file_name = "pub/data/antiferromagnet.traj";
 
-    FILE *save_file = fopen(save_file_name, "w");
+    TrajectoryWriter *trajectory = open_trajectory(save_file_name, size, 100);
+    Writer *writer = init_writer(64);
     
     for (float epsilon = -1.; epsilon < 1.5; epsilon++)
     {
@@ -420,32 +739,149 @@ void antiferromagnet(void)
         {
             do
             {
-                for (int it = 0; it < its; it++)
-                {
-                    metropolis_step_ising_t(system);
-                }
+                evolve_ising_t(system, its, engine);
 
-                for (int it = 0; it < its; it++)
+                for (int it = 0; it < its; it += its_per_frame)
                 {
-                    metropolis_step_ising_t(system);
-                    if(it % its_per_frame == 0)
-                    {
-                        save_ising_t(save_file, system);
-                    }
+                    evolve_ising_t(system, its_per_frame, engine);
+                    write_frame_ising_t(writer, trajectory, system);
                 }
                 
-                system -> temperature -= 1.;
+                set_temperature_ising_t(system, system -> temperature - 1.);
            } while (system -> temperature > .5);
 
-           system -> temperature = 3.;
-           system -> magnetic_field += 1.;
+           set_temperature_ising_t(system, 3.);
+           set_magnetic_field_ising_t(system, system -> magnetic_field + 1.);
 
         } while (system -> magnetic_field < 3.);
+
+        free_ising_t(system);
+    }
+
+    free_writer(writer);
+    close_trajectory(trajectory);
+}
+
+
+/*
+ * HeatCapacityT
+ * -------------
+ * The shared state of the tasks of heat_capacity. Each task cools one 
+ * system and stores its heat capacity at [sys * num_temp + _tau].
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ * int length: The length along one side of the systems.
+ * int num_its: The number of steps at each temperature.
+ * int num_temp: The number of temperatures.
+ * float max_temp: The starting temperature.
+ * float del_temp: The spacing of the temperatures.
+ * double *heat_capacities: The heat capacity of each system at each 
+ *      temperature.
+ * double *autocorrelations: The integrated autocorrelation time of the 
+ *      energy of each system at each temperature in sweeps.
+ * double *effective_samples: The number of independent energy samples of 
+ *      each system at each temperature.
+ * Telemetry *telemetry: Where each system at each temperature is recorded.
+ */
+typedef struct HeatCapacityT
+{
+    EngineT engine;
+    int length;
+    int num_its;
+    int num_temp;
+    float max_temp;
+    float del_temp;
+    double *heat_capacities;
+    double *autocorrelations;
+    double *effective_samples;
+    Telemetry *telemetry;
+} HeatCapacityT;
+
+
+/*
+ * heat_capacity_task_ising_t
+ * --------------------------
+ * Cool a single system through the temperature grid measuring its heat 
+ * capacity. The measurements are spaced by the autocorrelation time of 
+ * the energy at the previous temperature, and at least 4 BLOCKING_MINIMUM 
+ * of them are taken at each temperature.
+ *
+ * parameters
+ * ----------
+ * void *context: The HeatCapacityT of the workflow.
+ * int task: The index of the system.
+ */
+static void heat_capacity_task_ising_t(void *context, int task)
+{
+    HeatCapacityT *heat_capacity = (HeatCapacityT*) context;
+    EngineT engine = heat_capacity -> engine;
+    int num_temp = heat_capacity -> num_temp;
+
+    reset_telemetry();
+    ising_t *system = init_ising_t(heat_capacity -> max_temp, 0., -1., 
+        heat_capacity -> length);
+    long interval = measurement_interval_ising_t(system, engine);
+    long samples = heat_capacity -> num_its / interval > 4 * BLOCKING_MINIMUM ? 
+        heat_capacity -> num_its / interval : 4 * BLOCKING_MINIMUM;
+    long longest = samples / (4 * BLOCKING_MINIMUM);
+    long stride = 1;
+
+    for (int _tau = 0; _tau < num_temp; _tau++)
+    {
+        float tau = heat_capacity -> max_temp - _tau * heat_capacity -> del_temp;
+        long measurements = samples / stride > 2 ? samples / stride : 2;
+        start_telemetry(MEASUREMENT_PHASE);
+        set_temperature_ising_t(system, tau);
+
+        Accumulator energy;
+        Blocking blocking;
+        init_accumulator(&energy);
+        init_blocking(&blocking);
+
+        for (long sample = 0; sample < measurements; sample++)
+        {
+            evolve_ising_t(system, stride * interval, engine);
+            double _energy = energy_ising_t(system);
+            add_accumulator(&energy, _energy);
+            add_blocking(&blocking, _energy);
+        }
+
+        int index = task * num_temp + _tau;
+        heat_capacity -> heat_capacities[index] = 
+            variance_accumulator(&energy) / tau / tau;
+        heat_capacity -> autocorrelations[index] = 
+            autocorrelation_blocking(&blocking) * stride * interval / 
+            ((double) system -> length * system -> length);
+        heat_capacity -> effective_samples[index] = effective_blocking(&blocking);
+        stride = stride_blocking(&blocking, stride, longest);
+
+        char point[128];
+        snprintf(point, sizeof(point), 
+            "\"length\": %i, \"system\": %i, \"temperature\": %.4f", 
+            system -> length, task, tau);
+        record_telemetry(heat_capacity -> telemetry, point);
     }
+
+    free_ising_t(system);
 }
 
 
-void heat_capacity(void)
+/*
+ * heat_capacity
+ * -------------
+ * Measure the heat capacity of several systems around the critical 
+ * temperature. The systems are independent and are shared between the 
+ * threads by the task runner. The time and flips of every system at 
+ * every temperature are written to pub/data/heat_capacity.telemetry.jsonl 
+ * and the progress is printed every PROGRESS_INTERVAL_T seconds.
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ */
+void heat_capacity(EngineT engine)
 {
     const int length = 20;
     const int num_sys = 8;
@@ -456,36 +892,41 @@ void heat_capacity(void)
     const float del_temp = 0.025;
 
     int num_temp = (int) ((max_temp - min_temp) / del_temp);
-    float heat_capacity[num_temp][num_sys];
+    double heat_capacity[num_temp][num_sys];
+    double autocorrelation[num_temp][num_sys];
+    double effective_samples[num_temp][num_sys];
+
+    HeatCapacityT capacities;
+    capacities.engine = engine;
+    capacities.length = length;
+    capacities.num_its = num_its;
+    capacities.num_temp = num_temp;
+    capacities.max_temp = max_temp;
+    capacities.del_temp = del_temp;
+    capacities.heat_capacities = (double*) calloc(num_sys * num_temp, sizeof(double));
+    capacities.autocorrelations = (double*) calloc(num_sys * num_temp, sizeof(double));
+    capacities.effective_samples = (double*) calloc(num_sys * num_temp, sizeof(double));
+    capacities.telemetry = open_telemetry("pub/data/heat_capacity.csv", 
+        "heat_capacity", num_sys * num_temp, PROGRESS_INTERVAL_T);
+
+    run_tasks(heat_capacity_task_ising_t, &capacities, num_sys, NULL);
 
-    # pragma omp parallel for num_threads(8) shared(heat_capacity) 
     for (int sys = 0; sys < num_sys; sys++)
     {
-        ising_t *system = init_ising_t(max_temp, 0., -1., length);
-
         for (int _tau = 0; _tau < num_temp; _tau++)
         {
-            float tau = max_temp - _tau * del_temp;
-            system -> temperature = tau;
-            float energy[num_its];
-            float energy_sq[num_its];
-            printf("Temperature: %f\n", tau);
-
-            for (int it = 0; it < num_its; it++)
-            {
-                metropolis_step_ising_t(system);
-                energy[it] = energy_ising_t(system);
-            }
-
-            float energy_est = mean(energy, num_its);
-            float energy_err = variance(energy, energy_est, num_its);
-
-            heat_capacity[_tau][sys] = energy_err / tau / tau;
+            int index = sys * num_temp + _tau;
+            heat_capacity[_tau][sys] = capacities.heat_capacities[index];
+            autocorrelation[_tau][sys] = capacities.autocorrelations[index];
+            effective_samples[_tau][sys] = capacities.effective_samples[index];
         }
-
-        free_ising_t(system);
     }
 
+    free(capacities.heat_capacities);
+    free(capacities.autocorrelations);
+    free(capacities.effective_samples);
+    start_telemetry(IO_PHASE);
+
     const char *file_name = "pub/data/heat_capacity.csv";
     FILE *file = fopen(file_name, "w");
 
@@ -495,18 +936,459 @@ void heat_capacity(void)
         exit(1);
     }
 
-    fprintf(file, "Temperature, Heat Capacity, Heat Capacity Err\n");
+    fprintf(file, "Temperature, Heat Capacity, Heat Capacity Err, ");
+    fprintf(file, "Autocorrelation Time, Effective Samples\n");
 
     for (int _tau = 0; _tau < num_temp; _tau++)
     {
         float tau = max_temp - _tau * del_temp;
-        float c_v_est = mean(heat_capacity[_tau], num_sys) / num;
-        float c_v_err = sqrt(variance(heat_capacity[_tau], c_v_est, num_sys)) / num;
+        double c_v_mean = mean(heat_capacity[_tau], num_sys);
+        double c_v_est = c_v_mean / num;
+        double c_v_err = sqrt(variance(heat_capacity[_tau], c_v_mean, num_sys)) / num;
+        double tau_int = mean(autocorrelation[_tau], num_sys);
+        double n_eff = mean(effective_samples[_tau], num_sys);
         
-        fprintf(file, "%f, %f, %f\n", tau, c_v_est, c_v_err);
+        fprintf(file, "%f, %f, %f, %f, %f\n", tau, c_v_est, c_v_err, tau_int, n_eff);
     }
     
     fclose(file);
+    close_telemetry(capacities.telemetry);
+}
+
+
+/*
+ * ReweightingT
+ * ------------
+ * The shared state of the tasks of reweighting. Each task first samples 
+ * the histogram of one system and, once the grid is known, reweights it 
+ * to every point of the grid, storing the energy, magnetisation, heat 
+ * capacity, susceptibility and shift at 
+ * [((task * num_temps + _tau) * num_fields + _field) * 5 + quantity].
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ * int length: The length along one side of the systems.
+ * int num_its: The number of steps the histograms are sampled over.
+ * float temperature: The temperature the histograms are sampled at.
+ * float magnetic_field: The field the histograms are sampled in.
+ * BurnIn burn_in: How long each system is evolved before it is sampled.
+ * Histogram *histograms: The histogram of each system.
+ * int num_temps: The number of temperatures of the grid.
+ * int num_fields: The number of fields of the grid.
+ * double temperatures[2]: The lowest and highest temperatures of the grid.
+ * double magnetic_fields[2]: The lowest and highest fields of the grid.
+ * double *results: The reweighted observables of every system.
+ * Telemetry *telemetry: Where the sampling of each system is recorded.
+ */
+typedef struct ReweightingT
+{
+    EngineT engine;
+    int length;
+    int num_its;
+    float temperature;
+    float magnetic_field;
+    BurnIn burn_in;
+    Histogram *histograms;
+    int num_temps;
+    int num_fields;
+    double temperatures[2];
+    double magnetic_fields[2];
+    double *results;
+    Telemetry *telemetry;
+} ReweightingT;
+
+
+/*
+ * histogram_task_ising_t
+ * ----------------------
+ * Burn in a single system and sample its histogram once a sweep.
+ *
+ * parameters
+ * ----------
+ * void *context: The ReweightingT of the workflow.
+ * int task: The index of the system.
+ */
+static void histogram_task_ising_t(void *context, int task)
+{
+    ReweightingT *reweighting = (ReweightingT*) context;
+    EngineT engine = reweighting -> engine;
+    const int length = reweighting -> length;
+    const int num = length * length;
+    Histogram *histogram = &reweighting -> histograms[task];
+
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
+    ising_t *system = init_ising_t(reweighting -> temperature, 
+        reweighting -> magnetic_field, 1., length);
+    burn_in_ising_t(system, &reweighting -> burn_in, 
+        reweighting -> num_its / 10, engine);
+
+    start_telemetry(MEASUREMENT_PHASE);
+    init_histogram(histogram, reweighting -> temperature, 
+        reweighting -> magnetic_field, 1., 2l * num, num);
+
+    for (long sample = 0; sample < reweighting -> num_its / num; sample++)
+    {
+        evolve_ising_t(system, num, engine);
+        add_histogram(histogram, system -> aligned, system -> magnetisation);
+    }
+
+    finish_histogram(histogram);
+
+    char point[128];
+    snprintf(point, sizeof(point), 
+        "\"length\": %i, \"system\": %i, \"temperature\": %.4f, "
+        "\"bins\": %li", length, task, reweighting -> temperature, 
+        histogram -> bins);
+    record_telemetry(reweighting -> telemetry, point);
+    free_ising_t(system);
+}
+
+
+/*
+ * reweighting_task_ising_t
+ * ------------------------
+ * Reweight the histogram of a single system to every point of the grid.
+ *
+ * parameters
+ * ----------
+ * void *context: The ReweightingT of the workflow.
+ * int task: The index of the system.
+ */
+static void reweighting_task_ising_t(void *context, int task)
+{
+    ReweightingT *reweighting = (ReweightingT*) context;
+    const int num_temps = reweighting -> num_temps;
+    const int num_fields = reweighting -> num_fields;
+    const double *temperatures = reweighting -> temperatures;
+    const double *magnetic_fields = reweighting -> magnetic_fields;
+
+    for (int _tau = 0; _tau < num_temps; _tau++)
+    {
+        double tau = temperatures[0] + 
+            (temperatures[1] - temperatures[0]) * _tau / (num_temps - 1);
+
+        for (int _field = 0; _field < num_fields; _field++)
+        {
+            double field = magnetic_fields[0] + (magnetic_fields[1] - 
+                magnetic_fields[0]) * _field / (num_fields - 1);
+            Reweighted reweighted = reweight_histogram(
+                &reweighting -> histograms[task], tau, field);
+
+            double *result = reweighting -> results + 
+                ((task * num_temps + _tau) * num_fields + _field) * 5;
+            result[0] = reweighted.energy;
+            result[1] = reweighted.magnetisation;
+            result[2] = reweighted.heat_capacity;
+            result[3] = reweighted.susceptibility;
+            result[4] = reweighted.shift;
+        }
+    }
+}
+
+
+/*
+ * reweighting
+ * -----------
+ * Measure the energy, magnetisation, heat capacity and susceptibility of 
+ * a ferromagnet on a dense grid of temperatures and fields from single 
+ * runs near the critical temperature. Each system samples the histogram 
+ * of its aligned bonds and magnetisation at one temperature and field 
+ * and the histogram is reweighted to the rest of the grid, which replaces 
+ * a run at every point. The grid spans the range every histogram can be 
+ * reweighted to, which is printed, and a point is marked reliable when no 
+ * system strayed too far from the states it sampled. The errors are the 
+ * standard errors over the systems. The sampling of every system is 
+ * written to pub/data/reweighting.telemetry.jsonl.
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ * OutputFormat format: Whether to write pub/data/reweighting.csv or the 
+ *      columnar pub/data/reweighting.cols.
+ */
+void reweighting(EngineT engine, OutputFormat format)
+{
+    const int length = 20;
+    const int num_sys = 8;
+    const int num = length * length;
+    const int num_temps = 121;
+    const int num_fields = 11;
+    const int num_points = num_temps * num_fields;
+
+    ReweightingT reweighting;
+    reweighting.engine = engine;
+    reweighting.length = length;
+    reweighting.num_its = 20000 * num;
+    reweighting.temperature = 2.3;
+    reweighting.magnetic_field = 0.;
+    reweighting.burn_in.mode = AUTOMATIC_BURN_IN;
+    reweighting.burn_in.cap = 0;
+    reweighting.histograms = (Histogram*) calloc(num_sys, sizeof(Histogram));
+    reweighting.num_temps = num_temps;
+    reweighting.num_fields = num_fields;
+    reweighting.results = (double*) calloc(num_sys * num_points * 5, sizeof(double));
+    reweighting.telemetry = open_telemetry("pub/data/reweighting.csv", 
+        "reweighting", num_sys, PROGRESS_INTERVAL_T);
+
+    run_tasks(histogram_task_ising_t, &reweighting, num_sys, NULL);
+
+    // The grid is the range that every histogram can be reweighted to.
+    for (int sys = 0; sys < num_sys; sys++)
+    {
+        double temperatures[2], magnetic_fields[2];
+        range_histogram(&reweighting.histograms[sys], temperatures, 
+            magnetic_fields);
+
+        if ((sys == 0) || (temperatures[0] > reweighting.temperatures[0]))
+        {
+            reweighting.temperatures[0] = temperatures[0];
+        }
+        if ((sys == 0) || (temperatures[1] < reweighting.temperatures[1]))
+        {
+            reweighting.temperatures[1] = temperatures[1];
+        }
+        if ((sys == 0) || (magnetic_fields[0] > reweighting.magnetic_fields[0]))
+        {
+            reweighting.magnetic_fields[0] = magnetic_fields[0];
+        }
+        if ((sys == 0) || (magnetic_fields[1] < reweighting.magnetic_fields[1]))
+        {
+            reweighting.magnetic_fields[1] = magnetic_fields[1];
+        }
+    }
+
+    printf("Reliable range: temperature %f to %f, magnetic field %f to %f\n", 
+        reweighting.temperatures[0], reweighting.temperatures[1], 
+        reweighting.magnetic_fields[0], reweighting.magnetic_fields[1]);
+
+    run_tasks(reweighting_task_ising_t, &reweighting, num_sys, NULL);
+
+    double *rows = (double*) calloc(num_points * 11, sizeof(double));
+
+    for (int point = 0; point < num_points; point++)
+    {
+        int _tau = point / num_fields;
+        int _field = point % num_fields;
+        double *row = rows + point * 11;
+        row[0] = reweighting.temperatures[0] + (reweighting.temperatures[1] - 
+            reweighting.temperatures[0]) * _tau / (num_temps - 1);
+        row[1] = reweighting.magnetic_fields[0] + (reweighting.magnetic_fields[1] - 
+            reweighting.magnetic_fields[0]) * _field / (num_fields - 1);
+        row[10] = 1.;
+
+        for (int quantity = 0; quantity < 4; quantity++)
+        {
+            double values[num_sys];
+            for (int sys = 0; sys < num_sys; sys++)
+            {
+                double *result = reweighting.results + 
+                    (sys * num_points + point) * 5;
+                values[sys] = result[quantity] / num;
+                row[10] = (result[4] > 1.) ? 0. : row[10];
+            }
+
+            double value = mean(values, num_sys);
+            row[2 + 2 * quantity] = value;
+            row[3 + 2 * quantity] = 
+                sqrt(variance(values, value, num_sys) / num_sys);
+        }
+    }
+
+    for (int sys = 0; sys < num_sys; sys++)
+    {
+        free_histogram(&reweighting.histograms[sys]);
+    }
+
+    free(reweighting.histograms);
+    free(reweighting.results);
+    start_telemetry(IO_PHASE);
+
+    const char *names[] = {"temperature", "magnetic_field", 
+        "energy", "energy_err", "magnetisation", "magnetisation_err", 
+        "heat_capacity", "heat_capacity_err", 
+        "susceptibility", "susceptibility_err", "reliable"};
+
+    if (format == COLUMNS_OUTPUT)
+    {
+        Columns *columns = init_columns(11, names);
+
+        for (int point = 0; point < num_points; point++)
+        {
+            add_row_columns(columns, rows + point * 11);
+        }
+
+        save_columns(columns, "pub/data/reweighting.cols");
+        free_columns(columns);
+        free(rows);
+        close_telemetry(reweighting.telemetry);
+        return;
+    }
+
+    const char *save_file_name = "pub/data/reweighting.csv";
+    FILE *save_file = fopen(save_file_name, "w");
+
+    if (save_file == NULL) 
+    {
+        printf("Error: Could not open '%s', for writing!", save_file_name);
+        exit(1);
+    }
+
+    for (int column = 0; column < 11; column++)
+    {
+        fprintf(save_file, (column < 10) ? "%s, " : "%s\n", names[column]);
+    }
+
+    for (int point = 0; point < num_points; point++)
+    {
+        for (int column = 0; column < 11; column++)
+        {
+            fprintf(save_file, (column < 10) ? "%f, " : "%.0f\n", 
+                rows[point * 11 + column]);
+        }
+    }
+
+    fclose(save_file);
+    free(rows);
+    close_telemetry(reweighting.telemetry);
+}
+
+
+/*
+ * ParametersT
+ * -----------
+ * The shared state of the tasks of physical_parameters. Each task follows 
+ * one coupling and field down the temperature grid and stores the energy, 
+ * entropy, free energy, magnetisation and heat capacity with their errors 
+ * at [((task * num_temps + temp) * 5 + quantity) * 2 + est/err].
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ * int runs: The number of measurement runs at each temperature.
+ * int length: The length along one side of the systems.
+ * int epochs: The number of steps in each run and the longest burn-in.
+ * BurnIn burn_in: How long each system is evolved before it is measured.
+ * int num_temps: The number of temperatures.
+ * int num_fields: The number of magnetic fields.
+ * double *results: The measurements of every task.
+ * Telemetry *telemetry: Where each task at each temperature is recorded.
+ */
+typedef struct ParametersT
+{
+    EngineT engine;
+    int runs;
+    int length;
+    int epochs;
+    BurnIn burn_in;
+    int num_temps;
+    int num_fields;
+    double *results;
+    Telemetry *telemetry;
+} ParametersT;
+
+
+/*
+ * parameters_task_ising_t
+ * -----------------------
+ * Equilibrate a system with one coupling and field and measure it at 
+ * every temperature.
+ *
+ * parameters
+ * ----------
+ * void *context: The ParametersT of the workflow.
+ * int task: The index of the system, _epsilon * num_fields + _field.
+ */
+static void parameters_task_ising_t(void *context, int task)
+{
+    ParametersT *parameters = (ParametersT*) context;
+    EngineT engine = parameters -> engine;
+    const int runs = parameters -> runs;
+    const int length = parameters -> length;
+    const int num = length * length;
+    const int epochs = parameters -> epochs;
+    const int num_temps = parameters -> num_temps;
+    double *results = parameters -> results;
+
+    float epsilon = (float) (task / parameters -> num_fields) - 1.0;
+    float magnetic_field = (float) (task % parameters -> num_fields);
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
+    ising_t *system = init_ising_t(3., magnetic_field, epsilon, length);
+    long interval = measurement_interval_ising_t(system, engine);
+    int samples = epochs / interval;
+
+    // Running the burn-in until the system settles.
+    burn_in_ising_t(system, &parameters -> burn_in, epochs, engine);
+
+    for (int _temperature = 0; _temperature < num_temps; _temperature++)
+    {
+        float temperature = 3.0 - (3.0 / (float) num_temps) * (float)  _temperature;
+        int index = (task * num_temps + _temperature) * 5;
+        start_telemetry(MEASUREMENT_PHASE);
+        set_temperature_ising_t(system, temperature);
+
+        double _energies[runs];
+        double _entropies[runs];
+        double _free_energies[runs];
+        double _magnetisations[runs];
+        double _heat_capacities[runs];
+        
+        for (int run = 0; run < runs; run++)
+        {
+            Accumulator __energies, __entropies, __magnetisations;
+            init_accumulator(&__energies);
+            init_accumulator(&__entropies);
+            init_accumulator(&__magnetisations);
+
+            for (int sample = 0; sample < samples; sample++)
+            {
+                evolve_ising_t(system, interval, engine);
+                add_accumulator(&__energies, energy_ising_t(system));
+                add_accumulator(&__entropies, entropy_ising_t(system));
+                add_accumulator(&__magnetisations, magnetisation_ising_t(system));
+            }
+
+            _energies[run] = mean_accumulator(&__energies);
+            _entropies[run] = mean_accumulator(&__entropies);
+            _magnetisations[run] = mean_accumulator(&__magnetisations);
+            _heat_capacities[run] = 
+                variance_accumulator(&__energies) / temperature / temperature;
+        }
+
+        double energy = mean(_energies, runs);
+        double entropy = mean(_entropies, runs);
+        double free_energy = energy - temperature * entropy;
+        double heat_capacity = mean(_heat_capacities, runs); 
+        double magnetisation = mean(_magnetisations, runs);
+
+        results[(index + 0) * 2 + 0] = energy / num;
+        results[(index + 1) * 2 + 0] = entropy / num;
+        results[(index + 2) * 2 + 0] = free_energy / num;
+        results[(index + 3) * 2 + 0] = magnetisation / num;
+        results[(index + 4) * 2 + 0] = heat_capacity / num;
+
+        double energy_err = sqrt(variance(_energies, energy, runs) / runs);
+        double entropy_err = sqrt(variance(_entropies, entropy, runs) / runs);
+        double free_energy_err = sqrt(energy_err + temperature * entropy_err / runs);
+        double heat_capacity_err = variance(_heat_capacities, heat_capacity, runs); 
+        double magnetisation_err = sqrt(variance(_magnetisations, magnetisation, runs) / runs);
+
+        results[(index + 0) * 2 + 1] = energy_err / num;
+        results[(index + 1) * 2 + 1] = entropy_err / num;
+        results[(index + 2) * 2 + 1] = free_energy_err / num;
+        results[(index + 3) * 2 + 1] = magnetisation_err / num;
+        results[(index + 4) * 2 + 1] = heat_capacity_err / num;
+
+        char point[128];
+        snprintf(point, sizeof(point), "\"length\": %i, \"epsilon\": %.1f, "
+            "\"magnetic_field\": %.1f, \"temperature\": %.4f", 
+            length, epsilon, magnetic_field, temperature);
+        record_telemetry(parameters -> telemetry, point);
+    }
+
+    free_ising_t(system);
 }
 
 
@@ -514,9 +1396,20 @@ void heat_capacity(void)
  * physical_parameters
  * -------------------
  * Measure the physical parameters of the system for various temperatures,
- * coupling coefficients and magnetic_field strengths.
+ * coupling coefficients and magnetic_field strengths. Every coupling and 
+ * field is independent and they are shared between the threads by the 
+ * task runner. Each system is burnt in until it is stationary, for at 
+ * most the length of one run. The time, flips and burn-in of every point 
+ * are written to pub/data/external_field.telemetry.jsonl and the progress 
+ * is printed every PROGRESS_INTERVAL_T seconds.
+ *
+ * parameters
+ * ----------
+ * EngineT engine: The algorithm used to evolve the systems.
+ * OutputFormat format: Whether to write pub/data/external_field.csv or 
+ *      the columnar pub/data/external_field.cols.
  */
-void physical_parameters(void)
+void physical_parameters(EngineT engine, OutputFormat format)
 {
     const int runs = 5;
     const int length = 20;
@@ -525,90 +1418,91 @@ void physical_parameters(void)
     const int num_temps = 10;
     const int num_fields = 3;
     const int num_epsilons = 3;
+    const int tasks = num_fields * num_epsilons;
+
+    double energies[num_temps][num_fields][num_epsilons][2];
+    double entropies[num_temps][num_fields][num_epsilons][2];
+    double free_energies[num_temps][num_fields][num_epsilons][2];
+    double magnetisations[num_temps][num_fields][num_epsilons][2];
+    double heat_capacities[num_temps][num_fields][num_epsilons][2];
+
+    ParametersT parameters;
+    parameters.engine = engine;
+    parameters.runs = runs;
+    parameters.length = length;
+    parameters.epochs = epochs;
+    parameters.burn_in.mode = AUTOMATIC_BURN_IN;
+    parameters.burn_in.cap = 0;
+    parameters.num_temps = num_temps;
+    parameters.num_fields = num_fields;
+    parameters.results = (double*) calloc(tasks * num_temps * 5 * 2, sizeof(double));
+    parameters.telemetry = open_telemetry("pub/data/external_field.csv", 
+        "physical_parameters", tasks * num_temps, PROGRESS_INTERVAL_T);
+
+    run_tasks(parameters_task_ising_t, &parameters, tasks, NULL);
 
-    float energies[num_temps][num_fields][num_epsilons][2];
-    float entropies[num_temps][num_fields][num_epsilons][2];
-    float free_energies[num_temps][num_fields][num_epsilons][2];
-    float magnetisations[num_temps][num_fields][num_epsilons][2];
-    float heat_capacities[num_temps][num_fields][num_epsilons][2];
-
-
-    for (int _epsilon = 0; _epsilon < 3; _epsilon++)
+    for (int _epsilon = 0; _epsilon < num_epsilons; _epsilon++)
     {
-        float epsilon = (float) _epsilon - 1.0;
-        for (int _field = 0; _field < 3; _field++)
+        for (int _field = 0; _field < num_fields; _field++)
         {
-            float magnetic_field = (float) _field;
-            ising_t *system = init_ising_t(3., magnetic_field, epsilon, length);
-    
-            // Running the burn-in
-            for (int epoch = 0; epoch < epochs; epoch++)
+            for (int _temperature = 0; _temperature < num_temps; _temperature++)
             {
-                metropolis_step_ising_t(system);
+                int task = _epsilon * num_fields + _field;
+                double *result = parameters.results + 
+                    (task * num_temps + _temperature) * 5 * 2;
+
+                for (int est = 0; est < 2; est++)
+                {
+                    energies[_temperature][_field][_epsilon][est] = result[0 + est];
+                    entropies[_temperature][_field][_epsilon][est] = result[2 + est];
+                    free_energies[_temperature][_field][_epsilon][est] = result[4 + est];
+                    magnetisations[_temperature][_field][_epsilon][est] = result[6 + est];
+                    heat_capacities[_temperature][_field][_epsilon][est] = result[8 + est];
+                }
             }
+        }
+    }
 
-            for (int _temperature = 0; _temperature < num_temps; _temperature++)
+    free(parameters.results);
+    start_telemetry(IO_PHASE);
+
+    if (format == COLUMNS_OUTPUT)
+    {
+        const char *names[] = {"epsilon", "magnetic_field", "tau", 
+            "energy", "energy_err", "entropy", "entropy_err", 
+            "free_energy", "free_energy_err", 
+            "magnetisation", "magnetisation_err", 
+            "heat_capacity", "heat_capacity_err"};
+        Columns *columns = init_columns(13, names);
+
+        for (int _epsilon = 0; _epsilon < num_epsilons; _epsilon++)
+        {
+            for (int _field = 0; _field < num_fields; _field++)
             {
-                float temperature = 3.0 - (3.0 / (float) num_temps) * (float)  _temperature;
-                system -> temperature = temperature;
-                printf("Temperature: %f\n", temperature);
-
-                float _energies[runs];
-                float _entropies[runs];
-                float _free_energies[runs];
-                float _magnetisations[runs];
-                float _heat_capacities[runs];
-                
-                for (int run = 0; run < runs; run++)
+                for (int _temperature = 0; _temperature < num_temps; _temperature++)
                 {
-                   float __energies[epochs];
-                   float __entropies[epochs];
-                   float __magnetisations[epochs];
-
-                    for (int epoch = 0; epoch < epochs; epoch++)
-                    {
-                        metropolis_step_ising_t(system);
-                        __energies[epoch] = energy_ising_t(system);
-                        __entropies[epoch] = entropy_ising_t(system);
-                        __magnetisations[epoch] = magnetisation_ising_t(system);
-                    }
-
-                    _energies[run] = mean(__energies, epochs);
-                    _entropies[run] = mean(__entropies, epochs);
-                    _magnetisations[run] = mean(__magnetisations, epochs);
-                    _heat_capacities[run] = 
-                        variance(__energies, _energies[run], epochs) / 
-                        temperature / temperature;
+                    double row[] = {_epsilon - 1.0, _field, 
+                        3.0 - (3.0 / num_temps) * _temperature,
+                        energies[_temperature][_field][_epsilon][0],
+                        energies[_temperature][_field][_epsilon][1],
+                        entropies[_temperature][_field][_epsilon][0],
+                        entropies[_temperature][_field][_epsilon][1],
+                        free_energies[_temperature][_field][_epsilon][0],
+                        free_energies[_temperature][_field][_epsilon][1],
+                        magnetisations[_temperature][_field][_epsilon][0],
+                        magnetisations[_temperature][_field][_epsilon][1],
+                        heat_capacities[_temperature][_field][_epsilon][0],
+                        heat_capacities[_temperature][_field][_epsilon][1]};
+                    add_row_columns(columns, row);
                 }
-
-                float energy = mean(_energies, runs);
-                float entropy = mean(_entropies, runs);
-                float free_energy = energy - temperature * entropy;
-                float heat_capacity = mean(_heat_capacities, runs); 
-                float magnetisation = mean(_magnetisations, runs);
-
-                energies[_temperature][_field][_epsilon][0] = energy / num;
-                entropies[_temperature][_field][_epsilon][0] = entropy / num;
-                free_energies[_temperature][_field][_epsilon][0] = free_energy / num;
-                magnetisations[_temperature][_field][_epsilon][0] = magnetisation / num;
-                heat_capacities[_temperature][_field][_epsilon][0] = heat_capacity / num;
-
-                float energy_err = sqrt(variance(_energies, energy, runs) / runs);
-                float entropy_err = sqrt(variance(_entropies, entropy, runs) / runs);
-                float free_energy_err = sqrt(energy_err + temperature * entropy_err / runs);
-                float heat_capacity_err = variance(_heat_capacities, heat_capacity, runs); 
-                float magnetisation_err = sqrt(variance(_magnetisations, magnetisation, runs) / runs);
-
-                energies[_temperature][_field][_epsilon][1] = energy_err / num;
-                entropies[_temperature][_field][_epsilon][1] = entropy_err / num;
-                free_energies[_temperature][_field][_epsilon][1] = free_energy_err / num;
-                magnetisations[_temperature][_field][_epsilon][1] = magnetisation_err / num;
-                heat_capacities[_temperature][_field][_epsilon][1] = heat_capacity_err / num;
             }
-
-            free_ising_t(system);
         }
-    } 
+
+        save_columns(columns, "pub/data/external_field.cols");
+        free_columns(columns);
+        close_telemetry(parameters.telemetry);
+        return;
+    }
 
     char *save_file_name = "pub/data/external_field.csv";
     FILE *save_file = fopen(save_file_name, "w");
@@ -652,41 +1546,6 @@ void physical_parameters(void)
     }
 
     fclose(save_file);
+    close_telemetry(parameters.telemetry);
 }
 
-
-int main(int num_args, char **args)
-{
-    if (num_args != 2)
-    {
-        printf("Error: Please provided the task name. You options are:\n");
-        printf("    - snapshots\n");
-        printf("    - physical_parameters\n");
-        printf("    - antiferromagnet\n");
-        exit(1);
-    }
-
-    if (strcmp(args[1], "snapshots") == 0)
-    {
-        snapshots();
-    }
-    else if (strcmp(args[1], "physical_parameters") == 0)
-    {
-        physical_parameters();
-    }
-    else if (strcmp(args[1], "antiferromagnet") == 0)
-    {
-        antiferromagnet();
-    }
-    else if (strcmp(args[1], "heat_capacity") == 0)
-    {
-        heat_capacity();
-    }
-    else
-    {
-        printf("Error: Invalid mode specified!\n");
-        exit(1);
-    }
-
-    return 0;
-}
@@ -0,0 +1,56 @@
+#include<stdio.h>
+#include<string.h>
+#include<stdlib.h>
+#include"include/rng.h"
+#include"include/columns.h"
+#include"include/external_field.h"
+
+
+int main(int num_args, char **args)
+{
+    if ((num_args < 2) || (num_args > 5))
+    {
+        printf("Error: Please provided the task name and optionally a seed, ");
+        printf("an engine (metropolis or swendsen_wang) and an output format ");
+        printf("(csv or columns). ");
+        printf("You options are:\n");
+        printf("    - snapshots\n");
+        printf("    - physical_parameters\n");
+        printf("    - antiferromagnet\n");
+        printf("    - heat_capacity\n");
+        printf("    - reweighting\n");
+        exit(1);
+    }
+
+    seed_master_random((num_args >= 3) ? strtoull(args[2], NULL, 10) : 1);
+    EngineT engine = engine_ising_t((num_args >= 4) ? args[3] : "metropolis");
+    OutputFormat format = parse_output_format((num_args == 5) ? args[4] : "csv");
+
+    if (strcmp(args[1], "snapshots") == 0)
+    {
+        snapshots(engine);
+    }
+    else if (strcmp(args[1], "physical_parameters") == 0)
+    {
+        physical_parameters(engine, format);
+    }
+    else if (strcmp(args[1], "antiferromagnet") == 0)
+    {
+        antiferromagnet(engine);
+    }
+    else if (strcmp(args[1], "heat_capacity") == 0)
+    {
+        heat_capacity(engine);
+    }
+    else if (strcmp(args[1], "reweighting") == 0)
+    {
+        reweighting(engine, format);
+    }
+    else
+    {
+        printf("Error: Invalid mode specified!\n");
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include<stdio.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+#include"include/utils.h"
+#include"include/geometry.h"
+
+
+// The displacement of every neighbour of a site for each shape, in the
+// order CHAIN_SHAPE, RECTANGULAR_SHAPE, CUBIC_SHAPE, TRIANGULAR_SHAPE.
+// The triangular lattice is a square lattice with one of the diagonals
+// added.
+static const int DIMENSIONS_GEOMETRY[] = {1, 2, 3, 2};
+static const int COORDINATIONS_GEOMETRY[] = {2, 4, 6, 6};
+static const int OFFSETS_GEOMETRY[][6][3] = {
+    {{1, 0, 0}, {-1, 0, 0}},
+    {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}},
+    {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}},
+    {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {1, -1, 0}, {-1, 1, 0}}
+};
+
+
+/*
+ * parse_shape
+ * -----------
+ * Convert the name of a lattice from a configuration into a Shape.
+ *
+ * parameters
+ * ----------
+ * const char *name: One of "chain", "rectangular", "cubic" or
+ *      "triangular".
+ *
+ * returns
+ * -------
+ * Shape shape: The named lattice.
+ */
+Shape parse_shape(const char *name)
+{
+    if (strcmp(name, "chain") == 0)
+    {
+        return CHAIN_SHAPE;
+    }
+    else if (strcmp(name, "rectangular") == 0)
+    {
+        return RECTANGULAR_SHAPE;
+    }
+    else if (strcmp(name, "cubic") == 0)
+    {
+        return CUBIC_SHAPE;
+    }
+    else if (strcmp(name, "triangular") == 0)
+    {
+        return TRIANGULAR_SHAPE;
+    }
+
+    printf("Error: Unknown geometry '%s'!", name);
+    exit(1);
+}
+
+
+/*
+ * name_shape
+ * ----------
+ * The configuration name of a lattice.
+ *
+ * parameters
+ * ----------
+ * Shape shape: The lattice.
+ *
+ * returns
+ * -------
+ * const char *name: The name accepted by parse_shape.
+ */
+const char *name_shape(Shape shape)
+{
+    static const char *names[] = {"chain", "rectangular", "cubic", "triangular"};
+    return names[shape];
+}
+
+
+/*
+ * init_geometry
+ * -------------
+ * Build the neighbour table of a periodic lattice. The lengths of the
+ * axes the shape does not use are ignored.
+ *
+ * parameters
+ * ----------
+ * Shape shape: The kind of lattice.
+ * int length: The number of sites along the first axis.
+ * int width: The number of sites along the second axis.
+ * int height: The number of sites along the third axis.
+ *
+ * returns
+ * -------
+ * Geometry *geometry: The lattice with its neighbour table filled.
+ */
+Geometry *init_geometry(Shape shape, int length, int width, int height)
+{
+    int dimension = DIMENSIONS_GEOMETRY[shape];
+    int coordination = COORDINATIONS_GEOMETRY[shape];
+    int lengths[3] = {length, dimension > 1 ? width : 1, dimension > 2 ? height : 1};
+    long sites = (long) lengths[0] * lengths[1] * lengths[2];
+
+    for (int axis = 0; axis < dimension; axis++)
+    {
+        if (lengths[axis] < 2)
+        {
+            printf("Error: The lattice needs at least two sites along each axis!");
+            exit(1);
+        }
+    }
+
+    if (sites > INT32_MAX / coordination)
+    {
+        printf("Error: A lattice of %li sites is too large!", sites);
+        exit(1);
+    }
+
+    Geometry *geometry = (Geometry*) malloc(sizeof(Geometry));
+    geometry -> shape = shape;
+    geometry -> dimension = dimension;
+    memcpy(geometry -> lengths, lengths, sizeof(lengths));
+    geometry -> sites = (int) sites;
+    geometry -> coordination = coordination;
+    geometry -> bonds = sites * coordination / 2;
+    geometry -> neighbours = (int32_t*) malloc(
+        sites * coordination * sizeof(int32_t));
+
+    for (int z = 0; z < lengths[2]; z++)
+    {
+        for (int y = 0; y < lengths[1]; y++)
+        {
+            for (int x = 0; x < lengths[0]; x++)
+            {
+                long site = x + lengths[0] * ((long) y + lengths[1] * z);
+                int32_t *neighbours = geometry -> neighbours + site * coordination;
+
+                for (int neighbour = 0; neighbour < coordination; neighbour++)
+                {
+                    const int *offset = OFFSETS_GEOMETRY[shape][neighbour];
+                    int nx = modulo(x + offset[0], lengths[0]);
+                    int ny = modulo(y + offset[1], lengths[1]);
+                    int nz = modulo(z + offset[2], lengths[2]);
+                    neighbours[neighbour] = nx + lengths[0] * (ny + lengths[1] * nz);
+                }
+            }
+        }
+    }
+
+    return geometry;
+}
+
+
+/*
+ * free_geometry
+ * -------------
+ * Release a lattice and its neighbour table.
+ *
+ * parameters
+ * ----------
+ * Geometry *geometry: The lattice to free.
+ */
+void free_geometry(Geometry *geometry)
+{
+    free(geometry -> neighbours);
+    free(geometry);
+}
@@ -1,6 +1,11 @@
 #ifndef ISING1D_H
 #define ISING1D_H
+#include<stdint.h>
 #include"toml.h"
+#include"geometry.h"
+#include"dynamics.h"
+#include"rng.h"
+#include"equilibration.h"
 
 
 /*
@@ -12,18 +17,37 @@
  * ----------
  * int length: The number of spins in the system.
  * float temperature: The temperature of the system in natural units.
- * int *system: The orientation of the spins in the system. 
+ * Geometry *geometry: The ring the spins live on.
+ * int8_t *ensemble: The orientation of the spins in the system. 
+ * int magnetisation: The running total of the spins.
+ * int aligned: The running count of bonds joining parallel spins.
+ * Transitions transitions: The tabulated flip probabilities. These must be 
+ *      rebuilt with set_temperature_ising_1d when the temperature changes.
+ * Random random: The stream of random numbers used to evolve the system.
  */
 typedef struct Ising1D 
 {
     int length;
     float temperature;
-    int *ensemble;
+    Geometry *geometry;
+    int8_t *ensemble;
+    int magnetisation;
+    int aligned;
+    Transitions transitions;
+    Random random;
 } Ising1D;
 
 Ising1D* init_ising_1d(int length, float temperature);
+void free_ising_1d(Ising1D *system);
+void recount_ising_1d(Ising1D *system);
+void check_ising_1d(const Ising1D *system);
+void set_temperature_ising_1d(Ising1D *system, float temperature);
+void set_rule_ising_1d(Ising1D *system, Rule rule);
+Rule rule_ising_1d(Config *config);
 int spin_energy_ising_1d(Ising1D *system, int spin);
 void metropolis_step_ising_1d(Ising1D *system);
+void metropolis_batch_ising_1d(Ising1D *system, long steps);
+long burn_in_ising_1d(Ising1D *system, const BurnIn *burn_in, long steps);
 void flip_spin_ising_1d(Ising1D *system, int spin);
 void print_ising_1d(Ising1D *system);
 void first_and_last_ising_1d(Config *config);
@@ -1,6 +1,17 @@
 #ifndef ISING2D_H
 #define ISING2D_H
+#include<stdio.h>
+#include<stdint.h>
 #include"toml.h"
+#include"lattice.h"
+#include"dynamics.h"
+#include"rng.h"
+#include"equilibration.h"
+
+typedef struct Wolff2D Wolff2D;
+typedef struct MultiSpin2D MultiSpin2D;
+typedef struct TrajectoryWriter TrajectoryWriter;
+typedef struct Writer Writer;
 
 
 /*
@@ -12,27 +23,108 @@
  * parameters
  * ----------
  * int length: The number of spins in a single row/col.
- * int **ensemble: The matrix of spins. 
+ * float temperature: The temperature of the system in natural units.
+ * Lattice *ensemble: The halo padded lattice of spins. 
+ * int magnetisation: The running total of the spins.
+ * int aligned: The running count of bonds joining parallel spins.
+ * Transitions transitions: The tabulated flip probabilities. These must be 
+ *      rebuilt with set_temperature_ising_2d when the temperature changes.
+ * Random random: The stream of random numbers used to evolve the system.
+ * int num_streams: The number of rows with their own random stream.
+ * Random *streams: One random stream per row for the parallel sweep so 
+ *      that the result does not depend on the number of threads.
+ * Wolff2D *wolff: The workspace of the cluster algorithm, allocated the 
+ *      first time the system is evolved with it.
+ * MultiSpin2D *multispin: The bit packed copy of the spins used by the 
+ *      multispin engine, allocated the first time it evolves the system.
+ * int packed: Whether the packed copy holds the newest spins. The lattice 
+ *      and random stream are then stale until unpack_ising_2d is called.
+ * long steps: The number of steps the system has been evolved for.
+ * long accepted: The number of spins flipped by those steps.
  */
 typedef struct Ising2D {
-    int     length;
-    float   temperature;
-    int     **ensemble;
+    int         length;
+    float       temperature;
+    Lattice     *ensemble;
+    int         magnetisation;
+    int         aligned;
+    Transitions transitions;
+    Random      random;
+    int         num_streams;
+    Random      *streams;
+    Wolff2D     *wolff;
+    MultiSpin2D *multispin;
+    int         packed;
+    long        steps;
+    long        accepted;
 } Ising2D;
 
+
+/*
+ * Engine2D
+ * --------
+ * The algorithms that can be used to evolve a two-dimensional system. 
+ * This is selected with the optional `engine` key of a configuration.
+ *
+ * values
+ * ------
+ * METROPOLIS_2D: Single spin flips at random sites (`metropolis`).
+ * MULTISPIN_2D: Sublattice sweeps over bit packed spins (`multispin`).
+ * CHECKERBOARD_2D: Sublattice sweeps shared between threads 
+ *      (`checkerboard`).
+ * WOLFF_2D: Single cluster flips for use near the critical point 
+ *      (`wolff`).
+ */
+typedef enum Engine2D {
+    METROPOLIS_2D,
+    MULTISPIN_2D,
+    CHECKERBOARD_2D,
+    WOLFF_2D
+} Engine2D;
+
  
 int magnetisation_ising_2d(const Ising2D *system);
 void metropolis_step_ising_2d(Ising2D *system);
+void metropolis_batch_ising_2d(Ising2D *system, long steps);
+void checkerboard_sweep_ising_2d(Ising2D *system);
 void flip_spin_ising_2d(Ising2D *system, int row, int col);
 void print_ising_2d(Ising2D *system);
 void first_and_last_ising_2d(Config *config);
 void physical_parameters_ising_2d(Config* config);
+void wham_ising_2d(Config *config);
 void magnetisation_vs_temperature_ising_2d(Config *config);
 void heating_and_cooling_ising_2d(Config *config);
 float spin_energy_ising_2d(const Ising2D *system, int row, int col);
 float energy_ising_2d(const Ising2D *system);
+float entropy_ising_2d(Ising2D *system);
 float free_energy_ising_2d(const Ising2D *system);
 float heat_capacity_ising_2d(const Ising2D *system);
 Ising2D *init_ising_2d(int length, float temperature);
+void free_ising_2d(Ising2D *system);
+void set_temperature_ising_2d(Ising2D *system, float temperature);
+void set_rule_ising_2d(Ising2D *system, Rule rule);
+Rule rule_ising_2d(Config *config);
+void recount_ising_2d(Ising2D *system);
+void unpack_ising_2d(Ising2D *system);
+void check_ising_2d(const Ising2D *system);
+Engine2D engine_ising_2d(Config *config);
+void evolve_ising_2d(Ising2D *system, long steps, Engine2D engine);
+long burn_in_ising_2d(
+    Ising2D *system, 
+    const BurnIn *burn_in, 
+    long steps, 
+    Engine2D engine);
+long measurement_interval_ising_2d(const Ising2D *system, Engine2D engine);
+void save_ising_2d(Ising2D *system, FILE *save_file);
+void write_frame_ising_2d(
+    Writer *writer, 
+    TrajectoryWriter *trajectory, 
+    Ising2D *system);
+void save_checkpoint_ising_2d(
+    Writer *writer, 
+    Ising2D *system, 
+    const char *file_name);
+Ising2D *load_checkpoint_ising_2d(const char *file_name);
+void long_run_ising_2d(Config *config);
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+
+/*
+ * Accumulator
+ * -----------
+ * Streaming statistics of a sequence of samples. The mean and the sums 
+ * of the second, third and fourth powers of the deviations from it are 
+ * updated one sample at a time with Welford's method, so the memory used 
+ * does not grow with the number of samples. The mean and the second 
+ * moment carry Kahan compensation terms to limit the rounding error of 
+ * very long runs. Two accumulators can be merged, for example after 
+ * filling one per thread.
+ *
+ * parameters
+ * ----------
+ * long count: The number of samples.
+ * double mean: The mean of the samples.
+ * double mean_error: The rounding error still to be removed from mean.
+ * double second: The sum of the squared deviations from the mean.
+ * double second_error: The rounding error still to be removed from second.
+ * double third: The sum of the cubed deviations from the mean.
+ * double fourth: The sum of the fourth powers of the deviations.
+ */
+typedef struct Accumulator
+{
+    long    count;
+    double  mean;
+    double  mean_error;
+    double  second;
+    double  second_error;
+    double  third;
+    double  fourth;
+} Accumulator;
+
+
+void init_accumulator(Accumulator *accumulator);
+void add_accumulator(Accumulator *accumulator, double sample);
+void merge_accumulator(Accumulator *accumulator, const Accumulator *other);
+double mean_accumulator(const Accumulator *accumulator);
+double variance_accumulator(const Accumulator *accumulator);
+double error_accumulator(const Accumulator *accumulator);
+double skewness_accumulator(const Accumulator *accumulator);
+double kurtosis_accumulator(const Accumulator *accumulator);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+#include"accumulator.h"
+
+#define BLOCKING_LEVELS 32
+#define BLOCKING_MINIMUM 32
+
+
+/*
+ * Blocking
+ * --------
+ * Streaming binning analysis of a correlated time series. Level zero
+ * sees every sample and each further level sees the averages of
+ * consecutive pairs from the level below, so level k holds blocks of
+ * 2^k samples. Once the blocks are longer than the autocorrelation time
+ * they are independent and the naive standard error of the block means
+ * stops growing, which gives both an honest error bar and the integrated
+ * autocorrelation time in constant memory.
+ *
+ * parameters
+ * ----------
+ * int levels: The number of levels that have seen at least one block.
+ * int waiting[BLOCKING_LEVELS]: True if a level is holding the first
+ *      half of a pair.
+ * double pending[BLOCKING_LEVELS]: The first half of the pair.
+ * Accumulator accumulators[BLOCKING_LEVELS]: The statistics of the
+ *      blocks at each level.
+ */
+typedef struct Blocking
+{
+    int         levels;
+    int         waiting[BLOCKING_LEVELS];
+    double      pending[BLOCKING_LEVELS];
+    Accumulator accumulators[BLOCKING_LEVELS];
+} Blocking;
+
+
+void init_blocking(Blocking *blocking);
+void add_blocking(Blocking *blocking, double sample);
+double mean_blocking(const Blocking *blocking);
+double error_blocking(const Blocking *blocking);
+double autocorrelation_blocking(const Blocking *blocking);
+double effective_blocking(const Blocking *blocking);
+long stride_blocking(const Blocking *blocking, long stride, long longest);
+
+#endif
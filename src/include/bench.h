@@ -0,0 +1,119 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// The shortest time a measurement is timed for, the number of timed
+// repeats of which the fastest is kept and the hardware counters read.
+#define BENCH_MINIMUM_TIME 0.1
+#define BENCH_REPEATS 3
+#define BENCH_COUNTERS 3
+
+
+/*
+ * Scaling
+ * -------
+ * How a benchmark makes use of more than one thread.
+ *
+ * values
+ * ------
+ * SERIAL_BENCH: Only timed on a single thread.
+ * REPLICATED_BENCH: Every thread evolves its own copy of the system, so
+ *      the throughput shows how the kernel shares the caches and memory.
+ * PARALLEL_BENCH: The kernel shares a single system between the threads.
+ */
+typedef enum Scaling {
+    SERIAL_BENCH,
+    REPLICATED_BENCH,
+    PARALLEL_BENCH
+} Scaling;
+
+
+/*
+ * Kernel
+ * ------
+ * A function to be benchmarked along with the way to set it up.
+ *
+ * parameters
+ * ----------
+ * const char *name: The name reported in the results.
+ * int dimension: The number of dimensions of the system, so that a
+ *      system of a given size has size^dimension sites.
+ * int sweeps: True if an iteration updates every site of the system
+ *      and false if it is a single call of a measurement.
+ * Scaling scaling: How the kernel makes use of more threads.
+ * void *(*init)(int size): Build the state the kernel runs on.
+ * void (*run)(void *state, long iterations): Run the kernel.
+ * void (*free)(void *state): Release the state.
+ */
+typedef struct Kernel
+{
+    const char  *name;
+    int         dimension;
+    int         sweeps;
+    Scaling     scaling;
+    void        *(*init)(int size);
+    void        (*run)(void *state, long iterations);
+    void        (*free)(void *state);
+} Kernel;
+
+
+/*
+ * Counters
+ * --------
+ * The hardware counters of the threads taking part in a benchmark, read
+ * through perf_event_open. The counters are not available on every
+ * machine, in which case only the timings are reported.
+ *
+ * parameters
+ * ----------
+ * int threads: The number of threads that are counted.
+ * int available: True if every counter could be opened.
+ * int *descriptors: The BENCH_COUNTERS cycle, instruction and cache
+ *      miss counters of each thread.
+ * double values[BENCH_COUNTERS]: The totals over the threads of the
+ *      last measurement.
+ */
+typedef struct Counters
+{
+    int     threads;
+    int     available;
+    int     *descriptors;
+    double  values[BENCH_COUNTERS];
+} Counters;
+
+
+/*
+ * Measurement
+ * -----------
+ * The result of benchmarking one kernel at one size and thread count.
+ *
+ * parameters
+ * ----------
+ * const char *name: The name of the kernel.
+ * int size: The length of a side of the system.
+ * long sites: The number of sites covered by a single iteration.
+ * int threads: The number of threads used.
+ * long iterations: The number of iterations timed.
+ * double seconds: The fastest time of the repeats.
+ * double ns_per_site: The time per site, over all of the threads.
+ * double flips_per_second: The number of attempted spin flips per
+ *      second over all of the threads, zero for a measurement.
+ * int counted: True if the hardware counters were read.
+ * double ipc: The instructions per cycle.
+ * double misses_per_site: The cache misses per site.
+ */
+typedef struct Measurement
+{
+    const char  *name;
+    int         size;
+    long        sites;
+    int         threads;
+    long        iterations;
+    double      seconds;
+    double      ns_per_site;
+    double      flips_per_second;
+    int         counted;
+    double      ipc;
+    double      misses_per_site;
+} Measurement;
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+#include<stdint.h>
+#include"rng.h"
+#include"lattice.h"
+
+#define CHECKPOINT_MAGIC "ISINGCKP"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_ALIGNMENT 64
+
+
+/*
+ * Checkpoint
+ * ----------
+ * The header of a binary checkpoint of a square lattice. The file is the
+ * header followed by the spins, one bit per spin with a set bit for an
+ * up spin, and then the random streams of the rows if the system has
+ * any. Each row of spins is padded to a whole number of 64-bit words and
+ * bit (col % 64) of word (row * words + col / 64) holds the spin at
+ * (row, col). Every section starts on a 64-byte boundary so the file can
+ * be mapped into memory and used in place without any parsing. The
+ * fields are written in the byte order of the machine.
+ *
+ * parameters
+ * ----------
+ * char magic[8]: Always CHECKPOINT_MAGIC, without the terminating null.
+ * uint32_t version: The version of the layout, CHECKPOINT_VERSION.
+ * uint32_t header_size: The size of this header in bytes.
+ * uint32_t length: The number of spins along one side of the lattice.
+ * uint32_t words: The number of 64-bit words in each row of spins.
+ * uint32_t rule: The acceptance rule of the system.
+ * uint32_t num_streams: The number of row streams after the spins.
+ * float temperature: The temperature of the system.
+ * float epsilon: The coupling coefficient of the system.
+ * float magnetic_field: The external field of the system.
+ * uint32_t reserved: Zero.
+ * uint64_t steps: The number of steps the system has been evolved for.
+ * uint64_t spins_offset: The offset of the spins from the start of the
+ *      file in bytes.
+ * uint64_t streams_offset: The offset of the row streams in bytes.
+ * uint64_t size: The size of the whole file in bytes.
+ * Random random: The state of the random stream of the system.
+ * uint64_t accepted: The number of spins flipped by those steps.
+ * uint64_t padding: Zero, to keep the header 128 bytes long.
+ */
+typedef struct Checkpoint
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    header_size;
+    uint32_t    length;
+    uint32_t    words;
+    uint32_t    rule;
+    uint32_t    num_streams;
+    float       temperature;
+    float       epsilon;
+    float       magnetic_field;
+    uint32_t    reserved;
+    uint64_t    steps;
+    uint64_t    spins_offset;
+    uint64_t    streams_offset;
+    uint64_t    size;
+    Random      random;
+    uint64_t    accepted;
+    uint64_t    padding;
+} Checkpoint;
+
+
+void init_checkpoint(Checkpoint *header, int length, int num_streams);
+void write_checkpoint(
+    const char *file_name,
+    const Checkpoint *header,
+    const Lattice *lattice,
+    const Random *streams);
+const Checkpoint *map_checkpoint(const char *file_name);
+void unmap_checkpoint(const Checkpoint *header);
+void read_lattice_checkpoint(const Checkpoint *header, Lattice *lattice);
+
+
+/*
+ * spins_checkpoint
+ * ----------------
+ * Find the packed spins of a mapped checkpoint.
+ *
+ * parameters
+ * ----------
+ * const Checkpoint *header: The mapped checkpoint.
+ *
+ * returns
+ * -------
+ * const uint64_t *spins: The first word of the first row.
+ */
+static inline const uint64_t *spins_checkpoint(const Checkpoint *header)
+{
+    return (const uint64_t*) ((const char*) header + header -> spins_offset);
+}
+
+
+/*
+ * streams_checkpoint
+ * ------------------
+ * Find the row streams of a mapped checkpoint.
+ *
+ * parameters
+ * ----------
+ * const Checkpoint *header: The mapped checkpoint.
+ *
+ * returns
+ * -------
+ * const Random *streams: The stream of the first row.
+ */
+static inline const Random *streams_checkpoint(const Checkpoint *header)
+{
+    return (const Random*) ((const char*) header + header -> streams_offset);
+}
+
+#endif
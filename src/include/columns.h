@@ -0,0 +1,118 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+#include<stdint.h>
+
+#define COLUMNS_MAGIC "ISINGCOL"
+#define COLUMNS_VERSION 1
+#define COLUMNS_ALIGNMENT 64
+#define COLUMN_NAME_LENGTH 40
+
+
+/*
+ * OutputFormat
+ * ------------
+ * The formats the results of a workflow can be written in. This is
+ * selected with the optional `output_format` key of a configuration.
+ *
+ * values
+ * ------
+ * CSV_OUTPUT: Comma separated text (`csv`).
+ * COLUMNS_OUTPUT: A binary file of double precision columns (`columns`).
+ */
+typedef enum OutputFormat {
+    CSV_OUTPUT,
+    COLUMNS_OUTPUT
+} OutputFormat;
+
+
+/*
+ * ColumnsHeader
+ * -------------
+ * The header of a columnar results file. It is followed by one
+ * ColumnDescriptor per column and then the values of each column stored
+ * contiguously as doubles, every column starting on a 64-byte boundary,
+ * so a column can be mapped straight into a numpy array. The fields are
+ * written in the byte order of the machine.
+ *
+ * parameters
+ * ----------
+ * char magic[8]: Always COLUMNS_MAGIC, without the terminating null.
+ * uint32_t version: The version of the layout, COLUMNS_VERSION.
+ * uint32_t header_size: The size of this header in bytes.
+ * uint32_t columns: The number of columns.
+ * uint32_t descriptor_size: The size of a ColumnDescriptor in bytes.
+ * uint64_t rows: The number of rows of the table columns.
+ * uint64_t size: The size of the whole file in bytes.
+ * uint64_t padding[3]: Zero, to keep the header 64 bytes long.
+ */
+typedef struct ColumnsHeader
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    header_size;
+    uint32_t    columns;
+    uint32_t    descriptor_size;
+    uint64_t    rows;
+    uint64_t    size;
+    uint64_t    padding[3];
+} ColumnsHeader;
+
+
+/*
+ * ColumnDescriptor
+ * ----------------
+ * The name and position of one column of a results file.
+ *
+ * parameters
+ * ----------
+ * char name[COLUMN_NAME_LENGTH]: The name of the column, padded with
+ *      nulls.
+ * uint32_t series: False for the columns of the table, which all have
+ *      the same number of rows, and true for a raw time series.
+ * uint32_t reserved: Zero.
+ * uint64_t rows: The number of values in the column.
+ * uint64_t offset: The offset of the first value in bytes.
+ */
+typedef struct ColumnDescriptor
+{
+    char        name[COLUMN_NAME_LENGTH];
+    uint32_t    series;
+    uint32_t    reserved;
+    uint64_t    rows;
+    uint64_t    offset;
+} ColumnDescriptor;
+
+
+/*
+ * Columns
+ * -------
+ * A table of results being built up in memory before it is saved.
+ *
+ * parameters
+ * ----------
+ * int number: The number of columns.
+ * int capacity: The number of columns there is room for.
+ * long rows: The number of rows in the table columns.
+ * long row_capacity: The number of rows there is room for.
+ * ColumnDescriptor *descriptors: The names and sizes of the columns.
+ * double **values: The values of each column.
+ */
+typedef struct Columns
+{
+    int                 number;
+    int                 capacity;
+    long                rows;
+    long                row_capacity;
+    ColumnDescriptor    *descriptors;
+    double              **values;
+} Columns;
+
+
+OutputFormat parse_output_format(const char *name);
+Columns *init_columns(int number, const char **names);
+void add_row_columns(Columns *columns, const double *values);
+void add_series_columns(Columns *columns, const char *name, const double *values, long rows);
+void save_columns(const Columns *columns, const char *file_name);
+void free_columns(Columns *columns);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef DYNAMICS_H
+#define DYNAMICS_H
+
+#define MAX_COORDINATION 6
+
+
+/*
+ * Rule
+ * ----
+ * The acceptance rules that can be used to decide whether a proposed 
+ * spin flip takes place. 
+ *
+ * values
+ * ------
+ * METROPOLIS: Accept with probability min(1, exp(-dE / T)).
+ * GLAUBER: Accept with the heat-bath probability 1 / (1 + exp(dE / T)).
+ */
+typedef enum Rule {
+    METROPOLIS,
+    GLAUBER
+} Rule;
+
+
+/*
+ * Transitions
+ * -----------
+ * The probability of flipping a spin tabulated for every spin and every 
+ * possible sum of its neighbours. The energy change only ever takes a 
+ * handful of values so the table is built once whenever the temperature, 
+ * coupling or field changes rather than calling exp() on every step.
+ *
+ * parameters
+ * ----------
+ * Rule rule: The acceptance rule the table was built for.
+ * int coordination: The number of neighbours of every spin.
+ * float temperature: The temperature the table was built for.
+ * float epsilon: The coupling coefficient the table was built for.
+ * float magnetic_field: The external field the table was built for.
+ * float probabilities[2][]: The flip probability indexed by whether the 
+ *      spin is up and by the neighbour sum plus the coordination.
+ */
+typedef struct Transitions
+{
+    Rule    rule;
+    int     coordination;
+    float   temperature;
+    float   epsilon;
+    float   magnetic_field;
+    float   probabilities[2][2 * MAX_COORDINATION + 1];
+} Transitions;
+
+
+Rule parse_rule(const char *name);
+void build_transitions(
+    Transitions *transitions, 
+    Rule rule, 
+    int coordination, 
+    float temperature, 
+    float epsilon, 
+    float magnetic_field);
+
+
+/*
+ * transition_probability
+ * ----------------------
+ * Look up the probability of flipping a spin.
+ *
+ * parameters
+ * ----------
+ * const Transitions *transitions: The tabulated probabilities.
+ * int spin: The current direction of the spin.
+ * int neighbours: The sum of the neighbouring spins.
+ *
+ * returns
+ * -------
+ * float probability: The probability that the spin flips.
+ */
+static inline float transition_probability(
+    const Transitions *transitions, 
+    int spin, 
+    int neighbours)
+{
+    return transitions -> probabilities[spin > 0]
+        [neighbours + transitions -> coordination];
+}
+
+#endif
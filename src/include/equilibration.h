@@ -0,0 +1,85 @@
+#ifndef EQUILIBRATION_H
+#define EQUILIBRATION_H
+#include"toml.h"
+
+
+/*
+ * BurnInMode
+ * ----------
+ * How long a system is evolved before it is measured.
+ *
+ * values
+ * ------
+ * FIXED_BURN_IN: Always evolve for the whole cap.
+ * AUTOMATIC_BURN_IN: Stop as soon as the energy and magnetisation are
+ *      stationary, or at the cap if they never are.
+ */
+typedef enum BurnInMode {
+    FIXED_BURN_IN,
+    AUTOMATIC_BURN_IN
+} BurnInMode;
+
+
+/*
+ * BurnIn
+ * ------
+ * The burn-in options of a workflow, read from the `burn_in` and
+ * `burn_in_cap` keys of its configuration.
+ *
+ * parameters
+ * ----------
+ * BurnInMode mode: Whether the burn-in stops once the system is stationary.
+ * double cap: The longest burn-in in sweeps, or zero to keep the fixed
+ *      length each workflow used to run.
+ */
+typedef struct BurnIn
+{
+    BurnInMode  mode;
+    double      cap;
+} BurnIn;
+
+
+/*
+ * Equilibration
+ * -------------
+ * The energy and magnetisation of a system sampled during its burn-in.
+ * The series are tested for stationarity at geometrically spaced counts,
+ * so the cost of the tests stays linear in the length of the burn-in.
+ *
+ * parameters
+ * ----------
+ * long spacing: The number of steps between samples.
+ * long sweep: The number of steps in one sweep of the system.
+ * long capacity: The number of samples at which the burn-in is capped.
+ * long count: The number of samples taken.
+ * long check: The count at which the series are next tested.
+ * double *energies: The energy at each sample.
+ * double *magnetisations: The absolute magnetisation at each sample.
+ */
+typedef struct Equilibration
+{
+    long    spacing;
+    long    sweep;
+    long    capacity;
+    long    count;
+    long    check;
+    double  *energies;
+    double  *magnetisations;
+} Equilibration;
+
+
+BurnIn read_burn_in(Config *config);
+long truncate_equilibration(const double *series, long count);
+long init_equilibration(
+    Equilibration *equilibration,
+    const BurnIn *burn_in,
+    long steps,
+    long sweep,
+    long minimum);
+int add_equilibration(
+    Equilibration *equilibration,
+    double energy,
+    double magnetisation);
+long free_equilibration(Equilibration *equilibration);
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef EXTERNAL_FIELD_H
+#define EXTERNAL_FIELD_H
+#include<stdio.h>
+#include"rng.h"
+#include"lattice.h"
+#include"dynamics.h"
+#include"columns.h"
+#include"equilibration.h"
+
+typedef struct SwendsenWang SwendsenWang;
+typedef struct TrajectoryWriter TrajectoryWriter;
+typedef struct Writer Writer;
+
+
+/*
+ * ising_t
+ * -------
+ * Represents an arbitrary ising spin lattice in two dimensions. 
+ *
+ * parameters
+ * ----------
+ * float temperature: The temperature of the lattice.
+ * float epsilon: The coupling coefficient of the spins.
+ * float magnetic_field: The external magentic field the system is in.
+ * int length: The length along one side of the system.
+ * Lattice *ensemble: The halo padded lattice of spins that represents the system. 
+ * int magnetisation: The running total of the spins.
+ * int aligned: The running count of bonds joining parallel spins.
+ * Transitions transitions: The tabulated flip probabilities. These must be 
+ *      rebuilt with the set_*_ising_t functions when the parameters change.
+ * Random random: The stream of random numbers used to evolve the system.
+ * SwendsenWang *clusters: The workspace of the cluster algorithm, 
+ *      allocated the first time the system is evolved with it.
+ * long steps: The number of steps the system has been evolved for.
+ * long accepted: The number of spins flipped by those steps.
+ */
+typedef struct ising_t 
+{
+    float temperature;
+    float epsilon;
+    float magnetic_field;
+    int length;
+    Lattice *ensemble;
+    int magnetisation;
+    int aligned;
+    Transitions transitions;
+    Random random;
+    SwendsenWang *clusters;
+    long steps;
+    long accepted;
+} ising_t;
+
+
+/*
+ * EngineT
+ * -------
+ * The algorithms that can be used to evolve an ising_t. This is selected 
+ * with the optional engine argument of the program.
+ *
+ * values
+ * ------
+ * METROPOLIS_T: Single spin flips at random sites (`metropolis`).
+ * SWENDSEN_WANG_T: Multi-cluster updates shared between threads 
+ *      (`swendsen_wang`).
+ */
+typedef enum EngineT {
+    METROPOLIS_T,
+    SWENDSEN_WANG_T
+} EngineT;
+
+
+void recount_ising_t(ising_t *system);
+void check_ising_t(const ising_t *system);
+ising_t *init_ising_t(float temperature, float magnetic_field, float epsilon, int length);
+void set_temperature_ising_t(ising_t *system, float temperature);
+void set_magnetic_field_ising_t(ising_t *system, float magnetic_field);
+void free_ising_t(ising_t *system);
+void metropolis_step_ising_t(ising_t *system);
+void metropolis_batch_ising_t(ising_t *system, long steps);
+EngineT engine_ising_t(const char *engine);
+void evolve_ising_t(ising_t *system, long steps, EngineT engine);
+long measurement_interval_ising_t(const ising_t *system, EngineT engine);
+long burn_in_ising_t(
+    ising_t *system, 
+    const BurnIn *burn_in, 
+    long steps, 
+    EngineT engine);
+float magnetisation_ising_t(ising_t *system);
+float energy_ising_t(ising_t *system);
+float entropy_ferromagnetic(ising_t *system);
+float entropy_paramagnetic(ising_t *system);
+float entropy_ising_t(ising_t *system);
+void print_ising_t(ising_t *system);
+void save_ising_t(FILE *save_file, ising_t *system);
+void write_frame_ising_t(
+    Writer *writer, 
+    TrajectoryWriter *trajectory, 
+    const ising_t *system);
+void save_checkpoint_ising_t(
+    Writer *writer, 
+    const ising_t *system, 
+    const char *file_name);
+ising_t *load_checkpoint_ising_t(const char *file_name);
+void snapshots(EngineT engine);
+void antiferromagnet(EngineT engine);
+void heat_capacity(EngineT engine);
+void reweighting(EngineT engine, OutputFormat format);
+void physical_parameters(EngineT engine, OutputFormat format);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+#include<stdint.h>
+
+
+/*
+ * Shape
+ * -----
+ * The periodic lattices a Geometry can describe. This is selected with
+ * the `geometry` key of a configuration.
+ *
+ * values
+ * ------
+ * CHAIN_SHAPE: A ring of spins with two neighbours each (`chain`).
+ * RECTANGULAR_SHAPE: A length by width square lattice with four
+ *      neighbours each (`rectangular`).
+ * CUBIC_SHAPE: A length by width by height simple cubic lattice with six
+ *      neighbours each (`cubic`).
+ * TRIANGULAR_SHAPE: A length by width triangular lattice with six
+ *      neighbours each (`triangular`).
+ */
+typedef enum Shape {
+    CHAIN_SHAPE,
+    RECTANGULAR_SHAPE,
+    CUBIC_SHAPE,
+    TRIANGULAR_SHAPE
+} Shape;
+
+
+/*
+ * Geometry
+ * --------
+ * The connectivity of a periodic lattice. The sites are numbered with
+ * the first axis varying fastest, so a site is x + length * (y + width *
+ * z), and the neighbours of every site are worked out once and stored in
+ * a table. The update kernels then look the neighbours up rather than
+ * wrapping the coordinates, and the same kernel serves every shape.
+ * Lengths of two give a site the same neighbour twice, in which case
+ * the bond is simply counted twice.
+ *
+ * parameters
+ * ----------
+ * Shape shape: The kind of lattice.
+ * int dimension: The number of axes, one, two or three.
+ * int lengths[3]: The number of sites along each axis, one for the unused
+ *      axes.
+ * int sites: The number of sites.
+ * int coordination: The number of neighbours of every site.
+ * long bonds: The number of bonds, sites * coordination / 2.
+ * int32_t *neighbours: The neighbours of site i are stored at
+ *      [i * coordination, (i + 1) * coordination).
+ */
+typedef struct Geometry
+{
+    Shape   shape;
+    int     dimension;
+    int     lengths[3];
+    int     sites;
+    int     coordination;
+    long    bonds;
+    int32_t *neighbours;
+} Geometry;
+
+
+Shape parse_shape(const char *name);
+const char *name_shape(Shape shape);
+Geometry *init_geometry(Shape shape, int length, int width, int height);
+void free_geometry(Geometry *geometry);
+
+
+/*
+ * neighbours_geometry
+ * -------------------
+ * Find the row of the neighbour table belonging to a site.
+ *
+ * parameters
+ * ----------
+ * const Geometry *geometry: The lattice.
+ * int site: The index of the site.
+ *
+ * returns
+ * -------
+ * const int32_t *neighbours: The coordination neighbours of the site.
+ */
+static inline const int32_t *neighbours_geometry(
+    const Geometry *geometry,
+    int site)
+{
+    return geometry -> neighbours + (long) site * geometry -> coordination;
+}
+
+#endif
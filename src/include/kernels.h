@@ -0,0 +1,196 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+#include<math.h>
+#include<stdint.h>
+#include"rng.h"
+#include"lattice.h"
+#include"geometry.h"
+#include"dynamics.h"
+
+
+/*
+ * Sites
+ * -----
+ * A view of the spins of a model that the kernels can evolve. The spins
+ * either live in a halo padded square Lattice, in which case the
+ * neighbours are found from the row stride, or in a flat array whose
+ * neighbours are read from the table of a Geometry.
+ *
+ * parameters
+ * ----------
+ * int8_t *spins: The spin at site zero.
+ * int length: The side of a square lattice or the number of sites of a
+ *      table.
+ * int stride: The number of bytes between the rows of a square lattice.
+ * Lattice *lattice: The square lattice, NULL for a table.
+ * const int32_t *neighbours: The neighbour table, NULL for a square
+ *      lattice.
+ */
+typedef struct Sites
+{
+    int8_t          *spins;
+    int             length;
+    int             stride;
+    Lattice         *lattice;
+    const int32_t   *neighbours;
+} Sites;
+
+
+/*
+ * Totals
+ * ------
+ * The running totals that every model keeps, or the change in them made
+ * by a kernel.
+ *
+ * parameters
+ * ----------
+ * long magnetisation: The sum of the spins.
+ * long aligned: The number of bonds joining parallel spins.
+ * long accepted: The number of spins flipped.
+ */
+typedef struct Totals
+{
+    long    magnetisation;
+    long    aligned;
+    long    accepted;
+} Totals;
+
+
+Totals metropolis_kernel(
+    const Sites *sites,
+    const Transitions *transitions,
+    Random *random,
+    long steps);
+Totals recount_kernel(const Sites *sites, int coordination);
+
+
+/*
+ * lattice_sites
+ * -------------
+ * View a square lattice as sites for the kernels.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The halo padded lattice.
+ *
+ * returns
+ * -------
+ * Sites sites: The view of the lattice.
+ */
+static inline Sites lattice_sites(Lattice *lattice)
+{
+    Sites sites = {lattice -> spins, lattice -> length, lattice -> stride,
+        lattice, NULL};
+    return sites;
+}
+
+
+/*
+ * geometry_sites
+ * --------------
+ * View a flat array of spins laid out by a geometry as sites for the
+ * kernels.
+ *
+ * parameters
+ * ----------
+ * const Geometry *geometry: The lattice the spins live on.
+ * int8_t *spins: The spin at every site of the geometry.
+ *
+ * returns
+ * -------
+ * Sites sites: The view of the spins.
+ */
+static inline Sites geometry_sites(const Geometry *geometry, int8_t *spins)
+{
+    Sites sites = {spins, geometry -> sites, 0, NULL, geometry -> neighbours};
+    return sites;
+}
+
+
+/*
+ * energy_kernel
+ * -------------
+ * The energy -epsilon * sum(s_i s_j) + magnetic_field * sum(s_i) of a
+ * model from its running totals.
+ *
+ * parameters
+ * ----------
+ * long bonds: The number of bonds of the lattice.
+ * long aligned: The number of bonds joining parallel spins.
+ * long magnetisation: The sum of the spins.
+ * float epsilon: The coupling coefficient.
+ * float magnetic_field: The external field.
+ *
+ * returns
+ * -------
+ * float energy: The energy of the model.
+ */
+static inline float energy_kernel(
+    long bonds,
+    long aligned,
+    long magnetisation,
+    float epsilon,
+    float magnetic_field)
+{
+    return - epsilon * (2 * aligned - bonds) + magnetic_field * magnetisation;
+}
+
+
+/*
+ * bond_entropy_kernel
+ * -------------------
+ * The mixing entropy of the aligned and anti-aligned bonds in Stirling's
+ * approximation. A fully aligned or fully anti-aligned lattice is one of
+ * the two ground states and has an entropy of log(2).
+ *
+ * parameters
+ * ----------
+ * long bonds: The number of bonds of the lattice.
+ * long aligned: The number of bonds joining parallel spins.
+ *
+ * returns
+ * -------
+ * float entropy: The entropy in units of the Boltzmann constant.
+ */
+static inline float bond_entropy_kernel(long bonds, long aligned)
+{
+    long opposed = bonds - aligned;
+
+    if ((aligned == 0) || (opposed == 0))
+    {
+        return log(2);
+    }
+
+    return bonds * log(bonds) - aligned * log(aligned) - opposed * log(opposed);
+}
+
+
+/*
+ * spin_entropy_kernel
+ * -------------------
+ * The mixing entropy of the up and down spins in Stirling's
+ * approximation, which is the entropy of a lattice without coupling.
+ *
+ * parameters
+ * ----------
+ * long sites: The number of spins.
+ * long magnetisation: The sum of the spins.
+ *
+ * returns
+ * -------
+ * float entropy: The entropy in units of the Boltzmann constant.
+ */
+static inline float spin_entropy_kernel(long sites, long magnetisation)
+{
+    long up = (sites + magnetisation) / 2;
+    long down = sites - up;
+
+    if ((up == 0) || (down == 0))
+    {
+        return 0;
+    }
+
+    return sites * log(sites) - up * log(up) - down * log(down);
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef LATTICE_H
+#define LATTICE_H
+#include<stdio.h>
+#include<stdint.h>
+#include"rng.h"
+
+
+/*
+ * Lattice
+ * -------
+ * A square lattice of spins with periodic boundaries stored contiguously
+ * as single bytes. The lattice is padded with a layer of ghost spins that
+ * mirror the opposite edge so that the neighbours of any spin can be read
+ * directly without wrapping the indices. The rows are 64-byte aligned and
+ * the ghost spin to the left of a row lives in the padding at the end of
+ * the previous row.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of the lattice.
+ * int stride: The number of bytes between the start of two rows.
+ * int8_t *buffer: The aligned allocation including the ghost rows.
+ * int8_t *spins: The spin at (0, 0) so that spins[row * stride + col] is
+ *      valid for -1 <= row, col <= length.
+ */
+typedef struct Lattice
+{
+    int     length;
+    int     stride;
+    int8_t  *buffer;
+    int8_t  *spins;
+} Lattice;
+
+
+Lattice *init_lattice(int length);
+void free_lattice(Lattice *lattice);
+void randomise_lattice(Lattice *lattice, Random *random);
+void fill_lattice(Lattice *lattice, int8_t spin);
+void copy_lattice(Lattice *destination, const Lattice *source);
+Lattice *clone_lattice(const Lattice *source);
+void pack_lattice(const Lattice *lattice, uint64_t *packed);
+void unpack_lattice(Lattice *lattice, const uint64_t *packed);
+void save_lattice(const Lattice *lattice, FILE *save_file, int trailing);
+int magnetisation_lattice(const Lattice *lattice);
+int aligned_bonds_lattice(const Lattice *lattice);
+
+
+/*
+ * words_lattice
+ * -------------
+ * The number of 64-bit words in each row of the packed spins.
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice to pack.
+ *
+ * returns
+ * -------
+ * int words: The row length divided by 64 rounding up.
+ */
+static inline int words_lattice(const Lattice *lattice)
+{
+    return (lattice -> length + 63) / 64;
+}
+
+
+/*
+ * spin_lattice
+ * ------------
+ * Read a spin from the lattice.
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice to read.
+ * int row: The row of the spin in the range [-1, length].
+ * int col: The column of the spin in the range [-1, length].
+ *
+ * returns
+ * -------
+ * int spin: The spin, either +1 or -1.
+ */
+static inline int spin_lattice(const Lattice *lattice, int row, int col)
+{
+    return lattice -> spins[row * lattice -> stride + col];
+}
+
+
+/*
+ * neighbours_lattice
+ * ------------------
+ * Sum the four nearest neighbours of a spin. The ghost layer takes care
+ * of the periodic boundary so no modular arithmetic is required.
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice containing the spin.
+ * int row: The row of the spin.
+ * int col: The column of the spin.
+ *
+ * returns
+ * -------
+ * int neighbours: The sum of the neighbouring spins.
+ */
+static inline int neighbours_lattice(const Lattice *lattice, int row, int col)
+{
+    const int8_t *site = lattice -> spins + row * lattice -> stride + col;
+    int stride = lattice -> stride;
+    return site[stride] + site[-stride] + site[1] + site[-1];
+}
+
+
+/*
+ * set_spin_lattice
+ * ----------------
+ * Set a spin in the lattice keeping the ghost layer consistent.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The lattice to modify.
+ * int row: The row of the spin in the range [0, length).
+ * int col: The column of the spin in the range [0, length).
+ * int spin: The new value of the spin.
+ */
+static inline void set_spin_lattice(Lattice *lattice, int row, int col, int spin)
+{
+    int length = lattice -> length;
+    int stride = lattice -> stride;
+    int8_t *spins = lattice -> spins;
+
+    spins[row * stride + col] = spin;
+
+    if (row == 0) spins[length * stride + col] = spin;
+    if (row == length - 1) spins[-stride + col] = spin;
+    if (col == 0) spins[row * stride + length] = spin;
+    if (col == length - 1) spins[row * stride - 1] = spin;
+}
+
+
+/*
+ * flip_spin_lattice
+ * -----------------
+ * Reverse the direction of a spin in the lattice.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The lattice to modify.
+ * int row: The row of the spin in the range [0, length).
+ * int col: The column of the spin in the range [0, length).
+ */
+static inline void flip_spin_lattice(Lattice *lattice, int row, int col)
+{
+    set_spin_lattice(lattice, row, col, -spin_lattice(lattice, row, col));
+}
+
+#endif
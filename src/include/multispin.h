@@ -0,0 +1,62 @@
+#ifndef MULTISPIN_H
+#define MULTISPIN_H
+#include<stdint.h>
+#include"2d_ising.h"
+#include"dynamics.h"
+#include"rng.h"
+
+
+/*
+ * MultiSpin2D
+ * -----------
+ * A multispin coded two-dimensional ising model. The square lattice is
+ * split into its two checkerboard sublattices and each sublattice row is
+ * packed into 64-bit words with a set bit representing an up spin. No two
+ * spins sharing a word are neighbours so a whole word can be updated at
+ * once using bitwise logic. Bit i of a black row r is the spin in column
+ * 2i + (r % 2) and of a white row r is the spin in column 2i + 1 - (r % 2).
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side. Must be even.
+ * int half: The number of spins in one sublattice row.
+ * int words: The number of words used to store a sublattice row.
+ * float temperature: The temperature of the system in natural units.
+ * Rule rule: The acceptance rule used to evolve the system.
+ * float table_temperature: The temperature the thresholds were built for.
+ * uint64_t thresholds[5]: The acceptance probability of a flip with the
+ *      given number of anti-aligned neighbours as a 32-bit fixed point
+ *      fraction, with 1 << 32 representing certain acceptance.
+ * uint64_t last_mask: The valid bits of the final word in a row.
+ * Random random: The stream of random numbers used to evolve the system.
+ * uint64_t *black: The packed black sublattice.
+ * uint64_t *white: The packed white sublattice.
+ * long accepted: The number of spins flipped.
+ */
+typedef struct MultiSpin2D
+{
+    int         length;
+    int         half;
+    int         words;
+    float       temperature;
+    Rule        rule;
+    float       table_temperature;
+    uint64_t    thresholds[5];
+    uint64_t    last_mask;
+    Random      random;
+    uint64_t    *black;
+    uint64_t    *white;
+    long        accepted;
+} MultiSpin2D;
+
+
+MultiSpin2D *init_multispin_2d(int length, float temperature);
+void free_multispin_2d(MultiSpin2D *system);
+void pack_multispin_2d(MultiSpin2D *packed, const Ising2D *system);
+void unpack_multispin_2d(const MultiSpin2D *packed, Ising2D *system);
+void build_thresholds_multispin_2d(MultiSpin2D *system);
+void sweep_multispin_2d(MultiSpin2D *system);
+int magnetisation_multispin_2d(const MultiSpin2D *system);
+float energy_multispin_2d(const MultiSpin2D *system);
+
+#endif
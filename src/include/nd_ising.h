@@ -0,0 +1,65 @@
+#ifndef ISINGND_H
+#define ISINGND_H
+#include<stdint.h>
+#include"toml.h"
+#include"geometry.h"
+#include"dynamics.h"
+#include"rng.h"
+#include"equilibration.h"
+
+
+/*
+ * IsingND
+ * -------
+ * An ising model on any lattice described by a Geometry. The neighbours
+ * of a spin are read from the neighbour table of the geometry so a
+ * single kernel evolves chains, rectangles, cubes and triangular
+ * lattices.
+ *
+ * parameters
+ * ----------
+ * const Geometry *geometry: The lattice, which is shared and not owned.
+ * float temperature: The temperature of the system in natural units.
+ * float magnetic_field: The external field of the system.
+ * int8_t *spins: The spin at every site of the geometry.
+ * int magnetisation: The running total of the spins.
+ * long aligned: The running count of bonds joining parallel spins.
+ * Transitions transitions: The tabulated flip probabilities. These must be
+ *      rebuilt with set_temperature_ising_nd when the temperature changes.
+ * Random random: The stream of random numbers used to evolve the system.
+ * long steps: The number of steps the system has been evolved for.
+ * long accepted: The number of spins flipped by those steps.
+ */
+typedef struct IsingND
+{
+    const Geometry  *geometry;
+    float           temperature;
+    float           magnetic_field;
+    int8_t          *spins;
+    int             magnetisation;
+    long            aligned;
+    Transitions     transitions;
+    Random          random;
+    long            steps;
+    long            accepted;
+} IsingND;
+
+
+IsingND *init_ising_nd(
+    const Geometry *geometry,
+    float temperature,
+    float magnetic_field);
+void free_ising_nd(IsingND *system);
+void set_temperature_ising_nd(IsingND *system, float temperature);
+void set_rule_ising_nd(IsingND *system, Rule rule);
+void recount_ising_nd(IsingND *system);
+void check_ising_nd(const IsingND *system);
+void metropolis_batch_ising_nd(IsingND *system, long steps);
+void evolve_ising_nd(IsingND *system, long steps);
+long burn_in_ising_nd(IsingND *system, const BurnIn *burn_in, long steps);
+float energy_ising_nd(const IsingND *system);
+int magnetisation_ising_nd(const IsingND *system);
+Geometry *geometry_ising_nd(Config *config);
+void physical_parameters_ising_nd(Config *config);
+
+#endif
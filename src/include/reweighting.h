@@ -0,0 +1,174 @@
+#ifndef REWEIGHTING_H
+#define REWEIGHTING_H
+
+
+/*
+ * Histogram
+ * ---------
+ * The joint histogram of the energy and magnetisation of a system
+ * sampled at one temperature and field. The energy of a state is
+ * -epsilon * (2 * aligned - bonds) + magnetic_field * magnetisation, so
+ * the bins are kept by the number of aligned bonds and the magnetisation,
+ * which are integers and bin the states exactly. The samples are stored
+ * as they arrive and sorted into bins by finish_histogram.
+ *
+ * parameters
+ * ----------
+ * double temperature: The temperature the samples were taken at.
+ * double magnetic_field: The field the samples were taken in.
+ * double epsilon: The coupling coefficient of the system.
+ * long bonds: The number of bonds of the lattice.
+ * long sites: The number of spins of the lattice.
+ * int run: The independent run the samples belong to, which groups the
+ *      histograms of a sweep for its errors.
+ * double inefficiency: The statistical inefficiency 2 tau of the samples,
+ *      the number of them that are worth one independent sample. It is
+ *      one unless set by whoever takes the samples.
+ * long samples: The number of samples.
+ * long capacity: The number of samples there is room for.
+ * long *keys: The aligned bonds and magnetisation of each sample packed
+ *      into one integer, freed once the bins are made.
+ * long bins: The number of occupied bins.
+ * long *aligned: The number of aligned bonds of each bin.
+ * long *magnetisations: The magnetisation of each bin.
+ * long *counts: The number of samples in each bin.
+ * double moments[4]: The mean and standard deviation of the aligned bonds
+ *      and of the magnetisation of the samples.
+ */
+typedef struct Histogram
+{
+    double  temperature;
+    double  magnetic_field;
+    double  epsilon;
+    long    bonds;
+    long    sites;
+    int     run;
+    double  inefficiency;
+    long    samples;
+    long    capacity;
+    long    *keys;
+    long    bins;
+    long    *aligned;
+    long    *magnetisations;
+    long    *counts;
+    double  moments[4];
+} Histogram;
+
+
+/*
+ * Reweighted
+ * ----------
+ * The observables of a system at a temperature and field estimated from
+ * a histogram taken elsewhere. They are for the whole system.
+ *
+ * parameters
+ * ----------
+ * double energy: The mean energy.
+ * double magnetisation: The mean absolute magnetisation.
+ * double heat_capacity: The variance of the energy over T^2.
+ * double susceptibility: The variance of the absolute magnetisation
+ *      over T.
+ * double shift: How far the mean aligned bonds or magnetisation moved
+ *      from the sampled ones in sampled standard deviations, or for a
+ *      combined analysis how far apart the neighbouring histograms are.
+ *      The estimates are reliable while this is at most one.
+ */
+typedef struct Reweighted
+{
+    double  energy;
+    double  magnetisation;
+    double  heat_capacity;
+    double  susceptibility;
+    double  shift;
+} Reweighted;
+
+
+/*
+ * Wham
+ * ----
+ * The density of states of a system combined from the histograms of
+ * runs at several temperatures by the weighted histogram analysis method
+ * of Ferrenberg and Swendsen. The histograms must be in zero field, so
+ * that the energy is set by the aligned bonds alone and a bin is one
+ * number of aligned bonds. The runs at one temperature are merged. Each
+ * histogram is weighted by its independent samples, its samples over its
+ * statistical inefficiency. The magnetisation is carried through as its
+ * mean over the samples of each bin, which does not depend on the
+ * temperature.
+ *
+ * parameters
+ * ----------
+ * double epsilon: The coupling coefficient of the system.
+ * long bonds: The number of bonds of the lattice.
+ * long sites: The number of spins of the lattice.
+ * int temperatures: The number of sampled temperatures.
+ * double *betas: The inverse of each sampled temperature.
+ * double *log_samples: The log of the number of independent samples at
+ *      each.
+ * double *free_energies: The free energy over the temperature at each,
+ *      relative to the first.
+ * double *means: The mean aligned bonds of the samples at each.
+ * double *spreads: The standard deviation of the aligned bonds at each.
+ * long bins: The number of occupied bins.
+ * long *aligned: The number of aligned bonds of each bin.
+ * double *energies: The energy of each bin.
+ * double *log_counts: The log of the independent samples in each bin
+ *      over all runs.
+ * double *log_states: The log of the density of states of each bin.
+ * double *magnetisations: The mean absolute magnetisation of each bin.
+ * double *squares: The mean square magnetisation of each bin.
+ */
+typedef struct Wham
+{
+    double  epsilon;
+    long    bonds;
+    long    sites;
+    int     temperatures;
+    double  *betas;
+    double  *log_samples;
+    double  *free_energies;
+    double  *means;
+    double  *spreads;
+    long    bins;
+    long    *aligned;
+    double  *energies;
+    double  *log_counts;
+    double  *log_states;
+    double  *magnetisations;
+    double  *squares;
+} Wham;
+
+
+void init_histogram(
+    Histogram *histogram,
+    double temperature,
+    double magnetic_field,
+    double epsilon,
+    long bonds,
+    long sites);
+void add_histogram(Histogram *histogram, long aligned, long magnetisation);
+void finish_histogram(Histogram *histogram);
+Reweighted reweight_histogram(
+    const Histogram *histogram,
+    double temperature,
+    double magnetic_field);
+void range_histogram(
+    const Histogram *histogram,
+    double *temperatures,
+    double *magnetic_fields);
+void free_histogram(Histogram *histogram);
+void save_histograms(
+    const char *file_name,
+    const Histogram *histograms,
+    int number);
+Histogram *load_histograms(const char *file_name, int *number);
+void init_wham(
+    Wham *wham,
+    const Histogram *histograms,
+    int number,
+    int skip);
+int solve_wham(Wham *wham, double tolerance, int limit);
+Reweighted reweight_wham(const Wham *wham, double temperature);
+void free_wham(Wham *wham);
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef RNG_H
+#define RNG_H
+#include<stdint.h>
+
+
+/*
+ * Random
+ * ------
+ * The state of a xoshiro256** pseudo-random number generator. Every 
+ * system and thread owns its own state so no generator is ever shared. 
+ * Independent streams are produced by jumping a state 2^128 steps ahead 
+ * so the streams can never overlap.
+ *
+ * parameters
+ * ----------
+ * uint64_t state[4]: The state of the generator. Must not be all zero.
+ */
+typedef struct Random
+{
+    uint64_t state[4];
+} Random;
+
+
+void seed_random(Random *random, uint64_t seed);
+void jump_random(Random *random);
+void long_jump_random(Random *random);
+void seed_master_random(uint64_t seed);
+void bind_random(Random *random);
+void split_random(Random *child);
+void split_streams_random(Random *parent, Random *streams, int number);
+
+
+/*
+ * next_random
+ * -----------
+ * Generate 64 random bits.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ *
+ * returns
+ * -------
+ * uint64_t word: A word of random bits.
+ */
+static inline uint64_t next_random(Random *random)
+{
+    uint64_t *state = random -> state;
+    uint64_t product = state[1] * 5;
+    uint64_t word = ((product << 7) | (product >> 57)) * 9;
+    uint64_t shifted = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = (state[3] << 45) | (state[3] >> 19);
+
+    return word;
+}
+
+
+/*
+ * normalised_random
+ * -----------------
+ * Generate a random number over the range [0, 1). 
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ *
+ * returns
+ * -------
+ * float: random number.
+ */
+static inline float normalised_random(Random *random)
+{
+    return (float) (next_random(random) >> 40) * 0x1p-24f;
+}
+
+
+/*
+ * random_index
+ * ------------
+ * Generate a random index in the range [0, length) without bias using 
+ * Lemire's multiply and reject method. The rejection is very rarely 
+ * needed so this is usually a single multiplication.
+ * 
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ * int length: The length of the array that is getting indexed. 
+ *
+ * returns
+ * -------
+ * int index: A random index.
+ */
+static inline int random_index(Random *random, int length)
+{
+    uint32_t range = (uint32_t) length;
+    uint64_t product = (next_random(random) >> 32) * range;
+    uint32_t low = (uint32_t) product;
+
+    if (low < range)
+    {
+        uint32_t threshold = -range % range;
+        while (low < threshold)
+        {
+            product = (next_random(random) >> 32) * range;
+            low = (uint32_t) product;
+        }
+    }
+
+    return (int) (product >> 32);
+}
+
+
+/*
+ * hash_random
+ * -----------
+ * Generate 64 random bits from a key and a counter with the splitmix64 
+ * finaliser. Unlike a stream the result does not depend on the order in 
+ * which the counters are visited, which is useful when the same decision 
+ * has to be reproduced by whichever thread reaches it first.
+ *
+ * parameters
+ * ----------
+ * uint64_t key: A random word shared by all of the counters.
+ * uint64_t counter: The index of the decision.
+ *
+ * returns
+ * -------
+ * uint64_t word: A word of random bits.
+ */
+static inline uint64_t hash_random(uint64_t key, uint64_t counter)
+{
+    uint64_t mixed = key + (counter + 1) * 0x9e3779b97f4a7c15ULL;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    return mixed ^ (mixed >> 31);
+}
+
+
+/* 
+ * random_spin
+ * -----------
+ * Generate + or - 1 randomly.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ *
+ * returns
+ * -------
+ * int: +1 or -1 randomly.
+ */ 
+static inline int random_spin(Random *random)
+{
+    return (next_random(random) >> 63) ? 1 : -1;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+
+/*
+ * Task
+ * ----
+ * A unit of independent work. The task should write its results into 
+ * its own slot of the context so that they can be reduced in order once 
+ * every task has finished.
+ *
+ * parameters
+ * ----------
+ * void *context: The data shared by all of the tasks.
+ * int task: The index of the task.
+ */
+typedef void (*Task)(void *context, int task);
+
+
+void run_tasks(Task function, void *context, int number, const double *costs);
+
+#endif
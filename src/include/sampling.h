@@ -0,0 +1,137 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+#include"toml.h"
+#include"analysis.h"
+#include"runner.h"
+
+
+/*
+ * SamplingMode
+ * ------------
+ * How many measurements are taken at each point of a workflow.
+ *
+ * values
+ * ------
+ * FIXED_SAMPLING: The number the workflow has always taken (`fixed`).
+ * PRECISION_SAMPLING: Until the error bars of the selected observables
+ *      reach a relative precision (`precision`).
+ * BUDGET_SAMPLING: Until the errors are as small as a wall clock budget
+ *      allows, with every point reaching the same error (`budget`).
+ * PILOT_SAMPLING: The short first pass of a budget that measures how hard
+ *      each point is. This is never read from a configuration.
+ */
+typedef enum SamplingMode {
+    FIXED_SAMPLING,
+    PRECISION_SAMPLING,
+    BUDGET_SAMPLING,
+    PILOT_SAMPLING
+} SamplingMode;
+
+
+/*
+ * Observable
+ * ----------
+ * The observables whose error bars can decide when a point is done. They
+ * are combined as a bit mask.
+ *
+ * values
+ * ------
+ * ENERGY_OBSERVABLE: The mean energy (`energy`).
+ * MAGNETISATION_OBSERVABLE: The mean absolute magnetisation
+ *      (`magnetisation`).
+ * HEAT_CAPACITY_OBSERVABLE: The variance of the energy (`heat_capacity`).
+ * SUSCEPTIBILITY_OBSERVABLE: The spread of the magnetisation
+ *      (`susceptibility`).
+ */
+typedef enum Observable {
+    ENERGY_OBSERVABLE = 1,
+    MAGNETISATION_OBSERVABLE = 2,
+    HEAT_CAPACITY_OBSERVABLE = 4,
+    SUSCEPTIBILITY_OBSERVABLE = 8
+} Observable;
+
+
+/*
+ * Sampling
+ * --------
+ * The sampling options of a workflow, see read_sampling.
+ *
+ * parameters
+ * ----------
+ * SamplingMode mode: How the number of measurements is chosen.
+ * double precision: The relative error wanted on each averaged point.
+ * double budget: The wall clock seconds the measurements may take.
+ * double deadline: When a budget runs out, from omp_get_wtime.
+ * int observables: The bit mask of the Observables that must reach the
+ *      precision.
+ * double limit: The most measurements a point may take as a multiple of
+ *      the fixed number.
+ */
+typedef struct Sampling
+{
+    SamplingMode    mode;
+    double          precision;
+    double          budget;
+    double          deadline;
+    int             observables;
+    double          limit;
+} Sampling;
+
+
+/*
+ * Sampler
+ * -------
+ * The measurements of one run at one point. The energy and absolute
+ * magnetisation are analysed by blocking so that their error bars allow
+ * for correlations, and the sampler decides when the run has enough.
+ *
+ * parameters
+ * ----------
+ * const Sampling *sampling: The options of the workflow.
+ * double target: The relative error the run should reach.
+ * long minimum: The fewest measurements to take.
+ * long maximum: The most measurements to take.
+ * long check: The count at which the errors are next tested.
+ * double started: When the first measurement was started.
+ * Blocking energies: The analysis of the energy.
+ * Blocking magnetisations: The analysis of the absolute magnetisation.
+ */
+typedef struct Sampler
+{
+    const Sampling  *sampling;
+    double          target;
+    long            minimum;
+    long            maximum;
+    long            check;
+    double          started;
+    Blocking        energies;
+    Blocking        magnetisations;
+} Sampler;
+
+
+Sampling read_sampling(Config *config);
+double target_sampling(
+    const Sampling *sampling,
+    const double *difficulties,
+    long points,
+    int threads);
+void run_sampling(
+    Task function,
+    void *context,
+    int number,
+    const double *costs,
+    Sampling *sampling,
+    double *target,
+    const double *difficulties,
+    long points);
+void init_sampler(
+    Sampler *sampler,
+    const Sampling *sampling,
+    double target,
+    long samples);
+int add_sampler(Sampler *sampler, double energy, double magnetisation);
+long count_sampler(const Sampler *sampler);
+double error_sampler(const Sampler *sampler);
+double difficulty_sampler(const Sampler *sampler);
+
+#endif
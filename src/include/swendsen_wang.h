@@ -0,0 +1,58 @@
+#ifndef SWENDSEN_WANG_H
+#define SWENDSEN_WANG_H
+#include<stdint.h>
+#include"rng.h"
+#include"external_field.h"
+
+
+/*
+ * SwendsenWang
+ * ------------
+ * The reusable workspace of the Swendsen-Wang algorithm. Every satisfied 
+ * bond, one that lowers the energy, is activated with probability 
+ * 1 - exp(-2 |epsilon| / T) and every cluster of sites joined by active 
+ * bonds is flipped with probability one half. Satisfied means parallel 
+ * for a ferromagnet and anti-parallel for an antiferromagnet so both signs 
+ * of epsilon are handled by the same rule. The external field is included 
+ * as a ghost spin, site N, that is coupled to every site with strength 
+ * |magnetic_field| and never flips, so the clusters attached to it are 
+ * left alone.
+ *
+ * The bonds of each row are drawn from the row's own stream in parallel 
+ * and the clusters are joined with a lock-free union-find that always 
+ * links the larger root below the smaller. The root of a cluster is 
+ * therefore its smallest site whatever the order of the unions and the 
+ * result does not depend on the number of threads.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of the lattice.
+ * float temperature: The temperature the thresholds were built for.
+ * float epsilon: The coupling the thresholds were built for.
+ * float magnetic_field: The field the thresholds were built for.
+ * uint64_t bond_threshold: The probability of activating a satisfied bond 
+ *      as a 32-bit fixed point fraction.
+ * uint64_t field_threshold: The probability of joining a site to the ghost 
+ *      spin as a 32-bit fixed point fraction.
+ * int *parents: The union-find forest over the N sites and the ghost.
+ * Random *streams: One random stream per row.
+ */
+typedef struct SwendsenWang
+{
+    int         length;
+    float       temperature;
+    float       epsilon;
+    float       magnetic_field;
+    uint64_t    bond_threshold;
+    uint64_t    field_threshold;
+    int         *parents;
+    Random      *streams;
+} SwendsenWang;
+
+
+SwendsenWang *init_swendsen_wang(ising_t *system);
+void free_swendsen_wang(SwendsenWang *clusters);
+void build_thresholds_swendsen_wang(SwendsenWang *clusters, const ising_t *system);
+void sweep_swendsen_wang(SwendsenWang *clusters, ising_t *system);
+
+#endif
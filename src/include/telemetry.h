@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+#include<stdio.h>
+#include"toml.h"
+
+
+/*
+ * Phase
+ * -----
+ * The parts of a workflow whose time is recorded separately.
+ *
+ * values
+ * ------
+ * BURN_IN_PHASE: Evolving a system towards equilibrium.
+ * MEASUREMENT_PHASE: Evolving and measuring a system in equilibrium.
+ * IO_PHASE: Writing results, trajectories and checkpoints.
+ */
+typedef enum Phase {
+    BURN_IN_PHASE,
+    MEASUREMENT_PHASE,
+    IO_PHASE,
+    NUM_PHASES
+} Phase;
+
+
+/*
+ * Probe
+ * -----
+ * The counters and timers of one thread. Every thread has its own probe
+ * so recording costs no more than an addition, and the probe is reported
+ * and cleared by record_telemetry once a point of a workflow is done.
+ *
+ * parameters
+ * ----------
+ * double seconds[NUM_PHASES]: The time spent in each phase.
+ * Phase phase: The phase being timed.
+ * double started: When the current phase started, negative if no phase
+ *      is being timed.
+ * long attempted: The number of attempted spin flips.
+ * long accepted: The number of spins flipped. The cluster engines count 
+ *      the spins they expect to flip as the attempts, so this can be the 
+ *      larger of the two.
+ * double burn_in: The number of sweeps spent burning in.
+ */
+typedef struct Probe
+{
+    double  seconds[NUM_PHASES];
+    Phase   phase;
+    double  started;
+    long    attempted;
+    long    accepted;
+    double  burn_in;
+} Probe;
+
+
+/*
+ * Telemetry
+ * ---------
+ * The record of where the time of a workflow goes. Each point of the
+ * workflow, such as one lattice size at one temperature, is written as a
+ * line of json to a sidecar of the results file and the totals are
+ * written as a final summary line.
+ *
+ * parameters
+ * ----------
+ * FILE *file: The json lines sidecar.
+ * const char *workflow: The name of the workflow.
+ * long points: The number of points the workflow will record.
+ * long completed: The number of points recorded so far.
+ * double started: When the workflow started.
+ * double progress_interval: The seconds between progress lines on the
+ *      terminal, zero for none.
+ * double progress: When the last progress line was printed.
+ * Probe totals: The sums over every recorded point.
+ */
+typedef struct Telemetry
+{
+    FILE        *file;
+    const char  *workflow;
+    long        points;
+    long        completed;
+    double      started;
+    double      progress_interval;
+    double      progress;
+    Probe       totals;
+} Telemetry;
+
+
+Telemetry *open_telemetry(
+    const char *save_file,
+    const char *workflow,
+    long points,
+    double progress_interval);
+Telemetry *config_telemetry(
+    Config *config,
+    const char *save_file,
+    const char *workflow,
+    long points);
+void start_telemetry(Phase phase);
+void stop_telemetry(void);
+void count_telemetry(long attempted, long accepted);
+void burn_in_telemetry(double sweeps);
+void reset_telemetry(void);
+void record_telemetry(Telemetry *telemetry, const char *point);
+void close_telemetry(Telemetry *telemetry);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TEMPERING_H
+#define TEMPERING_H
+#include"toml.h"
+#include"rng.h"
+#include"dynamics.h"
+#include"2d_ising.h"
+
+
+/*
+ * Tempering2D
+ * -----------
+ * A set of two-dimensional replicas, one per temperature, that evolve 
+ * independently and periodically attempt to exchange temperatures with 
+ * their neighbours. Cold replicas that are stuck in one magnetisation can 
+ * escape by drifting to a high temperature and back. Exchanges are made 
+ * by swapping the replicas between slots so that systems[t] is always at 
+ * temperatures[t].
+ *
+ * parameters
+ * ----------
+ * int replicas: The number of temperatures.
+ * float *temperatures: The temperature of each slot.
+ * Ising2D **systems: The replica currently at each temperature.
+ * long *attempts: The number of exchanges attempted between slot t and 
+ *      slot t + 1.
+ * long *accepts: The number of those exchanges that were accepted.
+ * Random random: The stream used to accept or reject exchanges.
+ */
+typedef struct Tempering2D
+{
+    int         replicas;
+    float       *temperatures;
+    Ising2D     **systems;
+    long        *attempts;
+    long        *accepts;
+    Random      random;
+} Tempering2D;
+
+
+Tempering2D *init_tempering_2d(int length, int replicas, 
+    const float *temperatures, Rule rule);
+void free_tempering_2d(Tempering2D *tempering);
+void evolve_tempering_2d(Tempering2D *tempering, long steps, Engine2D engine);
+void exchange_tempering_2d(Tempering2D *tempering, int parity);
+float acceptance_tempering_2d(const Tempering2D *tempering, int slot);
+void tempering_ising_2d(Config *config);
+
+#endif
@@ -79,4 +79,5 @@ Config* parse(Toml* toml);
 
 void add_pair_to_config(Config* config, Pair* pair);
 char *find(Config* config, char* key);
+char *find_default(Config *config, char *key, char *fallback);
 #endif 
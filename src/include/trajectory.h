@@ -0,0 +1,150 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+#include<stdio.h>
+#include<stdint.h>
+#include"lattice.h"
+
+#define TRAJECTORY_MAGIC "ISINGTRJ"
+#define TRAJECTORY_VERSION 2
+
+
+/*
+ * Trajectory
+ * ----------
+ * The header of a trajectory file, a sequence of frames of one lattice.
+ * Each frame holds the spins packed as by pack_lattice, XORed with the
+ * previous frame so only the flipped spins are set, and then run length
+ * encoded. Every keyframe_interval frames the XOR is taken against an
+ * empty lattice instead so that a frame can be reached by decoding at
+ * most keyframe_interval frames. The frames are followed by an index of
+ * their offsets so that any frame can be found without reading the ones
+ * before it. The fields are written in the byte order of the machine.
+ *
+ * parameters
+ * ----------
+ * char magic[8]: Always TRAJECTORY_MAGIC, without the terminating null.
+ * uint32_t version: The version of the layout, TRAJECTORY_VERSION.
+ * uint32_t header_size: The size of this header in bytes.
+ * uint32_t length: The number of spins along one side of the lattice.
+ * uint32_t words: The number of 64-bit words in each packed row.
+ * uint32_t keyframe_interval: The number of frames between keyframes.
+ * uint32_t reserved: Zero.
+ * uint64_t frames: The number of frames in the file.
+ * uint64_t index_offset: The offset of the frame index in bytes. The
+ *      index holds the offset of every frame as a uint64_t.
+ * uint64_t padding[2]: Zero, to keep the header 64 bytes long.
+ */
+typedef struct Trajectory
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    header_size;
+    uint32_t    length;
+    uint32_t    words;
+    uint32_t    keyframe_interval;
+    uint32_t    reserved;
+    uint64_t    frames;
+    uint64_t    index_offset;
+    uint64_t    padding[2];
+} Trajectory;
+
+
+/*
+ * Frame
+ * -----
+ * The header at the start of every frame of a trajectory, followed by
+ * size bytes of encoded spins and then zeros up to the next multiple of
+ * eight bytes, so that every frame starts aligned. The encoding is a
+ * sequence of runs, each a LEB128 count of zero words, a LEB128 count of
+ * literal words and then the literal words themselves, until every word
+ * of the lattice has been covered.
+ *
+ * parameters
+ * ----------
+ * uint32_t size: The number of bytes of encoded spins.
+ * uint32_t keyframe: True if the frame does not depend on the previous.
+ * float temperature: The temperature of the system.
+ * float epsilon: The coupling coefficient of the system.
+ * float magnetic_field: The external field of the system.
+ * uint32_t reserved: Zero.
+ * uint64_t steps: The number of steps the system had been evolved for.
+ */
+typedef struct Frame
+{
+    uint32_t    size;
+    uint32_t    keyframe;
+    float       temperature;
+    float       epsilon;
+    float       magnetic_field;
+    uint32_t    reserved;
+    uint64_t    steps;
+} Frame;
+
+
+/*
+ * TrajectoryWriter
+ * ----------------
+ * An open trajectory file that frames are being appended to.
+ *
+ * parameters
+ * ----------
+ * FILE *file: The file being written.
+ * Trajectory header: The header, written again when the file is closed.
+ * uint64_t offset: The number of bytes written so far.
+ * long capacity: The number of frames the index has room for.
+ * uint64_t *offsets: The offset of every frame written so far.
+ * uint64_t *previous: The packed spins of the last frame.
+ * uint64_t *current: The packed spins of the frame being written.
+ * uint8_t *buffer: Room for the encoding of a frame.
+ */
+typedef struct TrajectoryWriter
+{
+    FILE        *file;
+    Trajectory  header;
+    uint64_t    offset;
+    long        capacity;
+    uint64_t    *offsets;
+    uint64_t    *previous;
+    uint64_t    *current;
+    uint8_t     *buffer;
+} TrajectoryWriter;
+
+
+/*
+ * TrajectoryReader
+ * ----------------
+ * A trajectory file mapped into memory. The last frame to be decoded is
+ * kept so that reading the frames in order only decodes each one once.
+ *
+ * parameters
+ * ----------
+ * const Trajectory *header: The header at the start of the mapping.
+ * const uint64_t *offsets: The frame index.
+ * long decoded: The frame held in spins, or -1 if there is none.
+ * uint64_t *spins: The packed spins of the decoded frame.
+ */
+typedef struct TrajectoryReader
+{
+    const Trajectory    *header;
+    const uint64_t      *offsets;
+    long                decoded;
+    uint64_t            *spins;
+} TrajectoryReader;
+
+
+TrajectoryWriter *open_trajectory(
+    const char *file_name,
+    int length,
+    int keyframe_interval);
+void write_frame_trajectory(
+    TrajectoryWriter *writer,
+    const Lattice *lattice,
+    const Frame *frame);
+void close_trajectory(TrajectoryWriter *writer);
+TrajectoryReader *map_trajectory(const char *file_name);
+void unmap_trajectory(TrajectoryReader *reader);
+const Frame *frame_trajectory(const TrajectoryReader *reader, long frame);
+const uint64_t *read_frame_trajectory(TrajectoryReader *reader, long frame);
+void read_lattice_trajectory(TrajectoryReader *reader, long frame, Lattice *lattice);
+
+#endif
@@ -1,11 +1,9 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-int random_spin(void);
-int random_index(int length);
 int modulo(int dividend, int divisor);
-float normalised_random(void);
-float mean(float* array, int length);
-float variance(float* array, float mean, int length);
+double mean(double* array, int length);
+double variance(double* array, double mean, int length);
+
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef WOLFF_H
+#define WOLFF_H
+#include<stdint.h>
+#include"2d_ising.h"
+
+
+/*
+ * Wolff2D
+ * -------
+ * The reusable workspace of the Wolff single cluster algorithm for a 
+ * two-dimensional system. A cluster is grown from a random seed by adding 
+ * aligned neighbours with probability 1 - exp(-2 / T) and the whole cluster 
+ * is flipped at once, which avoids the critical slowing down of single 
+ * spin updates. The workspace also accumulates the cluster sizes, whose 
+ * mean is an improved estimator of the susceptibility.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of the lattice.
+ * float temperature: The temperature the threshold was built for.
+ * uint64_t threshold: The probability of adding an aligned neighbour to 
+ *      the cluster as a 32-bit fixed point fraction.
+ * int *stack: The rows and columns of the sites whose neighbours are 
+ *      still to be examined. Every site enters at most once so 2 * N 
+ *      entries are enough.
+ * long grown: The number of clusters grown at this temperature.
+ * long flipped: The total size of the clusters grown at this temperature.
+ * long clusters: The number of clusters grown since the last reset.
+ * long sizes: The total size of the clusters grown since the last reset.
+ */
+typedef struct Wolff2D
+{
+    int         length;
+    float       temperature;
+    uint64_t    threshold;
+    int         *stack;
+    long        grown;
+    long        flipped;
+    long        clusters;
+    long        sizes;
+} Wolff2D;
+
+
+Wolff2D *init_wolff_2d(int length);
+void free_wolff_2d(Wolff2D *cluster);
+void build_threshold_wolff_2d(Wolff2D *cluster, float temperature);
+long cluster_wolff_2d(Wolff2D *cluster, Ising2D *system);
+void evolve_wolff_2d(Wolff2D *cluster, Ising2D *system, long steps);
+void reset_wolff_2d(Wolff2D *cluster);
+double susceptibility_wolff_2d(const Wolff2D *cluster, float temperature);
+
+#endif
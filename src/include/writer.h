@@ -0,0 +1,94 @@
+#ifndef WRITER_H
+#define WRITER_H
+#include<stddef.h>
+#include<pthread.h>
+#include<stdatomic.h>
+#include"rng.h"
+#include"lattice.h"
+#include"checkpoint.h"
+#include"trajectory.h"
+
+
+/*
+ * Job
+ * ---
+ * A piece of output to produce on the writer thread. The job owns the
+ * item and must free it.
+ *
+ * parameters
+ * ----------
+ * void *item: The data to write.
+ */
+typedef void (*Job)(void *item);
+
+
+/*
+ * Slot
+ * ----
+ * One entry of the queue of a Writer.
+ *
+ * parameters
+ * ----------
+ * atomic size_t sequence: The position the slot is ready to be written
+ *      at, or one past the position it is ready to be read at.
+ * Job job: The job to run.
+ * void *item: The data of the job.
+ */
+typedef struct Slot
+{
+    atomic_size_t   sequence;
+    Job             job;
+    void            *item;
+} Slot;
+
+
+/*
+ * Writer
+ * ------
+ * A background thread that performs output handed to it by the
+ * simulation. The jobs are passed through a bounded lock-free queue
+ * that any number of threads may add to, and are run in the order they
+ * were added. When the queue is full the simulation waits for the
+ * writer to catch up rather than using more memory.
+ *
+ * parameters
+ * ----------
+ * size_t mask: The capacity of the queue less one, a power of two.
+ * Slot *slots: The queue.
+ * atomic size_t tail: The position of the next job to add.
+ * atomic size_t completed: The number of jobs that have finished.
+ * size_t head: The position of the next job to run, only used by the
+ *      writer thread.
+ * atomic int stopping: Set when the thread should exit once the queue
+ *      is empty.
+ * pthread_t thread: The writer thread.
+ */
+typedef struct Writer
+{
+    size_t          mask;
+    Slot            *slots;
+    atomic_size_t   tail;
+    atomic_size_t   completed;
+    size_t          head;
+    atomic_int      stopping;
+    pthread_t       thread;
+} Writer;
+
+
+Writer *init_writer(int capacity);
+void submit_writer(Writer *writer, Job job, void *item);
+void flush_writer(Writer *writer);
+void free_writer(Writer *writer);
+void frame_writer(
+    Writer *writer,
+    TrajectoryWriter *trajectory,
+    const Lattice *lattice,
+    const Frame *frame);
+void checkpoint_writer(
+    Writer *writer,
+    const char *file_name,
+    const Checkpoint *header,
+    const Lattice *lattice,
+    const Random *streams);
+
+#endif
@@ -0,0 +1,344 @@
+#include<stdio.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/dynamics.h"
+#include"include/kernels.h"
+
+// The number of steps whose random numbers are drawn together. The spin
+// and neighbours of a site are prefetched twice the distance ahead, or
+// for a table the row of the table is, and then the neighbours the table
+// points to are prefetched once the row has arrived.
+#define BATCH_SIZE_KERNEL 256
+#define PREFETCH_DISTANCE_KERNEL 8
+
+
+/*
+ * The topologies a kernel can be generated for. Each one supplies how a
+ * site is drawn as a pair of coordinates, its offset into the spins, the
+ * two stages of prefetching, the sum of its neighbours and how it is
+ * flipped. The square lattice draws a row and then a column so that the
+ * chain is the same as the single step functions of the models. Every
+ * topology takes the same arguments, so the ones a topology has no use
+ * for are voided.
+ */
+static inline void draw_square(const Sites *sites, Random *random, int *first, int *second)
+{
+    *first = random_index(random, sites -> length);
+    *second = random_index(random, sites -> length);
+}
+
+
+static inline int offset_square(const Sites *sites, int first, int second)
+{
+    return first * sites -> stride + second;
+}
+
+
+static inline void far_square(const Sites *sites, int offset, int coordination)
+{
+    (void) coordination;
+    const int8_t *site = sites -> spins + offset;
+    __builtin_prefetch(site, 1);
+    __builtin_prefetch(site - sites -> stride, 0);
+    __builtin_prefetch(site + sites -> stride, 0);
+}
+
+
+static inline void near_square(const Sites *sites, int offset, int coordination)
+{
+    (void) sites;
+    (void) offset;
+    (void) coordination;
+}
+
+
+static inline int sum_square(const Sites *sites, int offset, int coordination)
+{
+    (void) coordination;
+    const int8_t *site = sites -> spins + offset;
+    int stride = sites -> stride;
+    return site[stride] + site[-stride] + site[1] + site[-1];
+}
+
+
+static inline void flip_square(const Sites *sites, int first, int second, int spin)
+{
+    set_spin_lattice(sites -> lattice, first, second, -spin);
+}
+
+
+static inline void draw_table(const Sites *sites, Random *random, int *first, int *second)
+{
+    *first = random_index(random, sites -> length);
+    *second = 0;
+}
+
+
+static inline int offset_table(const Sites *sites, int first, int second)
+{
+    (void) sites;
+    (void) second;
+    return first;
+}
+
+
+static inline void far_table(const Sites *sites, int offset, int coordination)
+{
+    __builtin_prefetch(sites -> neighbours + (long) offset * coordination, 0);
+    __builtin_prefetch(sites -> spins + offset, 1);
+}
+
+
+static inline void near_table(const Sites *sites, int offset, int coordination)
+{
+    const int32_t *neighbours = sites -> neighbours + (long) offset * coordination;
+
+    for (int neighbour = 0; neighbour < coordination; neighbour++)
+    {
+        __builtin_prefetch(sites -> spins + neighbours[neighbour], 0);
+    }
+}
+
+
+static inline int sum_table(const Sites *sites, int offset, int coordination)
+{
+    const int32_t *neighbours = sites -> neighbours + (long) offset * coordination;
+    int sum = 0;
+
+    for (int neighbour = 0; neighbour < coordination; neighbour++)
+    {
+        sum += sites -> spins[neighbours[neighbour]];
+    }
+
+    return sum;
+}
+
+
+static inline void flip_table(const Sites *sites, int first, int second, int spin)
+{
+    (void) second;
+    sites -> spins[first] = -spin;
+}
+
+
+/*
+ * The acceptance probabilities. Without a field the change in energy
+ * 2 * s * epsilon * n only depends on the product of the spin and the
+ * neighbour sum, so the row of the up spin can be indexed by s * n and
+ * the direction of the spin never has to be tested.
+ */
+static inline float field_probability(
+    const Transitions *transitions,
+    int spin,
+    int sum,
+    int coordination)
+{
+    return transitions -> probabilities[spin > 0][sum + coordination];
+}
+
+
+static inline float zero_field_probability(
+    const Transitions *transitions,
+    int spin,
+    int sum,
+    int coordination)
+{
+    return transitions -> probabilities[1][spin * sum + coordination];
+}
+
+
+/*
+ * METROPOLIS_KERNEL
+ * -----------------
+ * Generate a batched metropolis kernel for one topology, coordination and
+ * treatment of the field. The random sites and deviates of a block of
+ * steps are drawn at once, in the order site then deviate, so that the
+ * upcoming sites can be prefetched while the flips are still applied
+ * strictly in order. The coordination is a constant in each kernel so the
+ * neighbour sums of a table are unrolled.
+ *
+ * parameters
+ * ----------
+ * NAME: The name of the generated function.
+ * TOPOLOGY: Either square or table.
+ * COORDINATION: The number of neighbours of every site.
+ * FIELD: Either field or zero_field.
+ */
+#define METROPOLIS_KERNEL(NAME, TOPOLOGY, COORDINATION, FIELD)                  \
+static Totals NAME(                                                             \
+    const Sites *sites,                                                         \
+    const Transitions *transitions,                                             \
+    Random *random,                                                             \
+    long steps)                                                                 \
+{                                                                               \
+    int firsts[BATCH_SIZE_KERNEL];                                              \
+    int seconds[BATCH_SIZE_KERNEL];                                             \
+    int offsets[BATCH_SIZE_KERNEL];                                             \
+    float randoms[BATCH_SIZE_KERNEL];                                           \
+    int8_t *spins = sites -> spins;                                             \
+    Totals changes = {0, 0, 0};                                                 \
+                                                                                \
+    while (steps > 0)                                                           \
+    {                                                                           \
+        int batch = (steps < BATCH_SIZE_KERNEL) ? steps : BATCH_SIZE_KERNEL;    \
+                                                                                \
+        for (int step = 0; step < batch; step++)                                \
+        {                                                                       \
+            draw_##TOPOLOGY(sites, random, &firsts[step], &seconds[step]);      \
+            randoms[step] = normalised_random(random);                          \
+            offsets[step] = offset_##TOPOLOGY(sites, firsts[step], seconds[step]); \
+        }                                                                       \
+                                                                                \
+        for (int step = 0; step < 2 * PREFETCH_DISTANCE_KERNEL && step < batch; step++) \
+        {                                                                       \
+            far_##TOPOLOGY(sites, offsets[step], COORDINATION);                 \
+        }                                                                       \
+                                                                                \
+        for (int step = 0; step < PREFETCH_DISTANCE_KERNEL && step < batch; step++) \
+        {                                                                       \
+            near_##TOPOLOGY(sites, offsets[step], COORDINATION);                \
+        }                                                                       \
+                                                                                \
+        for (int step = 0; step < batch; step++)                                \
+        {                                                                       \
+            if (step + 2 * PREFETCH_DISTANCE_KERNEL < batch)                    \
+            {                                                                   \
+                far_##TOPOLOGY(sites,                                           \
+                    offsets[step + 2 * PREFETCH_DISTANCE_KERNEL], COORDINATION); \
+            }                                                                   \
+                                                                                \
+            if (step + PREFETCH_DISTANCE_KERNEL < batch)                        \
+            {                                                                   \
+                near_##TOPOLOGY(sites,                                          \
+                    offsets[step + PREFETCH_DISTANCE_KERNEL], COORDINATION);    \
+            }                                                                   \
+                                                                                \
+            int spin = spins[offsets[step]];                                    \
+            int sum = sum_##TOPOLOGY(sites, offsets[step], COORDINATION);       \
+                                                                                \
+            if (randoms[step] <                                                 \
+                FIELD##_probability(transitions, spin, sum, COORDINATION))      \
+            {                                                                   \
+                changes.magnetisation -= 2 * spin;                              \
+                changes.aligned -= spin * sum;                                  \
+                changes.accepted++;                                             \
+                flip_##TOPOLOGY(sites, firsts[step], seconds[step], spin);      \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        steps -= batch;                                                         \
+    }                                                                           \
+                                                                                \
+    return changes;                                                             \
+}
+
+
+METROPOLIS_KERNEL(metropolis_square_field, square, 4, field)
+METROPOLIS_KERNEL(metropolis_square_zero_field, square, 4, zero_field)
+METROPOLIS_KERNEL(metropolis_table_2_field, table, 2, field)
+METROPOLIS_KERNEL(metropolis_table_2_zero_field, table, 2, zero_field)
+METROPOLIS_KERNEL(metropolis_table_4_field, table, 4, field)
+METROPOLIS_KERNEL(metropolis_table_4_zero_field, table, 4, zero_field)
+METROPOLIS_KERNEL(metropolis_table_6_field, table, 6, field)
+METROPOLIS_KERNEL(metropolis_table_6_zero_field, table, 6, zero_field)
+
+
+/*
+ * metropolis_kernel
+ * -----------------
+ * Perform many metropolis steps at random sites with the kernel
+ * generated for the topology of the sites, the coordination and whether
+ * there is a field. The coupling is already folded into the transition
+ * table so it needs no kernels of its own.
+ *
+ * parameters
+ * ----------
+ * const Sites *sites: The spins to evolve.
+ * const Transitions *transitions: The tabulated flip probabilities, whose
+ *      coordination must match the sites.
+ * Random *random: The stream the sites and deviates are drawn from.
+ * long steps: The number of attempted flips.
+ *
+ * returns
+ * -------
+ * Totals changes: The change in the running totals.
+ */
+Totals metropolis_kernel(
+    const Sites *sites,
+    const Transitions *transitions,
+    Random *random,
+    long steps)
+{
+    int field = transitions -> magnetic_field != 0;
+
+    if (sites -> neighbours == NULL)
+    {
+        return field ?
+            metropolis_square_field(sites, transitions, random, steps) :
+            metropolis_square_zero_field(sites, transitions, random, steps);
+    }
+
+    switch (transitions -> coordination)
+    {
+        case 2:
+            return field ?
+                metropolis_table_2_field(sites, transitions, random, steps) :
+                metropolis_table_2_zero_field(sites, transitions, random, steps);
+        case 4:
+            return field ?
+                metropolis_table_4_field(sites, transitions, random, steps) :
+                metropolis_table_4_zero_field(sites, transitions, random, steps);
+        case 6:
+            return field ?
+                metropolis_table_6_field(sites, transitions, random, steps) :
+                metropolis_table_6_zero_field(sites, transitions, random, steps);
+    }
+
+    printf("Error: No kernel for a coordination of %i!", transitions -> coordination);
+    exit(1);
+}
+
+
+/*
+ * recount_kernel
+ * --------------
+ * Count the running totals of a set of sites from scratch. Every bond of
+ * a table appears twice so the count is halved. The accepted count is
+ * left at zero.
+ *
+ * parameters
+ * ----------
+ * const Sites *sites: The spins to count.
+ * int coordination: The number of neighbours of every site.
+ *
+ * returns
+ * -------
+ * Totals totals: The magnetisation and aligned bonds.
+ */
+Totals recount_kernel(const Sites *sites, int coordination)
+{
+    Totals totals = {0, 0, 0};
+
+    if (sites -> neighbours == NULL)
+    {
+        totals.magnetisation = magnetisation_lattice(sites -> lattice);
+        totals.aligned = aligned_bonds_lattice(sites -> lattice);
+        return totals;
+    }
+
+    for (int site = 0; site < sites -> length; site++)
+    {
+        const int32_t *neighbours = sites -> neighbours + (long) site * coordination;
+        totals.magnetisation += sites -> spins[site];
+
+        for (int neighbour = 0; neighbour < coordination; neighbour++)
+        {
+            totals.aligned += sites -> spins[site] == sites -> spins[neighbours[neighbour]];
+        }
+    }
+
+    totals.aligned /= 2;
+    return totals;
+}
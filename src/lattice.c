@@ -0,0 +1,338 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+
+
+/*
+ * init_lattice
+ * ------------
+ * Allocate a lattice of spins. The spins are all initialised to +1.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of the lattice.
+ *
+ * returns
+ * -------
+ * Lattice *lattice: The lattice.
+ */
+Lattice *init_lattice(int length)
+{
+    // The right ghost sits at col = length and the left ghost at
+    // col = stride - 1 of the previous row so two bytes of padding are
+    // always needed.
+    int stride = ((length + 2 + 63) / 64) * 64;
+    size_t size = (size_t) stride * (length + 2);
+    int8_t *buffer = (int8_t*) aligned_alloc(64, size);
+
+    if (buffer == NULL)
+    {
+        printf("Error: Could not allocate a lattice of length %i", length);
+        exit(1);
+    }
+
+    memset(buffer, 0, size);
+
+    Lattice *lattice = (Lattice*) malloc(sizeof(Lattice));
+    lattice -> length = length;
+    lattice -> stride = stride;
+    lattice -> buffer = buffer;
+    lattice -> spins = buffer + stride;
+
+    fill_lattice(lattice, 1);
+    return lattice;
+}
+
+
+/*
+ * free_lattice
+ * ------------
+ * Release the memory occupied by a lattice.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The lattice to free.
+ */
+void free_lattice(Lattice *lattice)
+{
+    free(lattice -> buffer);
+    free(lattice);
+}
+
+
+/*
+ * randomise_lattice
+ * -----------------
+ * Assign every spin in the lattice a random direction.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The lattice to randomise.
+ * Random *random: The generator to draw the spins from.
+ */
+void randomise_lattice(Lattice *lattice, Random *random)
+{
+    int length = lattice -> length;
+
+    for (int row = 0; row < length; row++)
+    {
+        for (int col = 0; col < length; col++)
+        {
+            set_spin_lattice(lattice, row, col, random_spin(random));
+        }
+    }
+}
+
+
+/*
+ * fill_lattice
+ * ------------
+ * Align every spin in the lattice. The ghosts and the padding are filled 
+ * as well, which keeps the ghost layer consistent.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The lattice to fill.
+ * int8_t spin: The direction of the spins.
+ */
+void fill_lattice(Lattice *lattice, int8_t spin)
+{
+    size_t size = (size_t) lattice -> stride * (lattice -> length + 2);
+    memset(lattice -> buffer, spin, size);
+}
+
+
+/*
+ * copy_lattice
+ * ------------
+ * Copy the spins of one lattice into another of the same size.
+ *
+ * parameters
+ * ----------
+ * Lattice *destination: The lattice to overwrite.
+ * const Lattice *source: The lattice to copy.
+ */
+void copy_lattice(Lattice *destination, const Lattice *source)
+{
+    size_t size = (size_t) source -> stride * (source -> length + 2);
+    memcpy(destination -> buffer, source -> buffer, size);
+}
+
+
+/*
+ * clone_lattice
+ * -------------
+ * Allocate a copy of a lattice.
+ *
+ * parameters
+ * ----------
+ * const Lattice *source: The lattice to copy.
+ *
+ * returns
+ * -------
+ * Lattice *lattice: The copy, which must be released with free_lattice.
+ */
+Lattice *clone_lattice(const Lattice *source)
+{
+    size_t size = (size_t) source -> stride * (source -> length + 2);
+    int8_t *buffer = (int8_t*) aligned_alloc(64, size);
+
+    if (buffer == NULL)
+    {
+        printf("Error: Could not allocate a lattice of length %i", source -> length);
+        exit(1);
+    }
+
+    memcpy(buffer, source -> buffer, size);
+
+    Lattice *lattice = (Lattice*) malloc(sizeof(Lattice));
+    lattice -> length = source -> length;
+    lattice -> stride = source -> stride;
+    lattice -> buffer = buffer;
+    lattice -> spins = buffer + source -> stride;
+    return lattice;
+}
+
+
+/*
+ * pack_lattice
+ * ------------
+ * Pack the spins of the lattice one bit per spin with a set bit for an 
+ * up spin. Each row is padded to words_lattice words and bit (col % 64) 
+ * of word (row * words + col / 64) holds the spin at (row, col).
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice to pack.
+ * uint64_t *packed: The length * words_lattice words to write.
+ */
+void pack_lattice(const Lattice *lattice, uint64_t *packed)
+{
+    int length = lattice -> length;
+    int words = words_lattice(lattice);
+
+    for (int row = 0; row < length; row++)
+    {
+        const int8_t *spins = lattice -> spins + row * lattice -> stride;
+        uint64_t *row_words = packed + (size_t) row * words;
+
+        for (int word = 0; word < words; word++)
+        {
+            const int8_t *block = spins + 64 * word;
+            int size = (length - 64 * word < 64) ? length - 64 * word : 64;
+            uint64_t bits = 0;
+
+            for (int bit = 0; bit < size; bit++)
+            {
+                bits |= (uint64_t) (block[bit] > 0) << bit;
+            }
+
+            row_words[word] = bits;
+        }
+    }
+}
+
+
+/*
+ * unpack_lattice
+ * --------------
+ * Overwrite the spins of the lattice with spins packed by pack_lattice. 
+ * The rows are written directly and the ghost layer is then copied from 
+ * the opposite edges.
+ *
+ * parameters
+ * ----------
+ * Lattice *lattice: The lattice to overwrite.
+ * const uint64_t *packed: The packed spins.
+ */
+void unpack_lattice(Lattice *lattice, const uint64_t *packed)
+{
+    int length = lattice -> length;
+    int stride = lattice -> stride;
+    int words = words_lattice(lattice);
+
+    for (int row = 0; row < length; row++)
+    {
+        const uint64_t *row_words = packed + (size_t) row * words;
+        int8_t *spins = lattice -> spins + row * stride;
+
+        for (int word = 0; word < words; word++)
+        {
+            uint64_t bits = row_words[word];
+            int8_t *block = spins + 64 * word;
+            int size = (length - 64 * word < 64) ? length - 64 * word : 64;
+
+            // Written without a branch so that the loop vectorises.
+            for (int bit = 0; bit < size; bit++)
+            {
+                block[bit] = (int8_t) (2 * ((bits >> bit) & 1) - 1);
+            }
+        }
+
+        spins[length] = spins[0];
+        spins[-1] = spins[length - 1];
+    }
+
+    int8_t *spins = lattice -> spins;
+    memcpy(spins + length * stride, spins, length);
+    memcpy(spins - stride, spins + (length - 1) * stride, length);
+}
+
+
+/*
+ * save_lattice
+ * ------------
+ * Write the spins of the lattice to a file as comma separated rows.
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice to save.
+ * FILE *save_file: The file to write to.
+ * int trailing: True if every spin should be followed by a comma.
+ */
+void save_lattice(const Lattice *lattice, FILE *save_file, int trailing)
+{
+    int length = lattice -> length;
+
+    for (int row = 0; row < length; row++)
+    {
+        for (int col = 0; col < length - 1; col++)
+        {
+            fprintf(save_file, "%i,", spin_lattice(lattice, row, col));
+        }
+
+        fprintf(save_file, trailing ? "%i,\n" : "%i\n",
+            spin_lattice(lattice, row, length - 1));
+    }
+}
+
+
+/*
+ * magnetisation_lattice
+ * ---------------------
+ * Sum the spins of the lattice.
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice to measure.
+ *
+ * returns
+ * -------
+ * int magnetisation: The net magnetisation.
+ */
+int magnetisation_lattice(const Lattice *lattice)
+{
+    int length = lattice -> length;
+    int stride = lattice -> stride;
+    int magnetisation = 0;
+
+    for (int row = 0; row < length; row++)
+    {
+        const int8_t *spins = lattice -> spins + row * stride;
+
+        for (int col = 0; col < length; col++)
+        {
+            magnetisation += spins[col];
+        }
+    }
+
+    return magnetisation;
+}
+
+
+/*
+ * aligned_bonds_lattice
+ * ---------------------
+ * Count the nearest neighbour bonds joining two parallel spins. Each spin
+ * is compared with the spin below and to the right of it so every bond is
+ * counted exactly once.
+ *
+ * parameters
+ * ----------
+ * const Lattice *lattice: The lattice to measure.
+ *
+ * returns
+ * -------
+ * int aligned: The number of aligned bonds out of 2 * length * length.
+ */
+int aligned_bonds_lattice(const Lattice *lattice)
+{
+    int length = lattice -> length;
+    int stride = lattice -> stride;
+    int aligned = 0;
+
+    for (int row = 0; row < length; row++)
+    {
+        const int8_t *spins = lattice -> spins + row * stride;
+
+        for (int col = 0; col < length; col++)
+        {
+            aligned += spins[col] == spins[col + stride];
+            aligned += spins[col] == spins[col + 1];
+        }
+    }
+
+    return aligned;
+}
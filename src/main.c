@@ -1,14 +1,18 @@
 #include<stdio.h>
 #include<string.h>
 #include<stdlib.h>
+#include"include/rng.h"
 #include"include/toml.h"
 #include"include/1d_ising.h"
 #include"include/2d_ising.h"
+#include"include/nd_ising.h"
+#include"include/tempering.h"
 
 
 int main_ising_1d(char **args)
 {
     Config *config = init_config(args[1]);
+    seed_master_random(strtoull(find_default(config, "seed", "1"), NULL, 10));
 
     if (strcmp(args[0], "first_and_last") == 0)
     {
@@ -38,6 +42,7 @@ int main_ising_1d(char **args)
 int main_ising_2d(char **args)
 {
     Config *config = init_config(args[1]);
+    seed_master_random(strtoull(find_default(config, "seed", "1"), NULL, 10));
 
     if (strcmp(args[0], "first_and_last") == 0)
     {
@@ -55,6 +60,18 @@ int main_ising_2d(char **args)
     {
         heating_and_cooling_ising_2d(config);
     }
+    else if (strcmp(args[0], "tempering") == 0)
+    {
+        tempering_ising_2d(config);
+    }
+    else if (strcmp(args[0], "long_run") == 0)
+    {
+        long_run_ising_2d(config);
+    }
+    else if (strcmp(args[0], "wham") == 0)
+    {
+        wham_ising_2d(config);
+    }
     else
     {
         printf("Error: A valid option was not specified.\n");
@@ -63,6 +80,29 @@ int main_ising_2d(char **args)
         printf(" - physical_parameters\n");
         printf(" - magnetisation\n");
         printf(" - heating_and_cooling\n");
+        printf(" - tempering\n");
+        printf(" - long_run\n");
+        printf(" - wham\n");
+    }
+
+    return 0;
+}
+
+
+int main_ising_nd(char **args)
+{
+    Config *config = init_config(args[1]);
+    seed_master_random(strtoull(find_default(config, "seed", "1"), NULL, 10));
+
+    if (strcmp(args[0], "physical_parameters") == 0)
+    {
+        physical_parameters_ising_nd(config);
+    }
+    else
+    {
+        printf("Error: A valid option was not specified.\n");
+        printf("The valid options are:\n");
+        printf(" - physical_parameters\n");
     }
 
     return 0;
@@ -89,9 +129,13 @@ int main(int num_args, char **args)
     {
         main_ising_2d(new_args);
     }
+    else if (strcmp(args[1], "nd") == 0)
+    {
+        main_ising_nd(new_args);
+    }
     else
     {
-        printf("Error: Please specify either 1d or 2d from this switchboard!");
+        printf("Error: Please specify either 1d, 2d or nd from this switchboard!");
         exit(1);
     }
 
@@ -0,0 +1,398 @@
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/2d_ising.h"
+#include"include/dynamics.h"
+#include"include/multispin.h"
+
+
+/*
+ * shifted_word_multispin_2d
+ * -------------------------
+ * Read a word of a packed sublattice row displaced by one spin so that
+ * bit i holds spin i + offset, wrapping around the end of the row.
+ *
+ * parameters
+ * ----------
+ * const MultiSpin2D *system: The system the row belongs to.
+ * const uint64_t *row: The packed sublattice row.
+ * int word: The index of the word to read.
+ * int offset: Either +1 or -1.
+ *
+ * returns
+ * -------
+ * uint64_t shifted: The displaced word. Bits beyond the end of the row
+ *      are undefined.
+ */
+static inline uint64_t shifted_word_multispin_2d(
+    const MultiSpin2D *system,
+    const uint64_t *row,
+    int word,
+    int offset)
+{
+    int words = system -> words;
+    int top = (system -> half - 1) & 63;
+
+    if (offset < 0)
+    {
+        uint64_t carry = (word > 0) ?
+            row[word - 1] >> 63 : (row[words - 1] >> top) & 1;
+        return (row[word] << 1) | carry;
+    }
+    else
+    {
+        uint64_t carry = (word < words - 1) ?
+            row[word + 1] << 63 : (row[0] & 1) << top;
+        return (row[word] >> 1) | carry;
+    }
+}
+
+
+/*
+ * init_multispin_2d
+ * -----------------
+ * Construct a multispin coded model with every spin down. The spins are
+ * filled in by packing a lattice with pack_multispin_2d.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of the model.
+ * float temperature: The temperature of the system.
+ *
+ * returns
+ * -------
+ * MultiSpin2D *system: The packed model.
+ */
+MultiSpin2D *init_multispin_2d(int length, float temperature)
+{
+    if (length % 2 != 0)
+    {
+        printf("Error: The multispin engine requires an even length!");
+        exit(1);
+    }
+
+    int half = length / 2;
+    int words = (half + 63) / 64;
+
+    MultiSpin2D *system = (MultiSpin2D*) calloc(1, sizeof(MultiSpin2D));
+    split_random(&system -> random);
+    system -> length = length;
+    system -> half = half;
+    system -> words = words;
+    system -> temperature = temperature;
+    system -> rule = METROPOLIS;
+    system -> last_mask = (half % 64 == 0) ?
+        ~0ULL : (1ULL << (half % 64)) - 1;
+    system -> black = (uint64_t*) calloc(length * words, sizeof(uint64_t));
+    system -> white = (uint64_t*) calloc(length * words, sizeof(uint64_t));
+
+    build_thresholds_multispin_2d(system);
+    return system;
+}
+
+
+/*
+ * free_multispin_2d
+ * -----------------
+ * Release the memory occupied by a multispin coded model.
+ *
+ * parameters
+ * ----------
+ * MultiSpin2D *system: The model to free.
+ */
+void free_multispin_2d(MultiSpin2D *system)
+{
+    free(system -> black);
+    free(system -> white);
+    free(system);
+}
+
+
+/*
+ * pack_multispin_2d
+ * -----------------
+ * Copy the spins, temperature, rule and random stream of a byte per spin 
+ * model into a multispin coded model of the same size.
+ *
+ * parameters
+ * ----------
+ * MultiSpin2D *packed: The model to overwrite.
+ * const Ising2D *system: The model to copy.
+ */
+void pack_multispin_2d(MultiSpin2D *packed, const Ising2D *system)
+{
+    int length = packed -> length;
+    int words = packed -> words;
+
+    for (int word = 0; word < length * words; word++)
+    {
+        packed -> black[word] = 0;
+        packed -> white[word] = 0;
+    }
+
+    for (int row = 0; row < length; row++)
+    {
+        for (int col = 0; col < length; col++)
+        {
+            uint64_t *sublattice = ((row + col) & 1) ?
+                packed -> white : packed -> black;
+            uint64_t up = spin_lattice(system -> ensemble, row, col) > 0;
+            sublattice[row * words + (col >> 1) / 64] |= up << ((col >> 1) % 64);
+        }
+    }
+
+    packed -> temperature = system -> temperature;
+    packed -> rule = system -> transitions.rule;
+    packed -> random = system -> random;
+    build_thresholds_multispin_2d(packed);
+}
+
+
+/*
+ * unpack_multispin_2d
+ * -------------------
+ * Copy the spins and random stream of a multispin coded model back into 
+ * a byte per spin model of the same size.
+ *
+ * parameters
+ * ----------
+ * const MultiSpin2D *packed: The model to copy.
+ * Ising2D *system: The model to overwrite.
+ */
+void unpack_multispin_2d(const MultiSpin2D *packed, Ising2D *system)
+{
+    int length = packed -> length;
+    int words = packed -> words;
+
+    for (int row = 0; row < length; row++)
+    {
+        for (int col = 0; col < length; col++)
+        {
+            const uint64_t *sublattice = ((row + col) & 1) ?
+                packed -> white : packed -> black;
+            uint64_t word = sublattice[row * words + (col >> 1) / 64];
+            int up = (word >> ((col >> 1) % 64)) & 1;
+            set_spin_lattice(system -> ensemble, row, col, up ? 1 : -1);
+        }
+    }
+
+    system -> random = packed -> random;
+}
+
+
+/*
+ * build_thresholds_multispin_2d
+ * -----------------------------
+ * Tabulate the acceptance probability for each number of anti-aligned
+ * neighbours at the current temperature. A spin with a anti-aligned
+ * neighbours has a neighbour sum of (4 - 2a) times its own direction.
+ *
+ * parameters
+ * ----------
+ * MultiSpin2D *system: The model to build the table for.
+ */
+void build_thresholds_multispin_2d(MultiSpin2D *system)
+{
+    float temperature = system -> temperature;
+    Transitions transitions;
+    build_transitions(&transitions, system -> rule, 4, temperature, 1., 0.);
+
+    for (int anti = 0; anti < 5; anti++)
+    {
+        double probability = transition_probability(&transitions, 1, 4 - 2 * anti);
+        system -> thresholds[anti] = (probability >= 1.) ?
+            (1ULL << 32) : (uint64_t) (probability * 4294967296.);
+    }
+
+    system -> table_temperature = temperature;
+}
+
+
+/*
+ * update_sublattice_multispin_2d
+ * ------------------------------
+ * Apply the acceptance rule to every spin of one sublattice. The
+ * number of anti-aligned neighbours of 64 spins is found at once with a
+ * bit sliced adder. The acceptance test compares the binary expansion of
+ * 64 uniform deviates against the tabulated thresholds one digit at a
+ * time, stopping once every spin is decided which usually takes around
+ * seven random words.
+ *
+ * parameters
+ * ----------
+ * MultiSpin2D *system: The model to update.
+ * int colour: 0 for the black sublattice and 1 for the white.
+ */
+static void update_sublattice_multispin_2d(MultiSpin2D *system, int colour)
+{
+    int length = system -> length;
+    int words = system -> words;
+    uint64_t *self = colour ? system -> white : system -> black;
+    const uint64_t *other = colour ? system -> black : system -> white;
+    const uint64_t *thresholds = system -> thresholds;
+
+    for (int row = 0; row < length; row++)
+    {
+        int offset = ((row + colour) & 1) ? 1 : -1;
+        uint64_t *spins = self + row * words;
+        const uint64_t *same = other + row * words;
+        const uint64_t *above = other + (row == 0 ? length - 1 : row - 1) * words;
+        const uint64_t *below = other + (row == length - 1 ? 0 : row + 1) * words;
+
+        for (int word = 0; word < words; word++)
+        {
+            uint64_t mask = (word == words - 1) ? system -> last_mask : ~0ULL;
+            uint64_t spin = spins[word];
+            uint64_t side = shifted_word_multispin_2d(system, same, word, offset);
+
+            uint64_t anti_1 = spin ^ above[word];
+            uint64_t anti_2 = spin ^ below[word];
+            uint64_t anti_3 = spin ^ same[word];
+            uint64_t anti_4 = spin ^ side;
+
+            uint64_t sum_12 = anti_1 ^ anti_2, carry_12 = anti_1 & anti_2;
+            uint64_t sum_34 = anti_3 ^ anti_4, carry_34 = anti_3 & anti_4;
+            uint64_t bit_0 = sum_12 ^ sum_34;
+            uint64_t carry = sum_12 & sum_34;
+            uint64_t bit_1 = carry_12 ^ carry_34 ^ carry;
+            uint64_t bit_2 = carry_12 & carry_34;
+
+            uint64_t classes[5] = {
+                ~(bit_0 | bit_1 | bit_2),
+                bit_0 & ~bit_1,
+                ~bit_0 & bit_1,
+                bit_0 & bit_1,
+                bit_2
+            };
+
+            uint64_t flip = 0, undecided = 0;
+            for (int anti = 0; anti < 5; anti++)
+            {
+                if (thresholds[anti] >> 32) flip |= classes[anti];
+                else if (thresholds[anti]) undecided |= classes[anti];
+            }
+            undecided &= mask;
+
+            for (int digit = 31; undecided && digit >= 0; digit--)
+            {
+                uint64_t random = next_random(&system -> random);
+                uint64_t threshold = 0;
+
+                for (int anti = 0; anti < 5; anti++)
+                {
+                    if ((thresholds[anti] >> digit) & 1)
+                        threshold |= classes[anti];
+                }
+
+                uint64_t decided = undecided & (random ^ threshold);
+                flip |= decided & threshold;
+                undecided &= ~decided;
+            }
+
+            spins[word] = spin ^ (flip & mask);
+            system -> accepted += __builtin_popcountll(flip & mask);
+        }
+    }
+}
+
+
+/*
+ * sweep_multispin_2d
+ * ------------------
+ * Attempt to flip every spin once, first on the black sublattice and then
+ * on the white.
+ *
+ * parameters
+ * ----------
+ * MultiSpin2D *system: The model to evolve.
+ */
+void sweep_multispin_2d(MultiSpin2D *system)
+{
+    if (system -> temperature != system -> table_temperature)
+    {
+        build_thresholds_multispin_2d(system);
+    }
+
+    update_sublattice_multispin_2d(system, 0);
+    update_sublattice_multispin_2d(system, 1);
+}
+
+
+/*
+ * magnetisation_multispin_2d
+ * --------------------------
+ * Calculate the magnetisation of the model by counting the set bits.
+ *
+ * parameters
+ * ----------
+ * const MultiSpin2D *system: The model to measure.
+ *
+ * returns
+ * -------
+ * int magnetisation: The net magnetisation.
+ */
+int magnetisation_multispin_2d(const MultiSpin2D *system)
+{
+    int length = system -> length;
+    int words = system -> words;
+    int up = 0;
+
+    for (int word = 0; word < length * words; word++)
+    {
+        up += __builtin_popcountll(system -> black[word]);
+        up += __builtin_popcountll(system -> white[word]);
+    }
+
+    return 2 * up - length * length;
+}
+
+
+/*
+ * energy_multispin_2d
+ * -------------------
+ * Calculate the energy of the model. Every bond joins a black spin to a
+ * white spin so counting the anti-aligned neighbours of the black
+ * sublattice counts every anti-aligned bond once.
+ *
+ * parameters
+ * ----------
+ * const MultiSpin2D *system: The model to measure.
+ *
+ * returns
+ * -------
+ * float energy: The energy of the model.
+ */
+float energy_multispin_2d(const MultiSpin2D *system)
+{
+    int length = system -> length;
+    int words = system -> words;
+    long anti = 0;
+
+    for (int row = 0; row < length; row++)
+    {
+        int offset = (row & 1) ? 1 : -1;
+        const uint64_t *spins = system -> black + row * words;
+        const uint64_t *same = system -> white + row * words;
+        const uint64_t *below = system -> white +
+            (row == length - 1 ? 0 : row + 1) * words;
+        const uint64_t *above = system -> white +
+            (row == 0 ? length - 1 : row - 1) * words;
+
+        for (int word = 0; word < words; word++)
+        {
+            uint64_t mask = (word == words - 1) ? system -> last_mask : ~0ULL;
+            uint64_t spin = spins[word];
+            uint64_t side = shifted_word_multispin_2d(system, same, word, offset);
+
+            anti += __builtin_popcountll((spin ^ above[word]) & mask);
+            anti += __builtin_popcountll((spin ^ below[word]) & mask);
+            anti += __builtin_popcountll((spin ^ same[word]) & mask);
+            anti += __builtin_popcountll((spin ^ side) & mask);
+        }
+    }
+
+    return (float) (2 * anti - 2 * length * length);
+}
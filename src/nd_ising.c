@@ -0,0 +1,604 @@
+#include<math.h>
+#include<stdio.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+#include"include/toml.h"
+#include"include/rng.h"
+#include"include/utils.h"
+#include"include/geometry.h"
+#include"include/nd_ising.h"
+#include"include/runner.h"
+#include"include/accumulator.h"
+#include"include/analysis.h"
+#include"include/columns.h"
+#include"include/telemetry.h"
+#include"include/equilibration.h"
+#include"include/sampling.h"
+#include"include/kernels.h"
+
+
+/*
+ * init_ising_nd
+ * -------------
+ * Construct an ising model with random spins on a lattice.
+ *
+ * parameters
+ * ----------
+ * const Geometry *geometry: The lattice, which must outlive the system.
+ * float temperature: The temperature of the system in natural units.
+ * float magnetic_field: The external field of the system.
+ *
+ * returns
+ * -------
+ * IsingND *system: A random spin state on the lattice.
+ */
+IsingND *init_ising_nd(
+    const Geometry *geometry,
+    float temperature,
+    float magnetic_field)
+{
+    IsingND *system = (IsingND*) calloc(1, sizeof(IsingND));
+    split_random(&system -> random);
+
+    system -> spins = (int8_t*) malloc(geometry -> sites * sizeof(int8_t));
+    for (int site = 0; site < geometry -> sites; site++)
+    {
+        system -> spins[site] = random_spin(&system -> random);
+    }
+
+    system -> geometry = geometry;
+    system -> temperature = temperature;
+    system -> magnetic_field = magnetic_field;
+    build_transitions(&system -> transitions, METROPOLIS,
+        geometry -> coordination, temperature, 1., magnetic_field);
+    recount_ising_nd(system);
+    return system;
+}
+
+
+/*
+ * free_ising_nd
+ * -------------
+ * Release the spins of a system. The geometry is left alone since it
+ * may be shared with other systems.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The system to free.
+ */
+void free_ising_nd(IsingND *system)
+{
+    free(system -> spins);
+    free(system);
+}
+
+
+/*
+ * set_temperature_ising_nd
+ * ------------------------
+ * Change the temperature of the system and rebuild the table of flip
+ * probabilities.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The system to modify.
+ * float temperature: The new temperature.
+ */
+void set_temperature_ising_nd(IsingND *system, float temperature)
+{
+    system -> temperature = temperature;
+    build_transitions(&system -> transitions, system -> transitions.rule,
+        system -> geometry -> coordination, temperature, 1.,
+        system -> magnetic_field);
+}
+
+
+/*
+ * set_rule_ising_nd
+ * -----------------
+ * Change the acceptance rule used to evolve the system.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The system to modify.
+ * Rule rule: The new acceptance rule.
+ */
+void set_rule_ising_nd(IsingND *system, Rule rule)
+{
+    build_transitions(&system -> transitions, rule,
+        system -> geometry -> coordination, system -> temperature, 1.,
+        system -> magnetic_field);
+}
+
+
+/*
+ * recount_ising_nd
+ * ----------------
+ * Recalculate the running totals of the system from its spins.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The system to recount.
+ */
+void recount_ising_nd(IsingND *system)
+{
+    Sites sites = geometry_sites(system -> geometry, system -> spins);
+    Totals totals = recount_kernel(&sites, system -> geometry -> coordination);
+    system -> magnetisation = totals.magnetisation;
+    system -> aligned = totals.aligned;
+}
+
+
+/*
+ * check_ising_nd
+ * --------------
+ * A debugging utility that compares the running totals of the system
+ * against a full recount. This does nothing unless compiled with
+ * ISING_DEBUG defined.
+ *
+ * parameters
+ * ----------
+ * const IsingND *system: The system to check.
+ */
+void check_ising_nd(const IsingND *system)
+{
+#ifdef ISING_DEBUG
+    IsingND recount = *system;
+    recount_ising_nd(&recount);
+
+    if ((recount.magnetisation != system -> magnetisation) ||
+        (recount.aligned != system -> aligned) ||
+        (system -> temperature != system -> transitions.temperature))
+    {
+        printf("Error: Running totals (%i, %li) do not match (%i, %li)!",
+            system -> magnetisation, system -> aligned,
+            recount.magnetisation, recount.aligned);
+        exit(1);
+    }
+#else
+    (void) system;
+#endif
+}
+
+
+/*
+ * metropolis_batch_ising_nd
+ * -------------------------
+ * Perform many metropolis steps at random sites with the neighbour table
+ * kernel of the kernel library generated for the coordination of the
+ * geometry, so the neighbour sums are unrolled and the field only enters
+ * the updates when there is one. The kernel prefetches the table rows
+ * and then the neighbours of upcoming sites, which matters for the
+ * scattered neighbours of three dimensional lattices.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The spin ensamble to evolve.
+ * long steps: The number of attempted flips.
+ */
+void metropolis_batch_ising_nd(IsingND *system, long steps)
+{
+    Sites sites = geometry_sites(system -> geometry, system -> spins);
+    Totals changes = metropolis_kernel(&sites, &system -> transitions,
+        &system -> random, steps);
+
+    system -> magnetisation += changes.magnetisation;
+    system -> aligned += changes.aligned;
+    system -> accepted += changes.accepted;
+}
+
+
+/*
+ * evolve_ising_nd
+ * ---------------
+ * Evolve the system by a number of attempted spin flips. The flips are
+ * added to the telemetry counters of the calling thread.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The system to evolve.
+ * long steps: The number of attempted spin flips.
+ */
+void evolve_ising_nd(IsingND *system, long steps)
+{
+    long accepted = system -> accepted;
+    system -> steps += steps;
+    metropolis_batch_ising_nd(system, steps);
+    count_telemetry(steps, system -> accepted - accepted);
+}
+
+
+/*
+ * burn_in_ising_nd
+ * ----------------
+ * Evolve the system towards equilibrium, stopping early once its energy
+ * and magnetisation are stationary if the burn-in is automatic.
+ *
+ * parameters
+ * ----------
+ * IsingND *system: The system to burn in.
+ * const BurnIn *burn_in: The burn-in options of the workflow.
+ * long steps: The fixed burn-in of the workflow.
+ *
+ * returns
+ * -------
+ * long steps: The number of steps the system was evolved for.
+ */
+long burn_in_ising_nd(IsingND *system, const BurnIn *burn_in, long steps)
+{
+    Equilibration equilibration;
+    long spacing = init_equilibration(&equilibration, burn_in, steps,
+        system -> geometry -> sites, 1);
+
+    do
+    {
+        evolve_ising_nd(system, spacing);
+    } while (!add_equilibration(&equilibration, energy_ising_nd(system),
+        abs(magnetisation_ising_nd(system))));
+
+    return free_equilibration(&equilibration);
+}
+
+
+/*
+ * energy_ising_nd
+ * ---------------
+ * Calculate the energy of the system, -sum(s_i s_j) over the bonds plus
+ * the field times the magnetisation.
+ *
+ * parameters
+ * ----------
+ * const IsingND *system: The system to measure.
+ *
+ * returns
+ * -------
+ * float energy: The energy.
+ */
+float energy_ising_nd(const IsingND *system)
+{
+    check_ising_nd(system);
+    return energy_kernel(system -> geometry -> bonds, system -> aligned,
+        system -> magnetisation, 1., system -> magnetic_field);
+}
+
+
+/*
+ * magnetisation_ising_nd
+ * ----------------------
+ * Calculate the magnetisation of the system.
+ *
+ * parameters
+ * ----------
+ * const IsingND *system: The system to measure.
+ *
+ * returns
+ * -------
+ * int magnetisation: The sum of the spins.
+ */
+int magnetisation_ising_nd(const IsingND *system)
+{
+    check_ising_nd(system);
+    return system -> magnetisation;
+}
+
+
+/*
+ * geometry_ising_nd
+ * -----------------
+ * Build the lattice described by a configuration. The `geometry` key
+ * names the shape and `length` the number of sites along the first axis.
+ * The optional `width` and `height` keys give the other axes and default
+ * to the length.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ *
+ * returns
+ * -------
+ * Geometry *geometry: The lattice.
+ */
+Geometry *geometry_ising_nd(Config *config)
+{
+    Shape shape = parse_shape(find(config, "geometry"));
+    char *length = find(config, "length");
+    int width = atoi(find_default(config, "width", length));
+    int height = atoi(find_default(config, "height", length));
+    return init_geometry(shape, atoi(length), width, height);
+}
+
+
+/*
+ * ParametersND
+ * ------------
+ * The shared state of the tasks of physical_parameters_ising_nd. Each
+ * task follows one run down the temperature grid and stores its averages
+ * at [run * length + temp].
+ *
+ * parameters
+ * ----------
+ * const Geometry *geometry: The lattice shared by every run.
+ * int length: The number of temperatures.
+ * float stop: The highest temperature.
+ * float step: The spacing of the temperatures.
+ * float magnetic_field: The external field.
+ * long sweeps: The fixed number of measurements at each temperature,
+ *      one sweep apart.
+ * Rule rule: The acceptance rule used to evolve the systems.
+ * BurnIn burn_in: How long each run is evolved before it is measured.
+ * Sampling sampling: How many measurements each run takes.
+ * double target: The relative error each run should reach.
+ * double *difficulties: How hard each run is to measure at each
+ *      temperature, only used by the pilot of a budget.
+ * double *energies: The mean energy of each run at each temperature.
+ * double *magnetisations: The mean absolute magnetisation of each run at
+ *      each temperature.
+ * double *heat_capacities: The heat capacity of each run at each
+ *      temperature.
+ * double *susceptibilities: The susceptibility of each run at each
+ *      temperature.
+ * double *autocorrelations: The integrated autocorrelation time of the
+ *      energy of each run at each temperature in sweeps.
+ * Telemetry *telemetry: Where each run at each temperature is recorded,
+ *      or NULL.
+ */
+typedef struct ParametersND
+{
+    const Geometry  *geometry;
+    int             length;
+    float           stop;
+    float           step;
+    float           magnetic_field;
+    long            sweeps;
+    Rule            rule;
+    BurnIn          burn_in;
+    Sampling        sampling;
+    double          target;
+    double          *difficulties;
+    double          *energies;
+    double          *magnetisations;
+    double          *heat_capacities;
+    double          *susceptibilities;
+    double          *autocorrelations;
+    Telemetry       *telemetry;
+} ParametersND;
+
+
+/*
+ * parameters_task_ising_nd
+ * ------------------------
+ * Equilibrate a single run and measure it at every temperature. Up to a
+ * tenth of the measurement sweeps are spent settling at each new
+ * temperature.
+ *
+ * parameters
+ * ----------
+ * void *context: The ParametersND of the workflow.
+ * int task: The index of the run.
+ */
+static void parameters_task_ising_nd(void *context, int task)
+{
+    ParametersND *parameters = (ParametersND*) context;
+    long sites = parameters -> geometry -> sites;
+    long sweeps = parameters -> sweeps;
+    int length = parameters -> length;
+    float stop = parameters -> stop;
+    float step = parameters -> step;
+    Telemetry *telemetry = (parameters -> sampling.mode == PILOT_SAMPLING) ?
+        NULL : parameters -> telemetry;
+
+    reset_telemetry();
+    start_telemetry(BURN_IN_PHASE);
+    IsingND *system = init_ising_nd(parameters -> geometry, stop - step,
+        parameters -> magnetic_field);
+    set_rule_ising_nd(system, parameters -> rule);
+    burn_in_ising_nd(system, &parameters -> burn_in, sweeps * sites);
+
+    for (int temp = 0; temp < length; temp++)
+    {
+        float temperature = stop - (temp + 1) * step;
+        int index = task * length + temp;
+
+        start_telemetry(BURN_IN_PHASE);
+        set_temperature_ising_nd(system, temperature);
+        burn_in_ising_nd(system, &parameters -> burn_in, sweeps / 10 * sites);
+        start_telemetry(MEASUREMENT_PHASE);
+
+        Accumulator energies, magnetisations, squares;
+        Sampler sampler;
+        init_accumulator(&energies);
+        init_accumulator(&magnetisations);
+        init_accumulator(&squares);
+        init_sampler(&sampler, &parameters -> sampling, parameters -> target,
+            sweeps);
+
+        int done = 0;
+        while (!done)
+        {
+            evolve_ising_nd(system, sites);
+            double energy = energy_ising_nd(system);
+            double magnetisation = magnetisation_ising_nd(system);
+
+            add_accumulator(&energies, energy);
+            add_accumulator(&magnetisations, fabs(magnetisation));
+            add_accumulator(&squares, magnetisation * magnetisation);
+            done = add_sampler(&sampler, energy, fabs(magnetisation));
+        }
+
+        double absolute = mean_accumulator(&magnetisations);
+        parameters -> energies[index] = mean_accumulator(&energies);
+        parameters -> magnetisations[index] = absolute;
+        parameters -> heat_capacities[index] =
+            variance_accumulator(&energies) / temperature / temperature;
+        parameters -> susceptibilities[index] =
+            (mean_accumulator(&squares) - absolute * absolute) / temperature;
+        parameters -> autocorrelations[index] =
+            autocorrelation_blocking(&sampler.energies);
+        parameters -> difficulties[index] = difficulty_sampler(&sampler);
+
+        char point[192];
+        snprintf(point, sizeof(point),
+            "\"geometry\": \"%s\", \"run\": %i, \"temperature\": %.4f, "
+            "\"samples\": %li, \"relative_error\": %.6g",
+            name_shape(parameters -> geometry -> shape), task, temperature,
+            count_sampler(&sampler), error_sampler(&sampler));
+        record_telemetry(telemetry, point);
+    }
+
+    free_ising_nd(system);
+}
+
+
+/*
+ * physical_parameters_ising_nd
+ * ----------------------------
+ * Compute the energy, absolute magnetisation, heat capacity and
+ * susceptibility per spin against temperature on any of the lattices of
+ * geometry_ising_nd, for instance the simple cubic lattice or a
+ * triangular or non-square rectangular one. Independent runs are shared
+ * between the threads by the task runner and the errors are the spread
+ * of the runs.
+ *
+ * The optional keys are `magnetic_field` (zero), `sweeps` (1000
+ * measurements at each temperature), `runs` (5), `rule` and
+ * `output_format`, along with the telemetry keys of config_telemetry,
+ * the burn-in keys of read_burn_in and the sampling keys of
+ * read_sampling.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration file detailing the simulation.
+ */
+void physical_parameters_ising_nd(Config *config)
+{
+    char *save_file_name = find(config, "save_file");
+    float start = atof(find(config, "lowest_temperature"));
+    float stop = atof(find(config, "highest_temperature"));
+    float step = atof(find(config, "temperature_step"));
+    float magnetic_field = atof(find_default(config, "magnetic_field", "0"));
+    long sweeps = atol(find_default(config, "sweeps", "1000"));
+    int runs = atoi(find_default(config, "runs", "5"));
+    Rule rule = parse_rule(find_default(config, "rule", "metropolis"));
+    OutputFormat format = parse_output_format(find_default(config, "output_format", "csv"));
+    Geometry *geometry = geometry_ising_nd(config);
+
+    int length = (int) ((stop - start) / step);
+    double number = geometry -> sites;
+
+    ParametersND parameters;
+    parameters.geometry = geometry;
+    parameters.length = length;
+    parameters.stop = stop;
+    parameters.step = step;
+    parameters.magnetic_field = magnetic_field;
+    parameters.sweeps = sweeps;
+    parameters.rule = rule;
+    parameters.burn_in = read_burn_in(config);
+    parameters.sampling = read_sampling(config);
+    parameters.target = parameters.sampling.precision * sqrt(runs);
+    parameters.difficulties = (double*) calloc(runs * length, sizeof(double));
+    parameters.energies = (double*) calloc(runs * length, sizeof(double));
+    parameters.magnetisations = (double*) calloc(runs * length, sizeof(double));
+    parameters.heat_capacities = (double*) calloc(runs * length, sizeof(double));
+    parameters.susceptibilities = (double*) calloc(runs * length, sizeof(double));
+    parameters.autocorrelations = (double*) calloc(runs * length, sizeof(double));
+    parameters.telemetry = config_telemetry(config, save_file_name,
+        "physical_parameters_ising_nd", runs * length);
+
+    double costs[runs];
+    for (int run = 0; run < runs; run++)
+    {
+        costs[run] = (double) sweeps * number * (length + 1);
+    }
+
+    run_sampling(parameters_task_ising_nd, &parameters, runs, costs,
+        &parameters.sampling, &parameters.target, parameters.difficulties,
+        runs * length);
+    start_telemetry(IO_PHASE);
+
+    const char *names[] = {"Temperature",
+        "Energy", "Energy Error",
+        "Magnetisation", "Magnetisation Error",
+        "Heat Capacity", "Heat Capacity Error",
+        "Susceptibility", "Susceptibility Error",
+        "Autocorrelation Time"};
+    int num_names = sizeof(names) / sizeof(char*);
+    double *sources[] = {parameters.energies, parameters.magnetisations,
+        parameters.heat_capacities, parameters.susceptibilities};
+    double rows[length][num_names];
+
+    for (int temp = 0; temp < length; temp++)
+    {
+        rows[temp][0] = stop - (temp + 1) * step;
+
+        for (int source = 0; source < 4; source++)
+        {
+            double _values[runs];
+            for (int run = 0; run < runs; run++)
+            {
+                _values[run] = sources[source][run * length + temp];
+            }
+
+            double estimate = mean(_values, runs);
+            rows[temp][1 + 2 * source] = estimate / number;
+            rows[temp][2 + 2 * source] =
+                sqrt(variance(_values, estimate, runs) / runs) / number;
+        }
+
+        double _autocorrelations[runs];
+        for (int run = 0; run < runs; run++)
+        {
+            _autocorrelations[run] = parameters.autocorrelations[run * length + temp];
+        }
+
+        rows[temp][num_names - 1] = mean(_autocorrelations, runs);
+    }
+
+    if (format == COLUMNS_OUTPUT)
+    {
+        Columns *columns = init_columns(num_names, names);
+
+        for (int temp = 0; temp < length; temp++)
+        {
+            add_row_columns(columns, rows[temp]);
+        }
+
+        save_columns(columns, save_file_name);
+        free_columns(columns);
+    }
+    else
+    {
+        FILE *data = fopen(save_file_name, "w");
+
+        if (data == NULL)
+        {
+            printf("Error: Could not open '%s'", save_file_name);
+            exit(1);
+        }
+
+        for (int name = 0; name < num_names; name++)
+        {
+            fprintf(data, (name + 1 < num_names) ? "%s, " : "%s\n", names[name]);
+        }
+
+        for (int temp = 0; temp < length; temp++)
+        {
+            for (int name = 0; name < num_names; name++)
+            {
+                fprintf(data, (name + 1 < num_names) ? "%f, " : "%f\n", rows[temp][name]);
+            }
+        }
+
+        fclose(data);
+    }
+
+    free(parameters.energies);
+    free(parameters.magnetisations);
+    free(parameters.heat_capacities);
+    free(parameters.susceptibilities);
+    free(parameters.autocorrelations);
+    free(parameters.difficulties);
+    free_geometry(geometry);
+    close_telemetry(parameters.telemetry);
+}
@@ -0,0 +1,85 @@
+import numpy as np
+
+
+_HEADER = np.dtype([
+    ("magic", "S8"),
+    ("version", "<u4"),
+    ("header_size", "<u4"),
+    ("columns", "<u4"),
+    ("descriptor_size", "<u4"),
+    ("rows", "<u8"),
+    ("size", "<u8"),
+    ("padding", "<u8", (3,))
+])
+
+_DESCRIPTOR = np.dtype([
+    ("name", "S40"),
+    ("series", "<u4"),
+    ("reserved", "<u4"),
+    ("rows", "<u8"),
+    ("offset", "<u8")
+])
+
+
+def read_columns(file_name: str) -> tuple:
+    """
+    Map a columnar results file written by the simulation. The columns
+    are views of the file so nothing is read until it is used.
+
+    parameters
+    ----------
+    file_name: str
+        The results file to read.
+
+    returns
+    -------
+    table: dict
+        The columns of the table by name, in the order they were written.
+    series: dict
+        The raw time series by name, in the order they were written.
+    """
+    data = np.memmap(file_name, dtype=np.uint8, mode="r")
+    header = data[:_HEADER.itemsize].view(_HEADER)[0]
+
+    if header["magic"] != b"ISINGCOL" or header["version"] != 1:
+        raise ValueError(f"{file_name} is not a columns file of version 1")
+
+    start = int(header["header_size"])
+    end = start + int(header["columns"]) * _DESCRIPTOR.itemsize
+    descriptors = data[start:end].view(_DESCRIPTOR)
+    table = {}
+    series = {}
+
+    for descriptor in descriptors:
+        offset = int(descriptor["offset"])
+        rows = int(descriptor["rows"])
+        column = data[offset:offset + 8 * rows].view("<f8")
+        name = descriptor["name"].decode()
+        (series if descriptor["series"] else table)[name] = column
+
+    return table, series
+
+
+def load_table(file_name: str, header: bool = True) -> np.ndarray:
+    """
+    Load the table of a results file as a two dimensional array with a
+    row per line. Both the columnar files and the csv files are
+    understood.
+
+    parameters
+    ----------
+    file_name: str
+        The results file to read, `.cols` or `.csv`.
+    header: bool = True
+        True if the csv file starts with a line of column names.
+
+    returns
+    -------
+    table: np.ndarray
+        The values with shape (rows, columns).
+    """
+    if file_name.endswith(".cols"):
+        table, _ = read_columns(file_name)
+        return np.column_stack(list(table.values()))
+
+    return np.loadtxt(file_name, delimiter=",", skiprows=int(header), ndmin=2)
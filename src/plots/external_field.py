@@ -2,6 +2,8 @@ import sys
 import numpy as np
 import matplotlib as mpl
 import matplotlib.pyplot as plt 
+from trajectory import Trajectory
+from columns import load_table
 
 mpl.rcParams["text.usetex"] = True
 
@@ -159,10 +161,7 @@ def physical_parameters(data_file: str, show: bool, save_file: str = None) -> No
     save_file: str
         The location to save the plots to. 
     """
-    with open(f"pub/data/{data_file}") as parameters:
-        headers = next(parameters)
-        data = [[float(i) for i in line.strip().split(",")] for line in parameters]
-        data = np.array(data)
+    data = load_table(f"pub/data/{data_file}")
 
     def _energy(temperature: float, magnetic_field: float) -> float:
         return - magnetic_field * np.tanh(magnetic_field / temperature)
@@ -267,8 +266,10 @@ def antiferromagnet(data_file: str, show: bool, save_file: str) -> None:
     save_file: str
         The location to save the plots to. 
     """
-    with open(f"pub/data/{data_file}") as data:
-        systems, epsilons, temperatures, magnetic_fields = _parse_ising_system(data)
+    systems = Trajectory(f"pub/data/{data_file}")
+    epsilons = systems.epsilons
+    temperatures = systems.temperatures
+    magnetic_fields = systems.magnetic_fields
 
     import matplotlib
     import matplotlib.pyplot as plt
@@ -307,10 +308,7 @@ def heat_capacity(data_file: str, show: bool, save_file: str) -> None:
     save_file: str
         The location to save the plots to. 
     """
-    with open(f"pub/data/{data_file}") as parameters:
-        headers = next(parameters)
-        data = [[float(i) for i in line.strip().split(",")] for line in parameters]
-        data = np.array(data)
+    data = load_table(f"pub/data/{data_file}")
 
     fig = plt.figure()
     axes = plt.axes()
@@ -325,20 +323,20 @@ def heat_capacity(data_file: str, show: bool, save_file: str) -> None:
         fig.savefig(f"pub/figures/{save_file}")    
 
 
-def main(mode: str) -> None:
+def main(mode: str, extension: str = "csv") -> None:
     if mode == "snapshots":
         save_files = ["external_field_epsilon_minus_one.pdf", 
             "external_field_epsilon_zero.pdf", "external_field_epsilon_one.pdf"]
         snapshots("external_field.txt", True, save_files)
 
     elif mode == "physical_parameters":
-        physical_parameters("external_field.csv", True, "physical_parameters_external_field.pdf")
+        physical_parameters(f"external_field.{extension}", True, "physical_parameters_external_field.pdf")
 
     elif mode == "antiferromagnet":
-        antiferromagnet("antiferromagnet.txt", True, None)
+        antiferromagnet("antiferromagnet.traj", True, None)
 
     elif mode == "heat_capacity":
         heat_capacity("heat_capacity.csv", True, "heat_capacity_external_field.pdf")
 
 option = sys.argv[1]
-main(option)
+main(option, *sys.argv[2:3])
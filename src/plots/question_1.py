@@ -2,6 +2,7 @@ import numpy as np
 import matplotlib.pyplot as plt
 import matplotlib as mpl 
 import sys
+from columns import load_table
 
 
 mpl.rcParams["text.usetex"] = True
@@ -66,11 +67,7 @@ def physical_parameters(data_file: str, show: bool, save_file: str) -> None:
     save_file: str
         The location to save the plot as a pdf. 
     """
-    with open(f"pub/data/{data_file}") as physical_parameters:
-        next(physical_parameters)
-        data = np.array([
-            [float(entry) for entry in line.strip().split(",")] 
-            for line in physical_parameters])
+    data = load_table(f"pub/data/{data_file}")
 
     def energy(temperature: float) -> float:
        return - np.tanh(1 / temperature)
@@ -127,11 +124,7 @@ def magnetisation(data_file: str, show: bool, save_file: str) -> None:
     save_file: str
         The file to save the figure to. 
     """
-    with open(f"pub/data/{data_file}") as frequencies:
-        next(frequencies)
-        data = np.array([
-            [float(entry) for entry in line.strip().split(",")] 
-            for line in frequencies])
+    data = load_table(f"pub/data/{data_file}")
 
     figure, axes = plt.subplots(2, 3, figsize=(12, 8), sharex=True)
     for temp in range(3):
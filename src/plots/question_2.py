@@ -4,6 +4,8 @@ import typing as tp
 import matplotlib as mpl
 import collections
 import sys
+from trajectory import Trajectory
+from columns import load_table
 
 mpl.rcParams['text.usetex'] = True
 
@@ -90,25 +92,9 @@ def first_and_last(data_file: str, show: bool, save_file: str = None) -> None:
     save_file: str = None
         The name of the file to save the image in. 
     """
-    with open(f"pub/data/{data_file}") as images_file:
-        image = []
-        images = []
-        temperatures = []
-        for line in images_file:
-            if line.strip().startswith("#"):
-                temperature = []
-                for char in line.strip():
-                    if char.isnumeric() or char == '.':
-                        temperature.append(char)
-                temperatures.append(float("".join(temperature)))
-                if image:
-                    images.append(image)
-                    image = []
-            else:
-                image.append([int(entry) for entry in line.strip().split(",")])
-        if image:
-            images.append(image)
-    # TODO: Upgrade this to use the new functionality. 
+    trajectory = Trajectory(f"pub/data/{data_file}")
+    images = [trajectory[frame] for frame in range(len(trajectory))]
+    temperatures = trajectory.temperatures
 
     assert len(temperatures) == len(images)
     assert len(temperatures) % 2 == 0
@@ -146,11 +132,7 @@ def physical_parameters(data_file: str, show: bool, save_file: str = None) -> No
     save_file: str
         The file to save the image. 
     """
-    with open(f"pub/data/{data_file}") as phys_param:
-        next(phys_param)
-        data = [[float(entry) for entry in line.strip().split(",")] 
-            for line in phys_param]
-        data = np.array(data, dtype=float)
+    data = load_table(f"pub/data/{data_file}")
 
     temperature = data[:, 1]
     numbers = data[:, 0]
@@ -217,9 +199,7 @@ def magnetisation(data_file: str, show: bool, save_file: str = None) -> None:
     save_file: str
         The file to save the plot in.
     """
-    with open(f"pub/data/{data_file}") as mag_data:
-        data = np.array([[float(entry) for entry in line.strip().split(",")] 
-            for line in mag_data])
+    data = load_table(f"pub/data/{data_file}", header=False)
 
     numbers = data[:, 0]
     temperatures = data[:, 1]
@@ -285,4 +265,9 @@ def heating_and_cooling(data_file: str, show: bool, save_file: str = None) -> No
 
 
 option = sys.argv[1]
-exec(f"{option}('{option}_ising_2d.csv', True, '{option}_ising_2d.pdf')")
+extension = "traj" if option == "first_and_last" else "csv"
+if len(sys.argv) > 2:
+    extension = sys.argv[2].lstrip(".")
+    if not extension.isalnum():
+        raise ValueError(f"{sys.argv[2]} is not a file extension, e.g. cols")
+exec(f"{option}('{option}_ising_2d.{extension}', True, '{option}_ising_2d.pdf')")
@@ -0,0 +1,134 @@
+import numpy as np
+
+
+_HEADER = np.dtype([
+    ("magic", "S8"),
+    ("version", "<u4"),
+    ("header_size", "<u4"),
+    ("length", "<u4"),
+    ("words", "<u4"),
+    ("keyframe_interval", "<u4"),
+    ("reserved", "<u4"),
+    ("frames", "<u8"),
+    ("index_offset", "<u8"),
+    ("padding", "<u8", (2,))
+])
+
+_FRAME = np.dtype([
+    ("size", "<u4"),
+    ("keyframe", "<u4"),
+    ("temperature", "<f4"),
+    ("epsilon", "<f4"),
+    ("magnetic_field", "<f4"),
+    ("reserved", "<u4"),
+    ("steps", "<u8")
+])
+
+
+class Trajectory:
+    """
+    A trajectory file written by the simulation, mapped into memory.
+    Frames can be read in any order, only the frames back to the nearest
+    keyframe are decoded and reading forwards decodes each frame once.
+
+    parameters
+    ----------
+    file_name: str
+        The trajectory to read.
+    """
+    def __init__(self, file_name: str) -> None:
+        self.data = np.memmap(file_name, dtype=np.uint8, mode="r")
+        self.header = self.data[:_HEADER.itemsize].view(_HEADER)[0]
+
+        if self.header["magic"] != b"ISINGTRJ" or self.header["version"] != 2:
+            raise ValueError(f"{file_name} is not a trajectory of version 2")
+
+        self.length = int(self.header["length"])
+        self.words = int(self.header["words"])
+        self.keyframe_interval = int(self.header["keyframe_interval"])
+        index = int(self.header["index_offset"])
+        self.offsets = self.data[index:].view("<u8")
+        self.frames = np.array([self._frame(i) for i in range(len(self))])
+        self._decoded = -1
+        self._spins = np.zeros(self.length * self.words, dtype="<u8")
+
+    def __len__(self) -> int:
+        return int(self.header["frames"])
+
+    def _frame(self, frame: int) -> np.void:
+        offset = int(self.offsets[frame])
+        return self.data[offset:offset + _FRAME.itemsize].view(_FRAME)[0]
+
+    @property
+    def temperatures(self) -> np.ndarray:
+        return self.frames["temperature"]
+
+    @property
+    def epsilons(self) -> np.ndarray:
+        return self.frames["epsilon"]
+
+    @property
+    def magnetic_fields(self) -> np.ndarray:
+        return self.frames["magnetic_field"]
+
+    @property
+    def steps(self) -> np.ndarray:
+        return self.frames["steps"]
+
+    def _decode(self, frame: int) -> None:
+        offset = int(self.offsets[frame]) + _FRAME.itemsize
+        payload = self.data[offset:offset + int(self.frames[frame]["size"])]
+        cursor = 0
+        word = 0
+
+        def varint() -> int:
+            nonlocal cursor
+            value = shift = 0
+            while True:
+                byte = int(payload[cursor])
+                cursor += 1
+                value |= (byte & 0x7f) << shift
+                shift += 7
+                if not byte & 0x80:
+                    return value
+
+        if self.frames[frame]["keyframe"]:
+            self._spins[:] = 0
+
+        while word < self._spins.size:
+            word += varint()
+            literals = varint()
+            if literals:
+                end = cursor + 8 * literals
+                self._spins[word:word + literals] ^= payload[cursor:end].view("<u8")
+                cursor = end
+                word += literals
+
+    def __getitem__(self, frame: int) -> np.ndarray:
+        """
+        Decode a frame.
+
+        parameters
+        ----------
+        frame: int
+            The index of the frame, negative indices count from the end.
+
+        returns
+        -------
+        spins: np.ndarray
+            The spins as a (length, length) array of +1 and -1.
+        """
+        frame = range(len(self))[frame]
+        keyframe = frame - frame % self.keyframe_interval
+        start = keyframe
+
+        if keyframe <= self._decoded <= frame:
+            start = self._decoded + 1
+
+        for step in range(start, frame + 1):
+            self._decode(step)
+
+        self._decoded = frame
+        bits = np.unpackbits(self._spins.view(np.uint8), bitorder="little")
+        bits = bits.reshape(self.length, 64 * self.words)[:, :self.length]
+        return 2 * bits.astype(int) - 1
@@ -0,0 +1,1010 @@
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include"include/reweighting.h"
+
+// The number of sampled standard deviations the mean aligned bonds or
+// magnetisation may move before a reweighted estimate is unreliable.
+#define RELIABLE_HISTOGRAM 1.
+
+// The reliable range is searched for between the sampled temperature
+// divided and multiplied by this factor, and within this many sampled
+// temperatures of the sampled field.
+#define SEARCH_HISTOGRAM 4.
+
+// Temperatures this close to a sampled one, relative to it, count as the
+// sampled one since the sampled temperatures are often stored as floats.
+#define SAMPLED_HISTOGRAM 1e-6
+
+// The number of bisections used to find each edge of the reliable range.
+#define BISECTIONS_HISTOGRAM 50
+
+// The histogram files are text with one line per bin in these columns.
+#define HEADER_HISTOGRAM "temperature, magnetic_field, epsilon, bonds, sites, " \
+    "run, inefficiency, aligned, magnetisation, count"
+
+
+/*
+ * init_histogram
+ * --------------
+ * Start an empty histogram.
+ *
+ * parameters
+ * ----------
+ * Histogram *histogram: The histogram to start.
+ * double temperature: The temperature the samples will be taken at.
+ * double magnetic_field: The field the samples will be taken in.
+ * double epsilon: The coupling coefficient of the system.
+ * long bonds: The number of bonds of the lattice.
+ * long sites: The number of spins of the lattice.
+ */
+void init_histogram(
+    Histogram *histogram,
+    double temperature,
+    double magnetic_field,
+    double epsilon,
+    long bonds,
+    long sites)
+{
+    histogram -> temperature = temperature;
+    histogram -> magnetic_field = magnetic_field;
+    histogram -> epsilon = epsilon;
+    histogram -> bonds = bonds;
+    histogram -> sites = sites;
+    histogram -> run = 0;
+    histogram -> inefficiency = 1;
+    histogram -> samples = 0;
+    histogram -> capacity = 1024;
+    histogram -> keys = (long*) malloc(histogram -> capacity * sizeof(long));
+    histogram -> bins = 0;
+    histogram -> aligned = NULL;
+    histogram -> magnetisations = NULL;
+    histogram -> counts = NULL;
+}
+
+
+/*
+ * add_histogram
+ * -------------
+ * Add a sample of the system to the histogram.
+ *
+ * parameters
+ * ----------
+ * Histogram *histogram: The histogram, which must not be finished.
+ * long aligned: The number of bonds joining parallel spins.
+ * long magnetisation: The sum of the spins.
+ */
+void add_histogram(Histogram *histogram, long aligned, long magnetisation)
+{
+    if (histogram -> samples == histogram -> capacity)
+    {
+        histogram -> capacity *= 2;
+        histogram -> keys = (long*) realloc(histogram -> keys,
+            histogram -> capacity * sizeof(long));
+    }
+
+    long width = 2 * histogram -> sites + 1;
+    histogram -> keys[histogram -> samples++] =
+        aligned * width + magnetisation + histogram -> sites;
+}
+
+
+/*
+ * compare_histogram
+ * -----------------
+ * Order two packed samples for qsort.
+ *
+ * parameters
+ * ----------
+ * const void *first: The first key.
+ * const void *second: The second key.
+ *
+ * returns
+ * -------
+ * int order: Negative, zero or positive as the first key is smaller,
+ *      equal or larger.
+ */
+static int compare_histogram(const void *first, const void *second)
+{
+    long a = *(const long*) first;
+    long b = *(const long*) second;
+    return (a > b) - (a < b);
+}
+
+
+/*
+ * moments_histogram
+ * -----------------
+ * Find the mean and standard deviation of the aligned bonds and of the
+ * magnetisation of the samples from the bins.
+ *
+ * parameters
+ * ----------
+ * Histogram *histogram: The histogram, whose bins are made.
+ */
+static void moments_histogram(Histogram *histogram)
+{
+    double sums[4] = {0, 0, 0, 0};
+
+    for (long bin = 0; bin < histogram -> bins; bin++)
+    {
+        double count = histogram -> counts[bin];
+        double aligned = histogram -> aligned[bin];
+        double magnetisation = histogram -> magnetisations[bin];
+        sums[0] += count * aligned;
+        sums[1] += count * aligned * aligned;
+        sums[2] += count * magnetisation;
+        sums[3] += count * magnetisation * magnetisation;
+    }
+
+    for (int moment = 0; moment < 4; moment += 2)
+    {
+        double mean = sums[moment] / histogram -> samples;
+        double variance = sums[moment + 1] / histogram -> samples - mean * mean;
+        histogram -> moments[moment] = mean;
+        histogram -> moments[moment + 1] = sqrt(variance > 0 ? variance : 0);
+    }
+}
+
+
+/*
+ * finish_histogram
+ * ----------------
+ * Sort the samples into bins and find their moments. No samples can be
+ * added afterwards.
+ *
+ * parameters
+ * ----------
+ * Histogram *histogram: The histogram to finish.
+ */
+void finish_histogram(Histogram *histogram)
+{
+    long samples = histogram -> samples;
+    long width = 2 * histogram -> sites + 1;
+    long *keys = histogram -> keys;
+
+    if (samples == 0)
+    {
+        printf("Error: A histogram needs at least one sample!");
+        exit(1);
+    }
+
+    qsort(keys, samples, sizeof(long), compare_histogram);
+
+    long bins = 1;
+    for (long sample = 1; sample < samples; sample++)
+    {
+        bins += (keys[sample] != keys[sample - 1]);
+    }
+
+    histogram -> bins = bins;
+    histogram -> aligned = (long*) malloc(bins * sizeof(long));
+    histogram -> magnetisations = (long*) malloc(bins * sizeof(long));
+    histogram -> counts = (long*) calloc(bins, sizeof(long));
+
+    long bin = -1;
+
+    for (long sample = 0; sample < samples; sample++)
+    {
+        if ((sample == 0) || (keys[sample] != keys[sample - 1]))
+        {
+            bin++;
+            histogram -> aligned[bin] = keys[sample] / width;
+            histogram -> magnetisations[bin] =
+                keys[sample] % width - histogram -> sites;
+        }
+
+        histogram -> counts[bin]++;
+    }
+
+    moments_histogram(histogram);
+    free(keys);
+    histogram -> keys = NULL;
+}
+
+
+/*
+ * shift_histogram
+ * ---------------
+ * How far a mean has moved in standard deviations.
+ *
+ * parameters
+ * ----------
+ * double difference: The distance the mean moved.
+ * double spread: The sampled standard deviation.
+ *
+ * returns
+ * -------
+ * double shift: The distance over the spread, infinite if a series that
+ *      never varied has moved.
+ */
+static double shift_histogram(double difference, double spread)
+{
+    if (spread == 0)
+    {
+        return (fabs(difference) < 1e-9) ? 0 : INFINITY;
+    }
+
+    return fabs(difference) / spread;
+}
+
+
+/*
+ * reweight_histogram
+ * ------------------
+ * Estimate the observables at another temperature and field. Each bin
+ * is weighted by exp(-E' / T' + E / T), the ratio of its Boltzmann
+ * factors at the new and sampled parameters. The weights are summed in
+ * log space, relative to the largest, so that they cannot overflow
+ * however far the parameters move.
+ *
+ * parameters
+ * ----------
+ * const Histogram *histogram: The finished histogram.
+ * double temperature: The temperature to estimate the observables at.
+ * double magnetic_field: The field to estimate the observables in.
+ *
+ * returns
+ * -------
+ * Reweighted reweighted: The observables of the whole system.
+ */
+Reweighted reweight_histogram(
+    const Histogram *histogram,
+    double temperature,
+    double magnetic_field)
+{
+    double beta = 1. / histogram -> temperature;
+    double _beta = 1. / temperature;
+    double field = histogram -> magnetic_field;
+    long bins = histogram -> bins;
+    double *logs = (double*) malloc(bins * sizeof(double));
+    double largest = -INFINITY;
+
+    for (long bin = 0; bin < bins; bin++)
+    {
+        double interaction = - histogram -> epsilon *
+            (2. * histogram -> aligned[bin] - histogram -> bonds);
+        double magnetisation = histogram -> magnetisations[bin];
+
+        logs[bin] = log((double) histogram -> counts[bin]) -
+            (_beta - beta) * interaction -
+            (_beta * magnetic_field - beta * field) * magnetisation;
+        largest = (logs[bin] > largest) ? logs[bin] : largest;
+    }
+
+    double sums[7] = {0, 0, 0, 0, 0, 0, 0};
+
+    for (long bin = 0; bin < bins; bin++)
+    {
+        double weight = exp(logs[bin] - largest);
+        double aligned = histogram -> aligned[bin];
+        double magnetisation = histogram -> magnetisations[bin];
+        double energy = - histogram -> epsilon *
+            (2. * aligned - histogram -> bonds) + magnetic_field * magnetisation;
+
+        sums[0] += weight;
+        sums[1] += weight * energy;
+        sums[2] += weight * energy * energy;
+        sums[3] += weight * fabs(magnetisation);
+        sums[4] += weight * magnetisation * magnetisation;
+        sums[5] += weight * aligned;
+        sums[6] += weight * magnetisation;
+    }
+
+    free(logs);
+
+    for (int moment = 1; moment < 7; moment++)
+    {
+        sums[moment] /= sums[0];
+    }
+
+    Reweighted reweighted;
+    reweighted.energy = sums[1];
+    reweighted.magnetisation = sums[3];
+    reweighted.heat_capacity =
+        (sums[2] - sums[1] * sums[1]) / temperature / temperature;
+    reweighted.susceptibility = (sums[4] - sums[3] * sums[3]) / temperature;
+
+    double bonds = shift_histogram(sums[5] - histogram -> moments[0],
+        histogram -> moments[1]);
+    double magnetisations = shift_histogram(sums[6] - histogram -> moments[2],
+        histogram -> moments[3]);
+    reweighted.shift = (bonds > magnetisations) ? bonds : magnetisations;
+
+    return reweighted;
+}
+
+
+/*
+ * edge_histogram
+ * --------------
+ * Bisect for the edge of the reliable range along one parameter, the
+ * other being held at its sampled value.
+ *
+ * parameters
+ * ----------
+ * const Histogram *histogram: The finished histogram.
+ * double near: A reliable value of the parameter.
+ * double far: The furthest value to search to.
+ * int field: Whether the parameter is the field rather than the
+ *      temperature.
+ *
+ * returns
+ * -------
+ * double edge: The furthest reliable value, far if it is reliable.
+ */
+static double edge_histogram(
+    const Histogram *histogram,
+    double near,
+    double far,
+    int field)
+{
+    for (int bisection = 0; bisection <= BISECTIONS_HISTOGRAM; bisection++)
+    {
+        double middle = (bisection == 0) ? far : (near + far) / 2;
+        Reweighted reweighted = field ?
+            reweight_histogram(histogram, histogram -> temperature, middle) :
+            reweight_histogram(histogram, middle, histogram -> magnetic_field);
+
+        if (reweighted.shift <= RELIABLE_HISTOGRAM)
+        {
+            if (bisection == 0)
+            {
+                return far;
+            }
+
+            near = middle;
+        }
+        else
+        {
+            far = middle;
+        }
+    }
+
+    return near;
+}
+
+
+/*
+ * range_histogram
+ * ---------------
+ * Find the range of temperatures and fields a histogram can be reweighted
+ * to. A reweighted estimate is reliable while the mean aligned bonds and
+ * magnetisation stay within RELIABLE_HISTOGRAM sampled standard deviations
+ * of their sampled means, so that the states it is made of were actually
+ * visited. The temperatures are searched at the sampled field and the
+ * fields at the sampled temperature. A point away from both axes should
+ * be checked with the shift of its own estimate.
+ *
+ * parameters
+ * ----------
+ * const Histogram *histogram: The finished histogram.
+ * double *temperatures: Where the lowest and highest reliable temperatures
+ *      are stored.
+ * double *magnetic_fields: Where the lowest and highest reliable fields
+ *      are stored.
+ */
+void range_histogram(
+    const Histogram *histogram,
+    double *temperatures,
+    double *magnetic_fields)
+{
+    double temperature = histogram -> temperature;
+    double field = histogram -> magnetic_field;
+    double width = SEARCH_HISTOGRAM * temperature;
+
+    temperatures[0] = edge_histogram(histogram, temperature,
+        temperature / SEARCH_HISTOGRAM, 0);
+    temperatures[1] = edge_histogram(histogram, temperature,
+        temperature * SEARCH_HISTOGRAM, 0);
+    magnetic_fields[0] = edge_histogram(histogram, field, field - width, 1);
+    magnetic_fields[1] = edge_histogram(histogram, field, field + width, 1);
+}
+
+
+/*
+ * free_histogram
+ * --------------
+ * Free the memory of a histogram.
+ *
+ * parameters
+ * ----------
+ * Histogram *histogram: The histogram to free.
+ */
+void free_histogram(Histogram *histogram)
+{
+    free(histogram -> keys);
+    free(histogram -> aligned);
+    free(histogram -> magnetisations);
+    free(histogram -> counts);
+}
+
+
+/*
+ * save_histograms
+ * ---------------
+ * Write finished histograms to a text file with one line per bin, see
+ * HEADER_HISTOGRAM, so that they can be combined later by load_histograms
+ * and init_wham.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The file to write.
+ * const Histogram *histograms: The finished histograms.
+ * int number: The number of histograms.
+ */
+void save_histograms(
+    const char *file_name,
+    const Histogram *histograms,
+    int number)
+{
+    FILE *file = fopen(file_name, "w");
+
+    if (file == NULL)
+    {
+        printf("Error: Could not open '%s', for writing!", file_name);
+        exit(1);
+    }
+
+    fprintf(file, "%s\n", HEADER_HISTOGRAM);
+
+    for (int index = 0; index < number; index++)
+    {
+        const Histogram *histogram = &histograms[index];
+
+        for (long bin = 0; bin < histogram -> bins; bin++)
+        {
+            fprintf(file, "%.9g, %.9g, %.9g, %li, %li, %i, %.9g, %li, %li, %li\n",
+                histogram -> temperature, histogram -> magnetic_field,
+                histogram -> epsilon, histogram -> bonds, histogram -> sites,
+                histogram -> run, histogram -> inefficiency, histogram -> aligned[bin],
+                histogram -> magnetisations[bin], histogram -> counts[bin]);
+        }
+    }
+
+    fclose(file);
+}
+
+
+/*
+ * load_histograms
+ * ---------------
+ * Read the histograms written by save_histograms. A new histogram starts
+ * whenever the temperature, field, coupling, lattice or run of a line
+ * differs from the line before.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The file to read.
+ * int *number: Where the number of histograms is stored.
+ *
+ * returns
+ * -------
+ * Histogram *histograms: The finished histograms, each to be freed with
+ *      free_histogram and the array with free.
+ */
+Histogram *load_histograms(const char *file_name, int *number)
+{
+    FILE *file = fopen(file_name, "r");
+    char header[256];
+
+    if (file == NULL)
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    if (fgets(header, sizeof(header), file) == NULL)
+    {
+        printf("Error: '%s' is empty!", file_name);
+        exit(1);
+    }
+
+    int count = 0, capacity = 16;
+    long room = 0;
+    Histogram *histograms = (Histogram*) malloc(capacity * sizeof(Histogram));
+    Histogram *histogram = NULL;
+    Histogram line;
+    long aligned, magnetisation, samples;
+
+    while (fscanf(file, "%lf, %lf, %lf, %li, %li, %i, %lf, %li, %li, %li",
+        &line.temperature, &line.magnetic_field, &line.epsilon, &line.bonds,
+        &line.sites, &line.run, &line.inefficiency, &aligned, &magnetisation, 
+        &samples) == 10)
+    {
+        if ((histogram == NULL) ||
+            (line.temperature != histogram -> temperature) ||
+            (line.magnetic_field != histogram -> magnetic_field) ||
+            (line.epsilon != histogram -> epsilon) ||
+            (line.bonds != histogram -> bonds) ||
+            (line.sites != histogram -> sites) ||
+            (line.run != histogram -> run))
+        {
+            if (count == capacity)
+            {
+                capacity *= 2;
+                histograms = (Histogram*) realloc(histograms,
+                    capacity * sizeof(Histogram));
+            }
+
+            histogram = &histograms[count++];
+            init_histogram(histogram, line.temperature, line.magnetic_field,
+                line.epsilon, line.bonds, line.sites);
+            histogram -> run = line.run;
+            histogram -> inefficiency = line.inefficiency;
+            free(histogram -> keys);
+            histogram -> keys = NULL;
+            histogram -> capacity = 0;
+
+            room = 64;
+            histogram -> aligned = (long*) malloc(room * sizeof(long));
+            histogram -> magnetisations = (long*) malloc(room * sizeof(long));
+            histogram -> counts = (long*) malloc(room * sizeof(long));
+        }
+
+        if (histogram -> bins == room)
+        {
+            room *= 2;
+            histogram -> aligned = (long*) realloc(histogram -> aligned,
+                room * sizeof(long));
+            histogram -> magnetisations = (long*) realloc(
+                histogram -> magnetisations, room * sizeof(long));
+            histogram -> counts = (long*) realloc(histogram -> counts,
+                room * sizeof(long));
+        }
+
+        histogram -> aligned[histogram -> bins] = aligned;
+        histogram -> magnetisations[histogram -> bins] = magnetisation;
+        histogram -> counts[histogram -> bins++] = samples;
+        histogram -> samples += samples;
+    }
+
+    fclose(file);
+
+    if (count == 0)
+    {
+        printf("Error: '%s' holds no histograms!", file_name);
+        exit(1);
+    }
+
+    for (int index = 0; index < count; index++)
+    {
+        moments_histogram(&histograms[index]);
+    }
+
+    *number = count;
+    return histograms;
+}
+
+
+/*
+ * init_wham
+ * ---------
+ * Merge histograms into the bins of a multiple histogram analysis. The
+ * histograms of one run can be left out, which is how the jackknife
+ * errors of a sweep are found.
+ *
+ * parameters
+ * ----------
+ * Wham *wham: The analysis to start.
+ * const Histogram *histograms: The finished histograms, all of the same
+ *      lattice and coupling and in zero field.
+ * int number: The number of histograms.
+ * int skip: The run whose histograms are left out, or -1 to use all.
+ */
+void init_wham(
+    Wham *wham,
+    const Histogram *histograms,
+    int number,
+    int skip)
+{
+    const Histogram *first = NULL;
+
+    for (int index = 0; index < number; index++)
+    {
+        const Histogram *histogram = &histograms[index];
+
+        if (histogram -> run == skip)
+        {
+            continue;
+        }
+
+        first = (first == NULL) ? histogram : first;
+
+        if ((histogram -> epsilon != first -> epsilon) ||
+            (histogram -> bonds != first -> bonds) ||
+            (histogram -> sites != first -> sites))
+        {
+            printf("Error: The histograms are of different systems!");
+            exit(1);
+        }
+
+        if (histogram -> magnetic_field != 0)
+        {
+            printf("Error: The histograms must be in zero field!");
+            exit(1);
+        }
+    }
+
+    if (first == NULL)
+    {
+        printf("Error: There are no histograms to combine!");
+        exit(1);
+    }
+
+    long bonds = first -> bonds;
+    double *samples = (double*) calloc(number, sizeof(double));
+    double *moments = (double*) calloc(3 * number, sizeof(double));
+    double *counts = (double*) calloc(bonds + 1, sizeof(double));
+    double *absolutes = (double*) calloc(bonds + 1, sizeof(double));
+    double *squares = (double*) calloc(bonds + 1, sizeof(double));
+
+    wham -> epsilon = first -> epsilon;
+    wham -> bonds = bonds;
+    wham -> sites = first -> sites;
+    wham -> temperatures = 0;
+    wham -> betas = (double*) malloc(number * sizeof(double));
+
+    for (int index = 0; index < number; index++)
+    {
+        const Histogram *histogram = &histograms[index];
+        int temperature = 0;
+
+        if (histogram -> run == skip)
+        {
+            continue;
+        }
+
+        while ((temperature < wham -> temperatures) &&
+            (wham -> betas[temperature] != 1. / histogram -> temperature))
+        {
+            temperature++;
+        }
+
+        if (temperature == wham -> temperatures)
+        {
+            wham -> betas[wham -> temperatures++] = 1. / histogram -> temperature;
+        }
+
+        double inefficiency = (histogram -> inefficiency > 1) ? 
+            histogram -> inefficiency : 1;
+        samples[temperature] += histogram -> samples / inefficiency;
+
+        for (long bin = 0; bin < histogram -> bins; bin++)
+        {
+            double count = histogram -> counts[bin];
+            double magnetisation = histogram -> magnetisations[bin];
+            long aligned = histogram -> aligned[bin];
+            moments[3 * temperature] += count;
+            moments[3 * temperature + 1] += count * aligned;
+            moments[3 * temperature + 2] += count * aligned * aligned;
+
+            count /= inefficiency;
+            counts[aligned] += count;
+            absolutes[aligned] += count * fabs(magnetisation);
+            squares[aligned] += count * magnetisation * magnetisation;
+        }
+    }
+
+    int temperatures = wham -> temperatures;
+    wham -> log_samples = (double*) malloc(temperatures * sizeof(double));
+    wham -> free_energies = (double*) calloc(temperatures, sizeof(double));
+    wham -> means = (double*) malloc(temperatures * sizeof(double));
+    wham -> spreads = (double*) malloc(temperatures * sizeof(double));
+
+    for (int temperature = 0; temperature < temperatures; temperature++)
+    {
+        const double *sums = moments + 3 * temperature;
+        double mean = sums[1] / sums[0];
+        double variance = sums[2] / sums[0] - mean * mean;
+        wham -> log_samples[temperature] = log(samples[temperature]);
+        wham -> means[temperature] = mean;
+        wham -> spreads[temperature] = sqrt(variance > 0 ? variance : 0);
+    }
+
+    wham -> bins = 0;
+    for (long aligned = 0; aligned <= bonds; aligned++)
+    {
+        wham -> bins += (counts[aligned] > 0);
+    }
+
+    long bins = wham -> bins;
+    wham -> aligned = (long*) malloc(bins * sizeof(long));
+    wham -> energies = (double*) malloc(bins * sizeof(double));
+    wham -> log_counts = (double*) malloc(bins * sizeof(double));
+    wham -> log_states = (double*) malloc(bins * sizeof(double));
+    wham -> magnetisations = (double*) malloc(bins * sizeof(double));
+    wham -> squares = (double*) malloc(bins * sizeof(double));
+
+    long bin = 0;
+    for (long aligned = 0; aligned <= bonds; aligned++)
+    {
+        if (counts[aligned] > 0)
+        {
+            wham -> aligned[bin] = aligned;
+            wham -> energies[bin] = - wham -> epsilon * (2. * aligned - bonds);
+            wham -> log_counts[bin] = log(counts[aligned]);
+            wham -> magnetisations[bin] = absolutes[aligned] / counts[aligned];
+            wham -> squares[bin] = squares[aligned] / counts[aligned];
+            bin++;
+        }
+    }
+
+    free(samples);
+    free(moments);
+    free(counts);
+    free(absolutes);
+    free(squares);
+}
+
+
+/*
+ * solve_wham
+ * ----------
+ * Iterate the WHAM equations to self consistency,
+ *
+ *      ln g(E) = ln sum_k N_k(E) - ln sum_k n_k exp(f_k - E / T_k)
+ *      f_k = - ln sum_E g(E) exp(- E / T_k),
+ *
+ * where N_k(E) is the histogram and n_k the number of samples at the
+ * temperature T_k, both over the statistical inefficiency of the samples
+ * so that correlated runs count for no more than they are worth, see
+ * Chodera et al. J. Chem. Theory Comput. 3, 26 (2007). Every sum is
+ * taken in log space relative to its largest term. The bins are shared
+ * between the threads, and the free energies are fixed by setting the
+ * first to zero.
+ *
+ * parameters
+ * ----------
+ * Wham *wham: The analysis, whose free energies are used as the first
+ *      guess.
+ * double tolerance: The largest change of a free energy in an iteration
+ *      at which the equations count as solved.
+ * int limit: The most iterations to take.
+ *
+ * returns
+ * -------
+ * int iterations: The number of iterations taken.
+ */
+int solve_wham(Wham *wham, double tolerance, int limit)
+{
+    int temperatures = wham -> temperatures;
+    long bins = wham -> bins;
+    const double *betas = wham -> betas;
+    const double *energies = wham -> energies;
+    double *free_energies = wham -> free_energies;
+    double *log_states = wham -> log_states;
+    double *largest = (double*) malloc(temperatures * sizeof(double));
+    double *sums = (double*) malloc(temperatures * sizeof(double));
+
+    for (int iteration = 1; iteration <= limit; iteration++)
+    {
+        # pragma omp parallel for schedule(static)
+        for (long bin = 0; bin < bins; bin++)
+        {
+            double terms = -INFINITY, sum = 0;
+
+            for (int temperature = 0; temperature < temperatures; temperature++)
+            {
+                double term = wham -> log_samples[temperature] + 
+                    free_energies[temperature] - betas[temperature] * energies[bin];
+                terms = (term > terms) ? term : terms;
+            }
+
+            for (int temperature = 0; temperature < temperatures; temperature++)
+            {
+                sum += exp(wham -> log_samples[temperature] + 
+                    free_energies[temperature] - 
+                    betas[temperature] * energies[bin] - terms);
+            }
+
+            log_states[bin] = wham -> log_counts[bin] - terms - log(sum);
+        }
+
+        for (int temperature = 0; temperature < temperatures; temperature++)
+        {
+            largest[temperature] = -INFINITY;
+            sums[temperature] = 0;
+        }
+
+        # pragma omp parallel for schedule(static) \
+            reduction(max: largest[:temperatures])
+        for (long bin = 0; bin < bins; bin++)
+        {
+            for (int temperature = 0; temperature < temperatures; temperature++)
+            {
+                double term = log_states[bin] - betas[temperature] * energies[bin];
+                largest[temperature] = (term > largest[temperature]) ? 
+                    term : largest[temperature];
+            }
+        }
+
+        # pragma omp parallel for schedule(static) \
+            reduction(+: sums[:temperatures])
+        for (long bin = 0; bin < bins; bin++)
+        {
+            for (int temperature = 0; temperature < temperatures; temperature++)
+            {
+                sums[temperature] += exp(log_states[bin] - 
+                    betas[temperature] * energies[bin] - largest[temperature]);
+            }
+        }
+
+        double origin = - largest[0] - log(sums[0]);
+        double change = 0;
+
+        for (int temperature = 0; temperature < temperatures; temperature++)
+        {
+            double updated = - largest[temperature] - log(sums[temperature]) - 
+                origin;
+            double difference = fabs(updated - free_energies[temperature]);
+            change = (difference > change) ? difference : change;
+            free_energies[temperature] = updated;
+        }
+
+        if (change < tolerance)
+        {
+            free(largest);
+            free(sums);
+            return iteration;
+        }
+    }
+
+    printf("Error: The WHAM equations did not converge in %i iterations!", limit);
+    exit(1);
+}
+
+
+/*
+ * averages_wham
+ * -------------
+ * The canonical averages of the energy, absolute magnetisation and
+ * aligned bonds and of their squares at a temperature.
+ *
+ * parameters
+ * ----------
+ * const Wham *wham: The solved analysis.
+ * double temperature: The temperature to average at.
+ * double *averages: Where <E>, <E^2>, <|M|>, <M^2>, <a> and <a^2> are
+ *      stored.
+ */
+static void averages_wham(
+    const Wham *wham,
+    double temperature,
+    double *averages)
+{
+    double beta = 1. / temperature;
+    double largest = -INFINITY, total = 0;
+
+    for (long bin = 0; bin < wham -> bins; bin++)
+    {
+        double term = wham -> log_states[bin] - beta * wham -> energies[bin];
+        largest = (term > largest) ? term : largest;
+    }
+
+    for (int average = 0; average < 6; average++)
+    {
+        averages[average] = 0;
+    }
+
+    for (long bin = 0; bin < wham -> bins; bin++)
+    {
+        double weight = exp(wham -> log_states[bin] - 
+            beta * wham -> energies[bin] - largest);
+        double energy = wham -> energies[bin];
+        double aligned = wham -> aligned[bin];
+
+        total += weight;
+        averages[0] += weight * energy;
+        averages[1] += weight * energy * energy;
+        averages[2] += weight * wham -> magnetisations[bin];
+        averages[3] += weight * wham -> squares[bin];
+        averages[4] += weight * aligned;
+        averages[5] += weight * aligned * aligned;
+    }
+
+    for (int average = 0; average < 6; average++)
+    {
+        averages[average] /= total;
+    }
+}
+
+
+/*
+ * reweight_wham
+ * -------------
+ * Estimate the observables at a temperature from the density of states.
+ * Between the sampled temperatures the estimates are reliable as long as
+ * the neighbouring histograms overlap, so the shift is the distance
+ * between their mean aligned bonds in the sum of their standard
+ * deviations. Beyond them the shift is that of the mean aligned bonds
+ * from the nearest sampled temperature, in its standard deviations, as
+ * for a single histogram.
+ *
+ * parameters
+ * ----------
+ * const Wham *wham: The solved analysis.
+ * double temperature: The temperature to estimate the observables at.
+ *
+ * returns
+ * -------
+ * Reweighted reweighted: The observables of the whole system.
+ */
+Reweighted reweight_wham(const Wham *wham, double temperature)
+{
+    double averages[6];
+    averages_wham(wham, temperature, averages);
+
+    Reweighted reweighted;
+    reweighted.energy = averages[0];
+    reweighted.magnetisation = averages[2];
+    reweighted.heat_capacity = 
+        (averages[1] - averages[0] * averages[0]) / temperature / temperature;
+    reweighted.susceptibility = 
+        (averages[3] - averages[2] * averages[2]) / temperature;
+    reweighted.shift = 0;
+
+    // The nearest sampled temperatures below and above.
+    int below = -1, above = -1;
+    double lowest = INFINITY, highest = 0;
+    for (int sampled = 0; sampled < wham -> temperatures; sampled++)
+    {
+        double _temperature = 1. / wham -> betas[sampled];
+        lowest = (_temperature < lowest) ? _temperature : lowest;
+        highest = (_temperature > highest) ? _temperature : highest;
+
+        if ((_temperature <= temperature * (1 + SAMPLED_HISTOGRAM)) && ((below < 0) || 
+            (_temperature > 1. / wham -> betas[below])))
+        {
+            below = sampled;
+        }
+
+        if ((_temperature >= temperature * (1 - SAMPLED_HISTOGRAM)) && ((above < 0) || 
+            (_temperature < 1. / wham -> betas[above])))
+        {
+            above = sampled;
+        }
+    }
+
+    if ((below >= 0) && (above >= 0))
+    {
+        reweighted.shift = shift_histogram(
+            wham -> means[above] - wham -> means[below], 
+            wham -> spreads[below] + wham -> spreads[above]);
+    }
+    else
+    {
+        double edges[6];
+        averages_wham(wham, (temperature < lowest) ? lowest : highest, edges);
+        double variance = edges[5] - edges[4] * edges[4];
+        reweighted.shift = shift_histogram(averages[4] - edges[4], 
+            sqrt(variance > 0 ? variance : 0));
+    }
+
+    return reweighted;
+}
+
+
+/*
+ * free_wham
+ * ---------
+ * Free the memory of a multiple histogram analysis.
+ *
+ * parameters
+ * ----------
+ * Wham *wham: The analysis to free.
+ */
+void free_wham(Wham *wham)
+{
+    free(wham -> betas);
+    free(wham -> log_samples);
+    free(wham -> free_energies);
+    free(wham -> means);
+    free(wham -> spreads);
+    free(wham -> aligned);
+    free(wham -> energies);
+    free(wham -> log_counts);
+    free(wham -> log_states);
+    free(wham -> magnetisations);
+    free(wham -> squares);
+}
@@ -0,0 +1,201 @@
+#include<stdint.h>
+#include<string.h>
+#include"include/rng.h"
+
+
+/*
+ * master
+ * ------
+ * The generator from which every other stream is split. Splitting in the 
+ * same order always produces the same streams so a run is reproducible 
+ * from a single seed.
+ */
+static Random master = {{
+    0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL, 
+    0x94d049bb133111ebULL, 0x2545f4914f6cdd1dULL}};
+
+
+/*
+ * source
+ * ------
+ * The generator split_random draws from on this thread instead of the 
+ * master while a task is running. See bind_random.
+ */
+static _Thread_local Random *source = NULL;
+
+
+/*
+ * seed_random
+ * -----------
+ * Initialise a generator from a single number. The state is filled using 
+ * the splitmix64 generator as recommended by the authors of xoshiro.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to seed.
+ * uint64_t seed: Any number.
+ */
+void seed_random(Random *random, uint64_t seed)
+{
+    for (int word = 0; word < 4; word++)
+    {
+        uint64_t mixed = (seed += 0x9e3779b97f4a7c15ULL);
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+        random -> state[word] = mixed ^ (mixed >> 31);
+    }
+}
+
+
+/*
+ * polynomial_jump_random
+ * ----------------------
+ * Advance a generator by the number of steps encoded in a jump polynomial.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ * const uint64_t jump[4]: The jump polynomial.
+ */
+static void polynomial_jump_random(Random *random, const uint64_t jump[4])
+{
+    uint64_t state[4] = {0, 0, 0, 0};
+
+    for (int word = 0; word < 4; word++)
+    {
+        for (int bit = 0; bit < 64; bit++)
+        {
+            if (jump[word] & (1ULL << bit))
+            {
+                state[0] ^= random -> state[0];
+                state[1] ^= random -> state[1];
+                state[2] ^= random -> state[2];
+                state[3] ^= random -> state[3];
+            }
+            next_random(random);
+        }
+    }
+
+    memcpy(random -> state, state, sizeof(state));
+}
+
+
+/*
+ * jump_random
+ * -----------
+ * Advance a generator by 2^128 steps. This is equivalent to that many 
+ * calls to next_random.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ */
+void jump_random(Random *random)
+{
+    static const uint64_t jump[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    polynomial_jump_random(random, jump);
+}
+
+
+/*
+ * long_jump_random
+ * ----------------
+ * Advance a generator by 2^192 steps. Streams split from the master with 
+ * this jump can themselves be divided into 2^64 streams with jump_random 
+ * without ever overlapping.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to advance.
+ */
+void long_jump_random(Random *random)
+{
+    static const uint64_t jump[] = {
+        0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 
+        0x77710069854ee241ULL, 0x39109bb02acbe635ULL};
+    polynomial_jump_random(random, jump);
+}
+
+
+/*
+ * seed_master_random
+ * ------------------
+ * Seed the generator from which all other streams are split. 
+ *
+ * parameters
+ * ----------
+ * uint64_t seed: The seed of the whole run.
+ */
+void seed_master_random(uint64_t seed)
+{
+    seed_random(&master, seed);
+}
+
+
+/*
+ * bind_random
+ * -----------
+ * Make split_random on the calling thread draw from the given generator 
+ * rather than the master. A task that is bound to its own generator 
+ * creates the same systems whichever thread runs it and whenever it runs.
+ *
+ * parameters
+ * ----------
+ * Random *random: The generator to split from, or NULL to return to the 
+ *      master.
+ */
+void bind_random(Random *random)
+{
+    source = random;
+}
+
+
+/*
+ * split_random
+ * ------------
+ * Hand out the next independent stream of the master generator, or of 
+ * the generator bound to this thread.
+ *
+ * parameters
+ * ----------
+ * Random *child: The generator to initialise.
+ */
+void split_random(Random *child)
+{
+    if (source != NULL)
+    {
+        *child = *source;
+        long_jump_random(source);
+        return;
+    }
+
+    # pragma omp critical (split_random)
+    {
+        *child = master;
+        long_jump_random(&master);
+    }
+}
+
+
+/*
+ * split_streams_random
+ * --------------------
+ * Derive a number of independent streams from a generator. The parent 
+ * is advanced past all of the streams.
+ *
+ * parameters
+ * ----------
+ * Random *parent: The generator to split.
+ * Random *streams: The array of generators to initialise.
+ * int number: The number of streams.
+ */
+void split_streams_random(Random *parent, Random *streams, int number)
+{
+    for (int stream = 0; stream < number; stream++)
+    {
+        streams[stream] = *parent;
+        jump_random(parent);
+    }
+}
@@ -0,0 +1,176 @@
+#include<omp.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include"include/rng.h"
+#include"include/runner.h"
+
+
+/*
+ * Queue
+ * -----
+ * The tasks dealt to one thread. The owner takes tasks from the head, 
+ * which holds the most expensive, and idle threads steal from the tail.
+ *
+ * parameters
+ * ----------
+ * int *tasks: The indices of the tasks.
+ * int head: The next task for the owner.
+ * int tail: One past the last task left.
+ * omp_lock_t lock: Guards head and tail.
+ */
+typedef struct Queue
+{
+    int         *tasks;
+    int         head;
+    int         tail;
+    omp_lock_t  lock;
+} Queue;
+
+
+/*
+ * take_queue
+ * ----------
+ * Remove a task from either end of a queue.
+ *
+ * parameters
+ * ----------
+ * Queue *queue: The queue to take from.
+ * int steal: True to take from the tail rather than the head.
+ *
+ * returns
+ * -------
+ * int task: The index of the task, or -1 if the queue is empty.
+ */
+static int take_queue(Queue *queue, int steal)
+{
+    int task = -1;
+    omp_set_lock(&queue -> lock);
+
+    if (queue -> head < queue -> tail)
+    {
+        task = steal ? 
+            queue -> tasks[--queue -> tail] : queue -> tasks[queue -> head++];
+    }
+
+    omp_unset_lock(&queue -> lock);
+    return task;
+}
+
+
+/*
+ * run_tasks
+ * ---------
+ * Run a number of independent tasks on every available thread. The tasks 
+ * are sorted by cost and dealt, most expensive first, to the thread with 
+ * the least work so far. A thread that runs out of work steals the 
+ * cheapest remaining task of another thread, which evens out any error 
+ * in the costs. 
+ *
+ * Every task is bound to its own random stream, seeded in order before 
+ * any task starts, so the systems a task creates with split_random are 
+ * the same whichever thread runs it. As long as each task only writes 
+ * to its own results the outcome does not depend on the number of 
+ * threads.
+ *
+ * parameters
+ * ----------
+ * Task function: The work to perform for each task.
+ * void *context: The data passed to every task.
+ * int number: The number of tasks.
+ * const double *costs: The relative cost of each task, or NULL if they 
+ *      are all the same.
+ */
+void run_tasks(Task function, void *context, int number, const double *costs)
+{
+    int threads = omp_get_max_threads();
+    threads = (threads < number) ? threads : number;
+
+    if (threads < 1)
+    {
+        return;
+    }
+
+    Random parent;
+    Random *streams = (Random*) malloc(number * sizeof(Random));
+    int *order = (int*) malloc(number * sizeof(int));
+    double *loads = (double*) calloc(threads, sizeof(double));
+    Queue *queues = (Queue*) calloc(threads, sizeof(Queue));
+
+    split_random(&parent);
+
+    for (int task = 0; task < number; task++)
+    {
+        seed_random(&streams[task], next_random(&parent));
+        order[task] = task;
+    }
+
+    // Insertion sort by decreasing cost, keeping equal tasks in order.
+    for (int task = 1; task < number && costs != NULL; task++)
+    {
+        int current = order[task], place = task;
+
+        while ((place > 0) && (costs[order[place - 1]] < costs[current]))
+        {
+            order[place] = order[place - 1];
+            place--;
+        }
+
+        order[place] = current;
+    }
+
+    for (int thread = 0; thread < threads; thread++)
+    {
+        queues[thread].tasks = (int*) malloc(number * sizeof(int));
+        omp_init_lock(&queues[thread].lock);
+    }
+
+    for (int rank = 0; rank < number; rank++)
+    {
+        int task = order[rank], lightest = 0;
+
+        for (int thread = 1; thread < threads; thread++)
+        {
+            lightest = (loads[thread] < loads[lightest]) ? thread : lightest;
+        }
+
+        Queue *queue = &queues[lightest];
+        queue -> tasks[queue -> tail++] = task;
+        loads[lightest] += (costs != NULL) ? costs[task] : 1.;
+    }
+
+    # pragma omp parallel num_threads(threads)
+    {
+        int thread = omp_get_thread_num();
+
+        while (1)
+        {
+            int task = take_queue(&queues[thread], 0);
+
+            for (int victim = 1; (task < 0) && (victim < threads); victim++)
+            {
+                task = take_queue(&queues[(thread + victim) % threads], 1);
+            }
+
+            // No task is ever added so every queue is empty for good.
+            if (task < 0)
+            {
+                break;
+            }
+
+            bind_random(&streams[task]);
+            function(context, task);
+            bind_random(NULL);
+        }
+    }
+
+    for (int thread = 0; thread < threads; thread++)
+    {
+        omp_destroy_lock(&queues[thread].lock);
+        free(queues[thread].tasks);
+    }
+
+    free(queues);
+    free(loads);
+    free(order);
+    free(streams);
+}
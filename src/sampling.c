@@ -0,0 +1,464 @@
+#include<omp.h>
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include"include/toml.h"
+#include"include/accumulator.h"
+#include"include/analysis.h"
+#include"include/runner.h"
+#include"include/sampling.h"
+
+// The fewest measurements that give a trustworthy blocking analysis, and
+// the number every point takes in the pilot pass of a budget.
+#define MINIMUM_SAMPLING (8 * BLOCKING_MINIMUM)
+
+// The share of what is left of a budget after the pilot pass that the
+// measurements are planned to fill, leaving room for the burn-in and for
+// errors in the plan.
+#define PLANNED_SAMPLING 0.8
+
+
+/*
+ * parse_observables
+ * -----------------
+ * Convert a comma separated list of observables into a bit mask.
+ *
+ * parameters
+ * ----------
+ * const char *names: For example "energy,heat_capacity".
+ *
+ * returns
+ * -------
+ * int observables: The bit mask of the named Observables.
+ */
+static int parse_observables(const char *names)
+{
+    static const char *known[] = {"energy", "magnetisation",
+        "heat_capacity", "susceptibility"};
+    int observables = 0;
+
+    while (*names != '\0')
+    {
+        size_t length = strcspn(names, ",");
+        int found = 0;
+
+        for (int observable = 0; observable < 4; observable++)
+        {
+            if ((strlen(known[observable]) == length) &&
+                (strncmp(names, known[observable], length) == 0))
+            {
+                observables |= 1 << observable;
+                found = 1;
+            }
+        }
+
+        if (!found)
+        {
+            printf("Error: Unknown observable '%.*s'!", (int) length, names);
+            exit(1);
+        }
+
+        names += length + (names[length] == ',');
+    }
+
+    return observables;
+}
+
+
+/*
+ * read_sampling
+ * -------------
+ * Read the sampling options of a workflow. The optional `sampling` key
+ * is "fixed", the default, "precision" or "budget". A precision run
+ * measures each point until the relative error of every observable in
+ * `precision_observables` (default "energy,heat_capacity") is below
+ * `precision` (default 0.01). A budget run spends `budget` wall clock
+ * seconds on its measurements so that every point reaches the same error.
+ * Neither takes more than `sampling_limit` (default 100) times the fixed
+ * number of measurements at a point.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ *
+ * returns
+ * -------
+ * Sampling sampling: The sampling options.
+ */
+Sampling read_sampling(Config *config)
+{
+    const char *mode = find_default(config, "sampling", "fixed");
+    Sampling sampling;
+
+    if (strcmp(mode, "fixed") == 0)
+    {
+        sampling.mode = FIXED_SAMPLING;
+    }
+    else if (strcmp(mode, "precision") == 0)
+    {
+        sampling.mode = PRECISION_SAMPLING;
+    }
+    else if (strcmp(mode, "budget") == 0)
+    {
+        sampling.mode = BUDGET_SAMPLING;
+    }
+    else
+    {
+        printf("Error: Unknown sampling '%s'!", mode);
+        exit(1);
+    }
+
+    sampling.precision = atof(find_default(config, "precision", "0.01"));
+    sampling.budget = atof(find_default(config, "budget", "0"));
+    sampling.deadline = omp_get_wtime() + sampling.budget;
+    sampling.observables = parse_observables(
+        find_default(config, "precision_observables", "energy,heat_capacity"));
+    sampling.limit = atof(find_default(config, "sampling_limit", "100"));
+
+    if ((sampling.mode == PRECISION_SAMPLING) && (sampling.precision <= 0))
+    {
+        printf("Error: The precision must be positive!");
+        exit(1);
+    }
+
+    if ((sampling.mode == BUDGET_SAMPLING) && (sampling.budget <= 0))
+    {
+        printf("Error: A budget of wall clock seconds is needed!");
+        exit(1);
+    }
+
+    if (sampling.limit < 1)
+    {
+        printf("Error: The sampling limit must be at least one!");
+        exit(1);
+    }
+
+    return sampling;
+}
+
+
+/*
+ * target_sampling
+ * ---------------
+ * Plan the rest of a budget after its pilot pass. The error of a point
+ * falls as 1 / sqrt(time), so a point that reached a relative error e in
+ * t seconds needs e^2 t / target^2 seconds to reach the target. Giving
+ * every point the same target is what makes the worst error smallest,
+ * and the target is the one whose total time fits in what is left.
+ *
+ * parameters
+ * ----------
+ * const Sampling *sampling: The options of the workflow.
+ * const double *difficulties: The e^2 t of every run at every point,
+ *      from difficulty_sampler.
+ * long points: The number of difficulties.
+ * int threads: The number of threads the runs are shared between.
+ *
+ * returns
+ * -------
+ * double target: The relative error each run should reach, or infinity
+ *      if the budget is already spent.
+ */
+double target_sampling(
+    const Sampling *sampling,
+    const double *difficulties,
+    long points,
+    int threads)
+{
+    double remaining = PLANNED_SAMPLING * (sampling -> deadline - omp_get_wtime());
+    double total = 0;
+
+    for (long point = 0; point < points; point++)
+    {
+        total += difficulties[point];
+    }
+
+    if (remaining <= 0)
+    {
+        return INFINITY;
+    }
+
+    return sqrt(total / (remaining * threads));
+}
+
+
+/*
+ * run_sampling
+ * ------------
+ * Run the tasks of a workflow with its sampling. A budget first runs
+ * every task in the pilot mode, which takes a few measurements at each
+ * point and stores how hard it was, and then plans the target of the
+ * real pass with target_sampling. The tasks should not record telemetry
+ * or keep time series in the pilot mode.
+ *
+ * parameters
+ * ----------
+ * Task function: The work to perform for each task.
+ * void *context: The data passed to every task.
+ * int number: The number of tasks.
+ * const double *costs: The relative cost of each task, or NULL.
+ * Sampling *sampling: The options of the workflow, shared with the tasks.
+ * double *target: The relative error each run should reach, shared with
+ *      the tasks and replaced by the plan of a budget.
+ * const double *difficulties: Where the tasks store the difficulty of
+ *      each run at each point.
+ * long points: The number of difficulties.
+ */
+void run_sampling(
+    Task function,
+    void *context,
+    int number,
+    const double *costs,
+    Sampling *sampling,
+    double *target,
+    const double *difficulties,
+    long points)
+{
+    if (sampling -> mode == BUDGET_SAMPLING)
+    {
+        int threads = omp_get_max_threads();
+        threads = (threads < number) ? threads : number;
+
+        sampling -> mode = PILOT_SAMPLING;
+        run_tasks(function, context, number, costs);
+        sampling -> mode = BUDGET_SAMPLING;
+        *target = target_sampling(sampling, difficulties, points, threads);
+    }
+
+    run_tasks(function, context, number, costs);
+}
+
+
+/*
+ * init_sampler
+ * ------------
+ * Start measuring a run at a point.
+ *
+ * parameters
+ * ----------
+ * Sampler *sampler: The sampler to start.
+ * const Sampling *sampling: The options of the workflow.
+ * double target: The relative error the run should reach. The precision
+ *      of an average over runs is met when each run reaches precision *
+ *      sqrt(runs).
+ * long samples: The fixed number of measurements of the workflow.
+ */
+void init_sampler(
+    Sampler *sampler,
+    const Sampling *sampling,
+    double target,
+    long samples)
+{
+    long minimum = (samples < MINIMUM_SAMPLING) ? samples : MINIMUM_SAMPLING;
+    long maximum = (long) (samples * sampling -> limit);
+
+    sampler -> sampling = sampling;
+    sampler -> target = target;
+    sampler -> minimum = minimum;
+    sampler -> maximum = (maximum > minimum) ? maximum : minimum;
+    sampler -> check = minimum;
+    sampler -> started = omp_get_wtime();
+
+    if (sampling -> mode == FIXED_SAMPLING)
+    {
+        sampler -> minimum = sampler -> maximum = samples;
+    }
+    else if (sampling -> mode == PILOT_SAMPLING)
+    {
+        sampler -> minimum = sampler -> maximum = MINIMUM_SAMPLING;
+    }
+
+    init_blocking(&sampler -> energies);
+    init_blocking(&sampler -> magnetisations);
+}
+
+
+/*
+ * add_sampler
+ * -----------
+ * Add a measurement and decide whether the run has enough. The errors
+ * are tested at geometrically spaced counts, so the cost of the tests
+ * stays small next to the measurements.
+ *
+ * parameters
+ * ----------
+ * Sampler *sampler: The sampler of the run.
+ * double energy: The energy of the system.
+ * double magnetisation: The absolute magnetisation of the system.
+ *
+ * returns
+ * -------
+ * int done: Whether the run should stop measuring.
+ */
+int add_sampler(Sampler *sampler, double energy, double magnetisation)
+{
+    add_blocking(&sampler -> energies, energy);
+    add_blocking(&sampler -> magnetisations, magnetisation);
+    long count = count_sampler(sampler);
+
+    if (count < sampler -> minimum)
+    {
+        return 0;
+    }
+
+    if (count >= sampler -> maximum)
+    {
+        return 1;
+    }
+
+    if ((sampler -> sampling -> mode == BUDGET_SAMPLING) &&
+        (omp_get_wtime() > sampler -> sampling -> deadline))
+    {
+        return 1;
+    }
+
+    if (count < sampler -> check)
+    {
+        return 0;
+    }
+
+    sampler -> check = count + count / 4;
+    return error_sampler(sampler) <= sampler -> target;
+}
+
+
+/*
+ * count_sampler
+ * -------------
+ * The number of measurements a run has taken.
+ *
+ * parameters
+ * ----------
+ * const Sampler *sampler: The sampler of the run.
+ *
+ * returns
+ * -------
+ * long count: The number of measurements.
+ */
+long count_sampler(const Sampler *sampler)
+{
+    return sampler -> energies.accumulators[0].count;
+}
+
+
+/*
+ * relative_sampler
+ * ----------------
+ * The ratio of an error to the size of its value.
+ *
+ * parameters
+ * ----------
+ * double error: The error bar.
+ * double value: The value.
+ *
+ * returns
+ * -------
+ * double relative: The relative error, infinite for a non-zero error on
+ *      a zero value.
+ */
+static double relative_sampler(double error, double value)
+{
+    if (value == 0)
+    {
+        return (error == 0) ? 0 : INFINITY;
+    }
+
+    return error / fabs(value);
+}
+
+
+/*
+ * spread_sampler
+ * --------------
+ * The relative error of the variance of a series from its number of
+ * independent samples, sqrt((kurtosis + 2) / n_eff). A series that never
+ * varies has a variance of exactly zero.
+ *
+ * parameters
+ * ----------
+ * const Blocking *blocking: The analysis of the series.
+ *
+ * returns
+ * -------
+ * double relative: The relative error of the variance.
+ */
+static double spread_sampler(const Blocking *blocking)
+{
+    const Accumulator *samples = &blocking -> accumulators[0];
+
+    if (variance_accumulator(samples) <= 0)
+    {
+        return 0;
+    }
+
+    return sqrt((kurtosis_accumulator(samples) + 2) / effective_blocking(blocking));
+}
+
+
+/*
+ * error_sampler
+ * -------------
+ * The largest relative error of the observables that must reach the
+ * precision. The errors of the means are from the blocking analysis and
+ * those of the heat capacity and susceptibility from spread_sampler.
+ *
+ * parameters
+ * ----------
+ * const Sampler *sampler: The sampler of the run.
+ *
+ * returns
+ * -------
+ * double error: The largest relative error.
+ */
+double error_sampler(const Sampler *sampler)
+{
+    const Blocking *energies = &sampler -> energies;
+    const Blocking *magnetisations = &sampler -> magnetisations;
+    int observables = sampler -> sampling -> observables;
+    double errors[4] = {
+        relative_sampler(error_blocking(energies), mean_blocking(energies)),
+        relative_sampler(error_blocking(magnetisations), mean_blocking(magnetisations)),
+        spread_sampler(energies),
+        spread_sampler(magnetisations)};
+    double largest = 0;
+
+    for (int observable = 0; observable < 4; observable++)
+    {
+        if ((observables & (1 << observable)) && (errors[observable] > largest))
+        {
+            largest = errors[observable];
+        }
+    }
+
+    return largest;
+}
+
+
+/*
+ * difficulty_sampler
+ * ------------------
+ * How hard a point is to measure, the square of the error a run reached
+ * times the seconds it took, see target_sampling.
+ *
+ * parameters
+ * ----------
+ * const Sampler *sampler: The sampler of the run.
+ *
+ * returns
+ * -------
+ * double difficulty: The error squared times the seconds.
+ */
+double difficulty_sampler(const Sampler *sampler)
+{
+    double error = error_sampler(sampler);
+
+    // A point whose value is zero cannot reach a relative error and is
+    // left to the sampling limit rather than spoiling the plan.
+    if (!isfinite(error))
+    {
+        return 0;
+    }
+
+    return error * error * (omp_get_wtime() - sampler -> started);
+}
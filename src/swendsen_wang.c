@@ -0,0 +1,277 @@
+#include<omp.h>
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/external_field.h"
+#include"include/swendsen_wang.h"
+
+
+/*
+ * find_swendsen_wang
+ * ------------------
+ * Find the root of the cluster containing a site, halving the path on the 
+ * way. A parent is only ever replaced by one of its ancestors, so the 
+ * halving is safe while other threads are joining clusters.
+ *
+ * parameters
+ * ----------
+ * int *parents: The union-find forest.
+ * int site: The site to look up.
+ *
+ * returns
+ * -------
+ * int root: The smallest site in the cluster found so far.
+ */
+static inline int find_swendsen_wang(int *parents, int site)
+{
+    while (1)
+    {
+        int parent = __atomic_load_n(&parents[site], __ATOMIC_ACQUIRE);
+
+        if (parent == site)
+        {
+            return site;
+        }
+
+        int grandparent = __atomic_load_n(&parents[parent], __ATOMIC_ACQUIRE);
+
+        if (grandparent != parent)
+        {
+            __atomic_store_n(&parents[site], grandparent, __ATOMIC_RELEASE);
+        }
+
+        site = grandparent;
+    }
+}
+
+
+/*
+ * join_swendsen_wang
+ * ------------------
+ * Merge the clusters containing two sites. The larger root is linked below 
+ * the smaller with a compare and swap, which fails and is retried if 
+ * another thread has linked the larger root in the meantime.
+ *
+ * parameters
+ * ----------
+ * int *parents: The union-find forest.
+ * int first: A site in the first cluster.
+ * int second: A site in the second cluster.
+ */
+static inline void join_swendsen_wang(int *parents, int first, int second)
+{
+    while (1)
+    {
+        first = find_swendsen_wang(parents, first);
+        second = find_swendsen_wang(parents, second);
+
+        if (first == second)
+        {
+            return;
+        }
+
+        int larger = (first > second) ? first : second;
+        int smaller = (first > second) ? second : first;
+        int expected = larger;
+
+        if (__atomic_compare_exchange_n(&parents[larger], &expected, smaller, 
+                0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return;
+        }
+    }
+}
+
+
+/*
+ * init_swendsen_wang
+ * ------------------
+ * Allocate the workspace of the Swendsen-Wang algorithm for a system. The 
+ * row streams are split from the stream of the system.
+ *
+ * parameters
+ * ----------
+ * ising_t *system: The system the workspace will evolve.
+ *
+ * returns
+ * -------
+ * SwendsenWang *clusters: The workspace.
+ */
+SwendsenWang *init_swendsen_wang(ising_t *system)
+{
+    int length = system -> length;
+    SwendsenWang *clusters = (SwendsenWang*) calloc(1, sizeof(SwendsenWang));
+
+    clusters -> length = length;
+    clusters -> parents = (int*) malloc(((size_t) length * length + 1) * sizeof(int));
+    clusters -> streams = (Random*) malloc(length * sizeof(Random));
+
+    if ((clusters -> parents == NULL) || (clusters -> streams == NULL))
+    {
+        printf("Error: Could not allocate clusters of length %i", length);
+        exit(1);
+    }
+
+    split_streams_random(&system -> random, clusters -> streams, length);
+    build_thresholds_swendsen_wang(clusters, system);
+    return clusters;
+}
+
+
+/*
+ * free_swendsen_wang
+ * ------------------
+ * Release the memory occupied by the workspace.
+ *
+ * parameters
+ * ----------
+ * SwendsenWang *clusters: The workspace to free.
+ */
+void free_swendsen_wang(SwendsenWang *clusters)
+{
+    free(clusters -> parents);
+    free(clusters -> streams);
+    free(clusters);
+}
+
+
+/*
+ * build_thresholds_swendsen_wang
+ * ------------------------------
+ * Tabulate the probabilities of activating a satisfied bond, 
+ * 1 - exp(-2 |epsilon| / T), and of joining a site to the ghost spin, 
+ * 1 - exp(-2 |magnetic_field| / T).
+ *
+ * parameters
+ * ----------
+ * SwendsenWang *clusters: The workspace to modify.
+ * const ising_t *system: The system supplying the parameters.
+ */
+void build_thresholds_swendsen_wang(SwendsenWang *clusters, const ising_t *system)
+{
+    double temperature = system -> temperature;
+    double bond = 1. - exp(-2. * fabs(system -> epsilon) / temperature);
+    double field = 1. - exp(-2. * fabs(system -> magnetic_field) / temperature);
+
+    clusters -> bond_threshold = (uint64_t) (bond * 4294967296.);
+    clusters -> field_threshold = (uint64_t) (field * 4294967296.);
+    clusters -> temperature = system -> temperature;
+    clusters -> epsilon = system -> epsilon;
+    clusters -> magnetic_field = system -> magnetic_field;
+}
+
+
+/*
+ * sweep_swendsen_wang
+ * -------------------
+ * Perform one Swendsen-Wang update of the whole lattice. Each site draws 
+ * the bonds to its right and lower neighbours and to the ghost spin from 
+ * the stream of its row. Each cluster is then flipped if a hash of the 
+ * key of this update and the root of the cluster is odd, so every site of 
+ * a cluster reaches the same decision independently.
+ *
+ * parameters
+ * ----------
+ * SwendsenWang *clusters: The workspace of the algorithm.
+ * ising_t *system: The system to evolve.
+ */
+void sweep_swendsen_wang(SwendsenWang *clusters, ising_t *system)
+{
+    if ((clusters -> temperature != system -> temperature) ||
+        (clusters -> epsilon != system -> epsilon) ||
+        (clusters -> magnetic_field != system -> magnetic_field))
+    {
+        build_thresholds_swendsen_wang(clusters, system);
+    }
+
+    int length = system -> length;
+    int ghost = length * length;
+    int *parents = clusters -> parents;
+    Lattice *ensemble = system -> ensemble;
+    float epsilon = system -> epsilon;
+    float magnetic_field = system -> magnetic_field;
+    uint64_t bond_threshold = clusters -> bond_threshold;
+    uint64_t field_threshold = clusters -> field_threshold;
+    uint64_t key = next_random(&system -> random);
+    int magnetisation = 0, aligned = 0;
+    long flipped = 0;
+
+    # pragma omp parallel
+    {
+        # pragma omp for schedule(static)
+        for (int site = 0; site <= ghost; site++)
+        {
+            parents[site] = site;
+        }
+
+        # pragma omp for schedule(static)
+        for (int row = 0; row < length; row++)
+        {
+            Random *stream = clusters -> streams + row;
+            int below = ((row + 1) % length) * length;
+
+            for (int col = 0; col < length; col++)
+            {
+                int site = row * length + col;
+                int spin = spin_lattice(ensemble, row, col);
+                int right = spin * spin_lattice(ensemble, row, col + 1);
+                int lower = spin * spin_lattice(ensemble, row + 1, col);
+
+                if ((epsilon * right > 0) && 
+                    ((next_random(stream) >> 32) < bond_threshold))
+                {
+                    join_swendsen_wang(parents, site, 
+                        row * length + (col + 1) % length);
+                }
+
+                if ((epsilon * lower > 0) && 
+                    ((next_random(stream) >> 32) < bond_threshold))
+                {
+                    join_swendsen_wang(parents, site, below + col);
+                }
+
+                if ((magnetic_field * spin < 0) && 
+                    ((next_random(stream) >> 32) < field_threshold))
+                {
+                    join_swendsen_wang(parents, site, ghost);
+                }
+            }
+        }
+
+        int fixed = find_swendsen_wang(parents, ghost);
+
+        # pragma omp for schedule(static) reduction(+: flipped)
+        for (int row = 0; row < length; row++)
+        {
+            for (int col = 0; col < length; col++)
+            {
+                int root = find_swendsen_wang(parents, row * length + col);
+
+                if ((root != fixed) && (hash_random(key, root) >> 63))
+                {
+                    flipped++;
+                    flip_spin_lattice(ensemble, row, col);
+                }
+            }
+        }
+
+        # pragma omp for schedule(static) reduction(+: magnetisation, aligned)
+        for (int row = 0; row < length; row++)
+        {
+            for (int col = 0; col < length; col++)
+            {
+                int spin = spin_lattice(ensemble, row, col);
+                magnetisation += spin;
+                aligned += spin == spin_lattice(ensemble, row, col + 1);
+                aligned += spin == spin_lattice(ensemble, row + 1, col);
+            }
+        }
+    }
+
+    system -> magnetisation = magnetisation;
+    system -> aligned = aligned;
+    system -> accepted += flipped;
+}
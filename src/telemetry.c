@@ -0,0 +1,333 @@
+#include<omp.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<sys/resource.h>
+#include"include/toml.h"
+#include"include/telemetry.h"
+
+
+// The probe of the calling thread. Threads only touch their own probe
+// so none of the counting needs to be synchronised.
+static _Thread_local Probe probe_telemetry = {{0}, BURN_IN_PHASE, -1, 0, 0, 0};
+
+
+/*
+ * peak_memory_telemetry
+ * ---------------------
+ * The largest resident size the process has reached so far.
+ *
+ * returns
+ * -------
+ * long kilobytes: The peak resident set size in kilobytes.
+ */
+static long peak_memory_telemetry(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+
+/*
+ * open_telemetry
+ * --------------
+ * Start recording a workflow. The sidecar is the results file with its
+ * extension replaced by `.telemetry.jsonl`.
+ *
+ * parameters
+ * ----------
+ * const char *save_file: The results file of the workflow.
+ * const char *workflow: The name of the workflow.
+ * long points: The number of points that will be recorded, used to
+ *      estimate the time remaining.
+ * double progress_interval: The seconds between progress lines, zero
+ *      for none.
+ *
+ * returns
+ * -------
+ * Telemetry *telemetry: The open record.
+ */
+Telemetry *open_telemetry(
+    const char *save_file,
+    const char *workflow,
+    long points,
+    double progress_interval)
+{
+    const char *suffix = ".telemetry.jsonl";
+    const char *slash = strrchr(save_file, '/');
+    const char *dot = strrchr(save_file, '.');
+    size_t stem = ((dot != NULL) && ((slash == NULL) || (dot > slash))) ?
+        (size_t) (dot - save_file) : strlen(save_file);
+
+    char *file_name = (char*) malloc(stem + strlen(suffix) + 1);
+    memcpy(file_name, save_file, stem);
+    strcpy(file_name + stem, suffix);
+
+    Telemetry *telemetry = (Telemetry*) calloc(1, sizeof(Telemetry));
+    telemetry -> file = fopen(file_name, "w");
+
+    if (telemetry -> file == NULL)
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    free(file_name);
+    telemetry -> workflow = workflow;
+    telemetry -> points = points;
+    telemetry -> started = omp_get_wtime();
+    telemetry -> progress_interval = progress_interval;
+    telemetry -> progress = telemetry -> started;
+    reset_telemetry();
+    return telemetry;
+}
+
+
+/*
+ * config_telemetry
+ * ----------------
+ * Open the telemetry sidecar of a workflow unless the configuration sets 
+ * `telemetry = false`. The optional `progress_interval` key is the number 
+ * of seconds between progress lines, none are printed by default.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ * const char *save_file: The results file the sidecar is placed next to.
+ * const char *workflow: The name of the workflow.
+ * long points: The number of points the workflow will record.
+ *
+ * returns
+ * -------
+ * Telemetry *telemetry: The open record, or NULL if it is disabled.
+ */
+Telemetry *config_telemetry(
+    Config *config, 
+    const char *save_file, 
+    const char *workflow, 
+    long points)
+{
+    if (strcmp(find_default(config, "telemetry", "true"), "true") != 0)
+    {
+        return NULL;
+    }
+
+    double interval = atof(find_default(config, "progress_interval", "0"));
+    return open_telemetry(save_file, workflow, points, interval);
+}
+
+
+/*
+ * start_telemetry
+ * ---------------
+ * Start timing a phase on the calling thread, ending any phase that was
+ * already being timed.
+ *
+ * parameters
+ * ----------
+ * Phase phase: The phase that is starting.
+ */
+void start_telemetry(Phase phase)
+{
+    stop_telemetry();
+    probe_telemetry.phase = phase;
+    probe_telemetry.started = omp_get_wtime();
+}
+
+
+/*
+ * stop_telemetry
+ * --------------
+ * Stop timing the current phase of the calling thread.
+ */
+void stop_telemetry(void)
+{
+    if (probe_telemetry.started >= 0)
+    {
+        probe_telemetry.seconds[probe_telemetry.phase] +=
+            omp_get_wtime() - probe_telemetry.started;
+        probe_telemetry.started = -1;
+    }
+}
+
+
+/*
+ * count_telemetry
+ * ---------------
+ * Add to the flip counters of the calling thread.
+ *
+ * parameters
+ * ----------
+ * long attempted: The number of attempted spin flips.
+ * long accepted: The number of spins flipped.
+ */
+void count_telemetry(long attempted, long accepted)
+{
+    probe_telemetry.attempted += attempted;
+    probe_telemetry.accepted += accepted;
+}
+
+
+/*
+ * burn_in_telemetry
+ * -----------------
+ * Add to the burn-in length of the calling thread.
+ *
+ * parameters
+ * ----------
+ * double sweeps: The number of sweeps spent burning in.
+ */
+void burn_in_telemetry(double sweeps)
+{
+    probe_telemetry.burn_in += sweeps;
+}
+
+
+/*
+ * reset_telemetry
+ * ---------------
+ * Clear the probe of the calling thread.
+ */
+void reset_telemetry(void)
+{
+    memset(&probe_telemetry, 0, sizeof(Probe));
+    probe_telemetry.started = -1;
+}
+
+
+/*
+ * write_probe_telemetry
+ * ---------------------
+ * Write the timers and counters of a probe as json fields.
+ *
+ * parameters
+ * ----------
+ * FILE *file: The sidecar.
+ * const Probe *probe: The probe to write.
+ * double seconds: The time the flips took.
+ */
+static void write_probe_telemetry(FILE *file, const Probe *probe, double seconds)
+{
+    fprintf(file, "\"burn_in_seconds\": %.6f, ", probe -> seconds[BURN_IN_PHASE]);
+    fprintf(file, "\"measurement_seconds\": %.6f, ", probe -> seconds[MEASUREMENT_PHASE]);
+    fprintf(file, "\"io_seconds\": %.6f, ", probe -> seconds[IO_PHASE]);
+    fprintf(file, "\"attempted_flips\": %li, ", probe -> attempted);
+    fprintf(file, "\"accepted_flips\": %li, ", probe -> accepted);
+    fprintf(file, "\"burn_in_sweeps\": %.1f, ", probe -> burn_in);
+    fprintf(file, "\"acceptance_rate\": %.6f, ", (probe -> attempted > 0) ?
+        (double) probe -> accepted / probe -> attempted : 0.);
+    fprintf(file, "\"flips_per_second\": %.6g, ", (seconds > 0) ?
+        probe -> attempted / seconds : 0.);
+    fprintf(file, "\"peak_memory_kb\": %li", peak_memory_telemetry());
+}
+
+
+/*
+ * record_telemetry
+ * ----------------
+ * Write the probe of the calling thread as one point of the workflow,
+ * add it to the totals and clear it. A progress line is printed if one
+ * is due. Nothing is written if the telemetry is NULL.
+ *
+ * parameters
+ * ----------
+ * Telemetry *telemetry: The open record, or NULL.
+ * const char *point: The json fields that identify the point, such as
+ *      `"length": 10, "temperature": 2.2`.
+ */
+void record_telemetry(Telemetry *telemetry, const char *point)
+{
+    stop_telemetry();
+
+    if (telemetry == NULL)
+    {
+        reset_telemetry();
+        return;
+    }
+
+    Probe *probe = &probe_telemetry;
+    double seconds = probe -> seconds[BURN_IN_PHASE] +
+        probe -> seconds[MEASUREMENT_PHASE];
+
+    # pragma omp critical (telemetry)
+    {
+        fprintf(telemetry -> file, "{\"workflow\": \"%s\", %s, \"thread\": %i, ",
+            telemetry -> workflow, point, omp_get_thread_num());
+        write_probe_telemetry(telemetry -> file, probe, seconds);
+        fprintf(telemetry -> file, "}\n");
+        fflush(telemetry -> file);
+
+        for (int phase = 0; phase < NUM_PHASES; phase++)
+        {
+            telemetry -> totals.seconds[phase] += probe -> seconds[phase];
+        }
+
+        telemetry -> totals.attempted += probe -> attempted;
+        telemetry -> totals.accepted += probe -> accepted;
+        telemetry -> totals.burn_in += probe -> burn_in;
+        telemetry -> completed++;
+
+        double now = omp_get_wtime();
+        if ((telemetry -> progress_interval > 0) &&
+            (now - telemetry -> progress >= telemetry -> progress_interval))
+        {
+            double elapsed = now - telemetry -> started;
+            double remaining = elapsed / telemetry -> completed *
+                (telemetry -> points - telemetry -> completed);
+            printf("Progress: %li of %li points (%.1f%%), %.0fs elapsed, %.0fs remaining\n",
+                telemetry -> completed, telemetry -> points,
+                100. * telemetry -> completed / telemetry -> points,
+                elapsed, remaining);
+            fflush(stdout);
+            telemetry -> progress = now;
+        }
+    }
+
+    reset_telemetry();
+}
+
+
+/*
+ * close_telemetry
+ * ---------------
+ * Add whatever the calling thread has recorded since its last point,
+ * usually the output of the results, write the summary and close the
+ * sidecar. Nothing happens if the telemetry is NULL.
+ *
+ * parameters
+ * ----------
+ * Telemetry *telemetry: The open record, or NULL.
+ */
+void close_telemetry(Telemetry *telemetry)
+{
+    stop_telemetry();
+
+    if (telemetry == NULL)
+    {
+        return;
+    }
+
+    Probe *totals = &telemetry -> totals;
+    double wall = omp_get_wtime() - telemetry -> started;
+
+    for (int phase = 0; phase < NUM_PHASES; phase++)
+    {
+        totals -> seconds[phase] += probe_telemetry.seconds[phase];
+    }
+
+    totals -> attempted += probe_telemetry.attempted;
+    totals -> accepted += probe_telemetry.accepted;
+    totals -> burn_in += probe_telemetry.burn_in;
+    reset_telemetry();
+
+    fprintf(telemetry -> file, "{\"workflow\": \"%s\", \"summary\": true, ",
+        telemetry -> workflow);
+    fprintf(telemetry -> file, "\"points\": %li, \"threads\": %i, ",
+        telemetry -> completed, omp_get_max_threads());
+    fprintf(telemetry -> file, "\"wall_seconds\": %.6f, ", wall);
+    write_probe_telemetry(telemetry -> file, totals, wall);
+    fprintf(telemetry -> file, "}\n");
+    fclose(telemetry -> file);
+    free(telemetry);
+}
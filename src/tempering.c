@@ -0,0 +1,280 @@
+#include<omp.h>
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include"include/toml.h"
+#include"include/rng.h"
+#include"include/dynamics.h"
+#include"include/2d_ising.h"
+#include"include/tempering.h"
+#include"include/accumulator.h"
+
+
+/*
+ * init_tempering_2d
+ * -----------------
+ * Construct one replica per temperature. The replicas are created in 
+ * order so their streams do not depend on the scheduling of the threads.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of each replica.
+ * int replicas: The number of temperatures.
+ * const float *temperatures: The temperatures of the slots.
+ * Rule rule: The acceptance rule used to evolve the replicas.
+ *
+ * returns
+ * -------
+ * Tempering2D *tempering: The replicas with no exchanges attempted.
+ */
+Tempering2D *init_tempering_2d(int length, int replicas, 
+    const float *temperatures, Rule rule)
+{
+    Tempering2D *tempering = (Tempering2D*) calloc(1, sizeof(Tempering2D));
+    tempering -> replicas = replicas;
+    tempering -> temperatures = (float*) calloc(replicas, sizeof(float));
+    tempering -> systems = (Ising2D**) calloc(replicas, sizeof(Ising2D*));
+    tempering -> attempts = (long*) calloc(replicas, sizeof(long));
+    tempering -> accepts = (long*) calloc(replicas, sizeof(long));
+    split_random(&tempering -> random);
+
+    for (int slot = 0; slot < replicas; slot++)
+    {
+        tempering -> temperatures[slot] = temperatures[slot];
+        tempering -> systems[slot] = init_ising_2d(length, temperatures[slot]);
+        set_rule_ising_2d(tempering -> systems[slot], rule);
+    }
+
+    return tempering;
+}
+
+
+/*
+ * free_tempering_2d
+ * -----------------
+ * Release the memory occupied by the replicas.
+ *
+ * parameters
+ * ----------
+ * Tempering2D *tempering: The replicas to free.
+ */
+void free_tempering_2d(Tempering2D *tempering)
+{
+    for (int slot = 0; slot < tempering -> replicas; slot++)
+    {
+        free_ising_2d(tempering -> systems[slot]);
+    }
+
+    free(tempering -> temperatures);
+    free(tempering -> systems);
+    free(tempering -> attempts);
+    free(tempering -> accepts);
+    free(tempering);
+}
+
+
+/*
+ * evolve_tempering_2d
+ * -------------------
+ * Evolve every replica independently, sharing the replicas between 
+ * threads.
+ *
+ * parameters
+ * ----------
+ * Tempering2D *tempering: The replicas to evolve.
+ * long steps: The number of attempted spin flips for each replica.
+ * Engine2D engine: The algorithm to use.
+ */
+void evolve_tempering_2d(Tempering2D *tempering, long steps, Engine2D engine)
+{
+    # pragma omp parallel for schedule(dynamic)
+    for (int slot = 0; slot < tempering -> replicas; slot++)
+    {
+        evolve_ising_2d(tempering -> systems[slot], steps, engine);
+    }
+}
+
+
+/*
+ * exchange_tempering_2d
+ * ---------------------
+ * Attempt to exchange the replicas in neighbouring slots. Alternating the 
+ * parity between calls lets every pair be attempted while no replica takes 
+ * part in two exchanges at once. An exchange between temperatures T and T' 
+ * is accepted with probability min(1, exp((1 / T - 1 / T') (E - E'))).
+ *
+ * parameters
+ * ----------
+ * Tempering2D *tempering: The replicas to exchange.
+ * int parity: 0 to pair slots (0, 1), (2, 3), ... and 1 for (1, 2), ...
+ */
+void exchange_tempering_2d(Tempering2D *tempering, int parity)
+{
+    float *temperatures = tempering -> temperatures;
+    Ising2D **systems = tempering -> systems;
+
+    for (int slot = parity; slot < tempering -> replicas - 1; slot += 2)
+    {
+        double beta = 1. / temperatures[slot];
+        double next_beta = 1. / temperatures[slot + 1];
+        double energy = energy_ising_2d(systems[slot]);
+        double next_energy = energy_ising_2d(systems[slot + 1]);
+        double exponent = (beta - next_beta) * (energy - next_energy);
+
+        tempering -> attempts[slot]++;
+
+        if ((exponent >= 0) || 
+            (normalised_random(&tempering -> random) < exp(exponent)))
+        {
+            Ising2D *swap = systems[slot];
+            systems[slot] = systems[slot + 1];
+            systems[slot + 1] = swap;
+
+            set_temperature_ising_2d(systems[slot], temperatures[slot]);
+            set_temperature_ising_2d(systems[slot + 1], temperatures[slot + 1]);
+            tempering -> accepts[slot]++;
+        }
+    }
+}
+
+
+/*
+ * acceptance_tempering_2d
+ * -----------------------
+ * The fraction of accepted exchanges between a slot and the next.
+ *
+ * parameters
+ * ----------
+ * const Tempering2D *tempering: The replicas.
+ * int slot: The lower slot of the pair.
+ *
+ * returns
+ * -------
+ * float acceptance: The acceptance rate, or NAN if no exchange has been 
+ *      attempted.
+ */
+float acceptance_tempering_2d(const Tempering2D *tempering, int slot)
+{
+    if ((slot >= tempering -> replicas - 1) || (tempering -> attempts[slot] == 0))
+    {
+        return NAN;
+    }
+
+    return (float) tempering -> accepts[slot] / tempering -> attempts[slot];
+}
+
+
+/*
+ * tempering_ising_2d
+ * ------------------
+ * Measure the energy, magnetisation, heat capacity and susceptibility 
+ * across a temperature grid using replica exchange. One replica runs at 
+ * each temperature and neighbouring replicas attempt to exchange after 
+ * every `sweeps_per_swap` sweeps. The magnetisation is reported as <|M|> 
+ * because the replicas are free to change sign. The final column is the 
+ * rate at which exchanges with the next temperature were accepted.
+ *
+ * parameters
+ * ----------
+ * Config *config: The configuration of the simulation.
+ */
+void tempering_ising_2d(Config *config)
+{
+    int num_spins = atoi(find(config, "number_of_spins"));
+    char *save_file_name = find(config, "save_file");
+    float start = atof(find(config, "lowest_temperature"));
+    float stop = atof(find(config, "highest_temperature"));
+    float step = atof(find(config, "temperature_step"));
+    int sweeps_per_swap = atoi(find_default(config, "sweeps_per_swap", "1"));
+    int equilibration = atoi(find_default(config, "equilibration_swaps", "1000"));
+    int swaps = atoi(find_default(config, "measurement_swaps", "1000"));
+    Engine2D engine = engine_ising_2d(config);
+    Rule rule = rule_ising_2d(config);
+
+    int replicas = (int) ((stop - start) / step);
+    long interval = (long) sweeps_per_swap * num_spins * num_spins;
+    float number = num_spins * num_spins;
+
+    if ((replicas < 2) || (sweeps_per_swap < 1) || (swaps < 2))
+    {
+        printf("Error: Tempering needs at least two temperatures and swaps!");
+        exit(1);
+    }
+
+    float temperatures[replicas];
+    for (int slot = 0; slot < replicas; slot++)
+    {
+        temperatures[slot] = stop - (slot + 1) * step;
+    }
+
+    Tempering2D *tempering = init_tempering_2d(num_spins, replicas, 
+        temperatures, rule);
+
+    for (int swap = 0; swap < equilibration; swap++)
+    {
+        evolve_tempering_2d(tempering, interval, engine);
+        exchange_tempering_2d(tempering, swap % 2);
+    }
+
+    for (int slot = 0; slot < replicas; slot++)
+    {
+        tempering -> attempts[slot] = 0;
+        tempering -> accepts[slot] = 0;
+    }
+
+    Accumulator energies[replicas];
+    Accumulator magnetisations[replicas];
+
+    for (int slot = 0; slot < replicas; slot++)
+    {
+        init_accumulator(&energies[slot]);
+        init_accumulator(&magnetisations[slot]);
+    }
+
+    for (int swap = 0; swap < swaps; swap++)
+    {
+        evolve_tempering_2d(tempering, interval, engine);
+        exchange_tempering_2d(tempering, swap % 2);
+
+        for (int slot = 0; slot < replicas; slot++)
+        {
+            double magnetisation = magnetisation_ising_2d(tempering -> systems[slot]);
+            add_accumulator(&energies[slot], energy_ising_2d(tempering -> systems[slot]));
+            add_accumulator(&magnetisations[slot], fabs(magnetisation));
+        }
+    }
+
+    FILE *save_file = fopen(save_file_name, "w");
+
+    if (save_file == NULL)
+    {
+        printf("Error: Could not open '%s' for writing!", save_file_name);
+        exit(1);
+    }
+
+    fprintf(save_file, "Number, Temperature, ");
+    fprintf(save_file, "Energy, Energy Error, ");
+    fprintf(save_file, "Magnetisation, Magnetisation Error, ");
+    fprintf(save_file, "Heat Capacity, Susceptibility, Swap Acceptance\n");
+
+    for (int slot = 0; slot < replicas; slot++)
+    {
+        float temperature = temperatures[slot];
+        const Accumulator *energy = &energies[slot];
+        const Accumulator *magnetisation = &magnetisations[slot];
+
+        fprintf(save_file, "%i, %f, ", num_spins, temperature);
+        fprintf(save_file, "%f, ", mean_accumulator(energy) / number);
+        fprintf(save_file, "%f, ", error_accumulator(energy) / number);
+        fprintf(save_file, "%f, ", mean_accumulator(magnetisation) / number);
+        fprintf(save_file, "%f, ", error_accumulator(magnetisation) / number);
+        fprintf(save_file, "%f, ", variance_accumulator(energy) / 
+            temperature / temperature / number);
+        fprintf(save_file, "%f, ", variance_accumulator(magnetisation) / 
+            temperature / number);
+        fprintf(save_file, "%f\n", acceptance_tempering_2d(tempering, slot));
+    }
+
+    fclose(save_file);
+    free_tempering_2d(tempering);
+}
@@ -31,7 +31,7 @@ char *read(char *file_name)
     float numbytes = ftell(source); 
     fseek(source, 0, SEEK_SET); 
                                                                                    
-    char *text = (char*) calloc(numbytes, sizeof(char));                           
+    char *text = (char*) calloc(numbytes + 1, sizeof(char));                           
     int num_bytes = fread(text, sizeof(char), numbytes, source);                                   
     fclose(source); 
     return text;                                                                   
@@ -368,6 +368,35 @@ char *find(Config *config, char *key)
 }
 
 
+/*
+  *find_default
+  *------------
+  *Search the parsed toml file for an optional entry.
+ *
+  *parameters
+  *----------
+  *Config *config: The parsed toml file.
+  *char *key: The target field.
+  *char *fallback: The value to use if the field is missing.
+ *
+  *returns
+  *-------
+  *char *out: The value of the field or the fallback.
+ */
+char *find_default(Config *config, char *key, char *fallback)
+{
+    for (int pair = 0; pair < (config -> length); pair++)
+    {
+        Pair *inner = (config -> pairs)[pair];
+        if (strcmp((inner -> key), key) == 0) 
+        {
+            return inner -> value;
+        }
+    }
+    return fallback;
+}
+
+
 /*
   *init_config 
   *-----------
@@ -0,0 +1,497 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include"include/lattice.h"
+#include"include/trajectory.h"
+
+_Static_assert(sizeof(Trajectory) == 64, "The trajectory header must be 64 bytes");
+_Static_assert(sizeof(Frame) == 32, "The frame header must be 32 bytes");
+
+
+/*
+ * put_varint
+ * ----------
+ * Encode an unsigned integer seven bits at a time, least significant
+ * first, with the top bit of each byte set if more bytes follow.
+ *
+ * parameters
+ * ----------
+ * uint8_t *buffer: Where to write the encoding.
+ * uint64_t value: The integer to encode.
+ *
+ * returns
+ * -------
+ * size_t size: The number of bytes written, at most ten.
+ */
+static inline size_t put_varint(uint8_t *buffer, uint64_t value)
+{
+    size_t size = 0;
+
+    while (value >= 0x80)
+    {
+        buffer[size++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+
+    buffer[size++] = (uint8_t) value;
+    return size;
+}
+
+
+/*
+ * get_varint
+ * ----------
+ * Decode an integer written by put_varint.
+ *
+ * parameters
+ * ----------
+ * const uint8_t **cursor: The position to read from, moved past the
+ *      encoding.
+ *
+ * returns
+ * -------
+ * uint64_t value: The decoded integer.
+ */
+static inline uint64_t get_varint(const uint8_t **cursor)
+{
+    uint64_t value = 0;
+    int shift = 0;
+    uint8_t byte;
+
+    do
+    {
+        byte = *(*cursor)++;
+        value |= (uint64_t) (byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return value;
+}
+
+
+/*
+ * encode_trajectory
+ * -----------------
+ * Run length encode the XOR of two packed lattices.
+ *
+ * parameters
+ * ----------
+ * uint8_t *buffer: Where to write the encoding.
+ * const uint64_t *current: The packed spins of the frame.
+ * const uint64_t *previous: The packed spins to take the difference
+ *      with, or NULL for a keyframe.
+ * size_t number: The number of words in each lattice.
+ *
+ * returns
+ * -------
+ * size_t size: The number of bytes written.
+ */
+static size_t encode_trajectory(
+    uint8_t *buffer,
+    const uint64_t *current,
+    const uint64_t *previous,
+    size_t number)
+{
+    size_t size = 0;
+    size_t word = 0;
+
+    while (word < number)
+    {
+        size_t zeros = 0;
+        while ((word + zeros < number) &&
+            ((current[word + zeros] ^ (previous ? previous[word + zeros] : 0)) == 0))
+        {
+            zeros++;
+        }
+
+        word += zeros;
+
+        size_t literals = 0;
+        while ((word + literals < number) &&
+            ((current[word + literals] ^ (previous ? previous[word + literals] : 0)) != 0))
+        {
+            literals++;
+        }
+
+        size += put_varint(buffer + size, zeros);
+        size += put_varint(buffer + size, literals);
+
+        for (size_t literal = 0; literal < literals; literal++, word++)
+        {
+            uint64_t difference = current[word] ^ (previous ? previous[word] : 0);
+            memcpy(buffer + size, &difference, sizeof(uint64_t));
+            size += sizeof(uint64_t);
+        }
+    }
+
+    return size;
+}
+
+
+/*
+ * decode_trajectory
+ * -----------------
+ * Apply an encoded frame to a packed lattice, which should hold the
+ * previous frame or be empty for a keyframe.
+ *
+ * parameters
+ * ----------
+ * uint64_t *spins: The packed spins to update.
+ * const uint8_t *cursor: The start of the encoding.
+ * size_t number: The number of words in the lattice.
+ */
+static void decode_trajectory(uint64_t *spins, const uint8_t *cursor, size_t number)
+{
+    size_t word = 0;
+
+    while (word < number)
+    {
+        word += get_varint(&cursor);
+        size_t literals = get_varint(&cursor);
+
+        for (size_t literal = 0; literal < literals; literal++, word++)
+        {
+            uint64_t difference;
+            memcpy(&difference, cursor, sizeof(uint64_t));
+            spins[word] ^= difference;
+            cursor += sizeof(uint64_t);
+        }
+    }
+}
+
+
+/*
+ * open_trajectory
+ * ---------------
+ * Create a trajectory file for a lattice of a fixed size.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The file to create.
+ * int length: The number of spins along one side of the lattice.
+ * int keyframe_interval: The number of frames between keyframes. Longer
+ *      intervals give smaller files but slower random access.
+ *
+ * returns
+ * -------
+ * TrajectoryWriter *writer: The open trajectory. It must be finished
+ *      with close_trajectory.
+ */
+TrajectoryWriter *open_trajectory(
+    const char *file_name,
+    int length,
+    int keyframe_interval)
+{
+    TrajectoryWriter *writer = (TrajectoryWriter*) calloc(1, sizeof(TrajectoryWriter));
+    writer -> file = fopen(file_name, "wb");
+
+    if (writer -> file == NULL)
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    Trajectory *header = &writer -> header;
+    memcpy(header -> magic, TRAJECTORY_MAGIC, sizeof(header -> magic));
+    header -> version = TRAJECTORY_VERSION;
+    header -> header_size = sizeof(Trajectory);
+    header -> length = length;
+    header -> words = (length + 63) / 64;
+    header -> keyframe_interval = (keyframe_interval > 0) ? keyframe_interval : 1;
+
+    size_t number = (size_t) length * header -> words;
+    writer -> capacity = 64;
+    writer -> offsets = (uint64_t*) malloc(writer -> capacity * sizeof(uint64_t));
+    writer -> previous = (uint64_t*) calloc(number, sizeof(uint64_t));
+    writer -> current = (uint64_t*) calloc(number, sizeof(uint64_t));
+
+    // Each literal word costs at most eight bytes and each run at most
+    // twenty more, with never more runs than literal words.
+    writer -> buffer = (uint8_t*) malloc(number * 28 + 20);
+
+    fwrite(header, sizeof(Trajectory), 1, writer -> file);
+    writer -> offset = sizeof(Trajectory);
+    return writer;
+}
+
+
+/*
+ * write_frame_trajectory
+ * ----------------------
+ * Append the current state of a lattice to a trajectory. The frame is 
+ * padded to a multiple of eight bytes so that every frame header is 
+ * aligned once the file is mapped.
+ *
+ * parameters
+ * ----------
+ * TrajectoryWriter *writer: The open trajectory.
+ * const Lattice *lattice: The spins to store.
+ * const Frame *frame: The parameters of the system. The size and
+ *      keyframe fields are filled in by the writer.
+ */
+void write_frame_trajectory(
+    TrajectoryWriter *writer,
+    const Lattice *lattice,
+    const Frame *frame)
+{
+    Trajectory *header = &writer -> header;
+    size_t number = (size_t) header -> length * header -> words;
+    int keyframe = (header -> frames % header -> keyframe_interval) == 0;
+
+    if (lattice -> length != (int) header -> length)
+    {
+        printf("Error: Cannot add a lattice of length %i to a trajectory of %u",
+            lattice -> length, header -> length);
+        exit(1);
+    }
+
+    if (header -> frames == (uint64_t) writer -> capacity)
+    {
+        writer -> capacity *= 2;
+        writer -> offsets = (uint64_t*) realloc(writer -> offsets,
+            writer -> capacity * sizeof(uint64_t));
+    }
+
+    pack_lattice(lattice, writer -> current);
+
+    Frame record = *frame;
+    record.keyframe = keyframe;
+    record.reserved = 0;
+    record.size = encode_trajectory(writer -> buffer, writer -> current,
+        keyframe ? NULL : writer -> previous, number);
+
+    static const char zeros[8] = {0};
+    size_t padding = (8 - record.size % 8) % 8;
+    fwrite(&record, sizeof(Frame), 1, writer -> file);
+    fwrite(writer -> buffer, 1, record.size, writer -> file);
+    fwrite(zeros, 1, padding, writer -> file);
+
+    writer -> offsets[header -> frames++] = writer -> offset;
+    writer -> offset += sizeof(Frame) + record.size + padding;
+
+    uint64_t *swap = writer -> previous;
+    writer -> previous = writer -> current;
+    writer -> current = swap;
+}
+
+
+/*
+ * close_trajectory
+ * ----------------
+ * Write the frame index, complete the header and release the writer.
+ *
+ * parameters
+ * ----------
+ * TrajectoryWriter *writer: The open trajectory.
+ */
+void close_trajectory(TrajectoryWriter *writer)
+{
+    Trajectory *header = &writer -> header;
+
+    // The frames are padded so the index is aligned and can be used in 
+    // place once mapped.
+    header -> index_offset = writer -> offset;
+
+    fwrite(writer -> offsets, sizeof(uint64_t), header -> frames, writer -> file);
+    fseek(writer -> file, 0, SEEK_SET);
+    fwrite(header, sizeof(Trajectory), 1, writer -> file);
+
+    if (ferror(writer -> file) || fclose(writer -> file) != 0)
+    {
+        printf("Error: Could not write the trajectory");
+        exit(1);
+    }
+
+    free(writer -> offsets);
+    free(writer -> previous);
+    free(writer -> current);
+    free(writer -> buffer);
+    free(writer);
+}
+
+
+/*
+ * map_trajectory
+ * --------------
+ * Map a trajectory file into memory read only.
+ *
+ * parameters
+ * ----------
+ * const char *file_name: The trajectory to read.
+ *
+ * returns
+ * -------
+ * TrajectoryReader *reader: The mapped trajectory. It must be released
+ *      with unmap_trajectory.
+ */
+TrajectoryReader *map_trajectory(const char *file_name)
+{
+    int descriptor = open(file_name, O_RDONLY);
+    struct stat status;
+
+    if ((descriptor < 0) || (fstat(descriptor, &status) != 0))
+    {
+        printf("Error: Could not open '%s'", file_name);
+        exit(1);
+    }
+
+    if (status.st_size < (off_t) sizeof(Trajectory))
+    {
+        printf("Error: '%s' is too short to be a trajectory", file_name);
+        exit(1);
+    }
+
+    void *mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE,
+        descriptor, 0);
+    close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        printf("Error: Could not map '%s'", file_name);
+        exit(1);
+    }
+
+    const Trajectory *header = (const Trajectory*) mapping;
+
+    if ((memcmp(header -> magic, TRAJECTORY_MAGIC, sizeof(header -> magic)) != 0) ||
+        (header -> version != TRAJECTORY_VERSION) ||
+        (header -> header_size != sizeof(Trajectory)))
+    {
+        printf("Error: '%s' is not a trajectory of this version", file_name);
+        exit(1);
+    }
+
+    if (header -> index_offset + header -> frames * sizeof(uint64_t) !=
+        (uint64_t) status.st_size)
+    {
+        printf("Error: '%s' was not closed properly", file_name);
+        exit(1);
+    }
+
+    size_t number = (size_t) header -> length * header -> words;
+    TrajectoryReader *reader = (TrajectoryReader*) malloc(sizeof(TrajectoryReader));
+    reader -> header = header;
+    reader -> offsets = (const uint64_t*) ((const char*) mapping + header -> index_offset);
+    reader -> decoded = -1;
+    reader -> spins = (uint64_t*) calloc(number, sizeof(uint64_t));
+    return reader;
+}
+
+
+/*
+ * unmap_trajectory
+ * ----------------
+ * Release a trajectory mapped with map_trajectory.
+ *
+ * parameters
+ * ----------
+ * TrajectoryReader *reader: The mapped trajectory.
+ */
+void unmap_trajectory(TrajectoryReader *reader)
+{
+    const Trajectory *header = reader -> header;
+    munmap((void*) header, header -> index_offset + header -> frames * sizeof(uint64_t));
+    free(reader -> spins);
+    free(reader);
+}
+
+
+/*
+ * frame_trajectory
+ * ----------------
+ * Find the header of a frame.
+ *
+ * parameters
+ * ----------
+ * const TrajectoryReader *reader: The mapped trajectory.
+ * long frame: The index of the frame.
+ *
+ * returns
+ * -------
+ * const Frame *frame: The parameters of the system in that frame.
+ */
+const Frame *frame_trajectory(const TrajectoryReader *reader, long frame)
+{
+    if ((frame < 0) || ((uint64_t) frame >= reader -> header -> frames))
+    {
+        printf("Error: The trajectory has no frame %li", frame);
+        exit(1);
+    }
+
+    return (const Frame*) ((const char*) reader -> header + reader -> offsets[frame]);
+}
+
+
+/*
+ * read_frame_trajectory
+ * ---------------------
+ * Decode a frame, starting from the frame that was decoded last if it
+ * is on the way and from the nearest keyframe otherwise.
+ *
+ * parameters
+ * ----------
+ * TrajectoryReader *reader: The mapped trajectory.
+ * long frame: The index of the frame.
+ *
+ * returns
+ * -------
+ * const uint64_t *spins: The spins packed as by pack_lattice. They are
+ *      overwritten by the next read.
+ */
+const uint64_t *read_frame_trajectory(TrajectoryReader *reader, long frame)
+{
+    const Trajectory *header = reader -> header;
+    size_t number = (size_t) header -> length * header -> words;
+    long keyframe = frame - frame % header -> keyframe_interval;
+    long start = keyframe;
+
+    frame_trajectory(reader, frame);
+
+    if ((reader -> decoded >= keyframe) && (reader -> decoded <= frame))
+    {
+        start = reader -> decoded + 1;
+    }
+
+    for (long next = start; next <= frame; next++)
+    {
+        const Frame *record = frame_trajectory(reader, next);
+
+        if (record -> keyframe)
+        {
+            memset(reader -> spins, 0, number * sizeof(uint64_t));
+        }
+
+        decode_trajectory(reader -> spins, (const uint8_t*) (record + 1), number);
+    }
+
+    reader -> decoded = frame;
+    return reader -> spins;
+}
+
+
+/*
+ * read_lattice_trajectory
+ * -----------------------
+ * Decode a frame into a lattice of the same size.
+ *
+ * parameters
+ * ----------
+ * TrajectoryReader *reader: The mapped trajectory.
+ * long frame: The index of the frame.
+ * Lattice *lattice: The lattice to overwrite.
+ */
+void read_lattice_trajectory(TrajectoryReader *reader, long frame, Lattice *lattice)
+{
+    if (lattice -> length != (int) reader -> header -> length)
+    {
+        printf("Error: The trajectory has length %u not %i",
+            reader -> header -> length, lattice -> length);
+        exit(1);
+    }
+
+    unpack_lattice(lattice, read_frame_trajectory(reader, frame));
+}
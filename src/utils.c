@@ -4,60 +4,6 @@
 #include"include/utils.h"
 
 
-/*
- * random
- * ------
- * Generate a random number over the range [0, 1].
- *
- * returns
- * -------
- * float: random number.
- */
-float normalised_random(void)
-{ 
-    return (float) rand() / ((float) RAND_MAX);
-}
-
-
-/* 
- * random_sign
- * -----------
- * Generate + or - 1 randomly.
- *
- * returns
- * -------
- * int: +1 or -1 randomly.
- */ 
-int random_spin(void) 
-{
-    float normed_random = normalised_random();
-    float translated_random = normed_random - .5;
-    return (int) ((translated_random > 0) - (translated_random < 0));
-}
-
-
-/*
- * random_index
- * ------------
- * Generate a random index in the correct range.
- * 
- * parameters
- * ----------
- * int length: The length of the array that is getting indexed. 
- *
- * returns
- * -------
- * int rand_ind: A random index in the range [0, length]
- */
-int random_index(int length)
-{
-    float norm_rand = normalised_random();
-    float range_rand = (int) (norm_rand * length);
-    if (range_rand == length) range_rand -= 1;
-    return range_rand;
-}
-
-
 /*
  * mean
  * ----
@@ -65,16 +11,16 @@ int random_index(int length)
  *
  * parameters
  * ----------
- * float* array: The sample of values.
+ * double* array: The sample of values.
  * int length: The number of values in the sample.
  * 
  * returns
  * -------
- * float* mean: The geometric mean of the sample. 
+ * double mean: The geometric mean of the sample. 
  */
-float mean(float *array, int length) 
+double mean(double *array, int length) 
 {
-    float mean = 0;
+    double mean = 0;
     for (int entry = 0; entry < length; entry++)
     {
         mean += array[entry];
@@ -92,17 +38,17 @@ float mean(float *array, int length)
  *
  * parameters
  * ----------
- * float* array: The sample.
- * float mean: The mean of the sample.
+ * double* array: The sample.
+ * double mean: The mean of the sample.
  * int length: The number of values in the sample.
  *
  * returns 
  * -------
- * float var: The variance of the sample. 
+ * double var: The variance of the sample. 
  */
-float variance(float* array, float mean, int length)
+double variance(double* array, double mean, int length)
 {
-    float variance = 0;
+    double variance = 0;
     for (int entry = 0; entry < length; entry++)
     {
         variance += (array[entry] - mean) * (array[entry] - mean);
@@ -0,0 +1,250 @@
+#include<math.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/2d_ising.h"
+#include"include/wolff.h"
+
+// The number of clusters grown at a new temperature to estimate the mean
+// cluster size before the clusters of an update are counted out.
+#define PILOT_WOLFF 32
+
+
+/*
+ * init_wolff_2d
+ * -------------
+ * Allocate the workspace of the Wolff algorithm for a lattice.
+ *
+ * parameters
+ * ----------
+ * int length: The number of spins along one side of the lattice.
+ *
+ * returns
+ * -------
+ * Wolff2D *cluster: The workspace with empty estimators.
+ */
+Wolff2D *init_wolff_2d(int length)
+{
+    Wolff2D *cluster = (Wolff2D*) calloc(1, sizeof(Wolff2D));
+    cluster -> length = length;
+    cluster -> stack = (int*) malloc(2 * (size_t) length * length * sizeof(int));
+
+    if (cluster -> stack == NULL)
+    {
+        printf("Error: Could not allocate a cluster of length %i", length);
+        exit(1);
+    }
+
+    build_threshold_wolff_2d(cluster, INFINITY);
+    return cluster;
+}
+
+
+/*
+ * free_wolff_2d
+ * -------------
+ * Release the memory occupied by the workspace of the Wolff algorithm.
+ *
+ * parameters
+ * ----------
+ * Wolff2D *cluster: The workspace to free.
+ */
+void free_wolff_2d(Wolff2D *cluster)
+{
+    free(cluster -> stack);
+    free(cluster);
+}
+
+
+/*
+ * build_threshold_wolff_2d
+ * ------------------------
+ * Tabulate the probability, 1 - exp(-2 / T), of adding an aligned 
+ * neighbour to the cluster.
+ *
+ * parameters
+ * ----------
+ * Wolff2D *cluster: The workspace to modify.
+ * float temperature: The temperature of the system.
+ */
+void build_threshold_wolff_2d(Wolff2D *cluster, float temperature)
+{
+    double probability = 1. - exp(-2. / temperature);
+    cluster -> threshold = (uint64_t) (probability * 4294967296.);
+    cluster -> temperature = temperature;
+    cluster -> grown = 0;
+    cluster -> flipped = 0;
+}
+
+
+/*
+ * cluster_wolff_2d
+ * ----------------
+ * Grow a single cluster from a random seed and flip it. Sites are flipped 
+ * as they join the cluster, so a site that has already joined no longer 
+ * matches the seed and is never examined twice. This means no visited 
+ * array has to be cleared between clusters and the running totals of the 
+ * system can be updated one site at a time.
+ *
+ * parameters
+ * ----------
+ * Wolff2D *cluster: The workspace of the algorithm.
+ * Ising2D *system: The system to evolve.
+ *
+ * returns
+ * -------
+ * long size: The number of spins that were flipped.
+ */
+long cluster_wolff_2d(Wolff2D *cluster, Ising2D *system)
+{
+    if (cluster -> temperature != system -> temperature)
+    {
+        build_threshold_wolff_2d(cluster, system -> temperature);
+    }
+
+    int length = system -> length;
+    uint64_t threshold = cluster -> threshold;
+    int *stack = cluster -> stack;
+    Random *random = &system -> random;
+    Lattice *ensemble = system -> ensemble;
+
+    int row = random_index(random, length);
+    int col = random_index(random, length);
+    int seed = spin_lattice(ensemble, row, col);
+    long size = 1, top = 0;
+
+    flip_spin_ising_2d(system, row, col);
+    stack[top++] = row;
+    stack[top++] = col;
+
+    while (top > 0)
+    {
+        col = stack[--top];
+        row = stack[--top];
+
+        int rows[4] = {
+            (row == 0) ? length - 1 : row - 1,
+            (row == length - 1) ? 0 : row + 1,
+            row, 
+            row
+        };
+        int cols[4] = {
+            col, 
+            col,
+            (col == 0) ? length - 1 : col - 1,
+            (col == length - 1) ? 0 : col + 1
+        };
+
+        for (int neighbour = 0; neighbour < 4; neighbour++)
+        {
+            if ((spin_lattice(ensemble, rows[neighbour], cols[neighbour]) == seed) &&
+                ((next_random(random) >> 32) < threshold))
+            {
+                flip_spin_ising_2d(system, rows[neighbour], cols[neighbour]);
+                stack[top++] = rows[neighbour];
+                stack[top++] = cols[neighbour];
+                size++;
+            }
+        }
+    }
+
+    cluster -> grown++;
+    cluster -> flipped += size;
+    cluster -> clusters++;
+    cluster -> sizes += size;
+    return size;
+}
+
+
+/*
+ * evolve_wolff_2d
+ * ---------------
+ * Grow enough clusters to flip roughly steps spins. The number of clusters 
+ * is fixed before any are grown using the mean cluster size seen so far 
+ * at this temperature. Stopping as soon as steps spins have flipped would 
+ * favour measuring just after a large cluster and bias the observables. 
+ * No clusters have been grown at a temperature the first time the system 
+ * is evolved there, which happens at the start and after every change of 
+ * the temperature, so PILOT_WOLFF clusters are grown first on top of the 
+ * update to estimate the mean size at that temperature.
+ *
+ * parameters
+ * ----------
+ * Wolff2D *cluster: The workspace of the algorithm.
+ * Ising2D *system: The system to evolve.
+ * long steps: The number of spins to flip.
+ */
+void evolve_wolff_2d(Wolff2D *cluster, Ising2D *system, long steps)
+{
+    if (cluster -> temperature != system -> temperature)
+    {
+        build_threshold_wolff_2d(cluster, system -> temperature);
+    }
+
+    if (cluster -> grown == 0)
+    {
+        for (int pilot = 0; pilot < PILOT_WOLFF; pilot++)
+        {
+            system -> accepted += cluster_wolff_2d(cluster, system);
+        }
+    }
+
+    double mean_size = (double) cluster -> flipped / cluster -> grown;
+    long clusters = (long) ceil(steps / mean_size);
+
+    for (long grown = 0; grown < clusters; grown++)
+    {
+        system -> accepted += cluster_wolff_2d(cluster, system);
+    }
+}
+
+
+/*
+ * reset_wolff_2d
+ * --------------
+ * Forget the cluster sizes accumulated so far.
+ *
+ * parameters
+ * ----------
+ * Wolff2D *cluster: The workspace to reset.
+ */
+void reset_wolff_2d(Wolff2D *cluster)
+{
+    cluster -> clusters = 0;
+    cluster -> sizes = 0;
+}
+
+
+/*
+ * susceptibility_wolff_2d
+ * -----------------------
+ * The improved estimator of the susceptibility. The mean size of a Wolff 
+ * cluster is <M^2> / N so the susceptibility of the whole system, 
+ * <M^2> / T, follows from the cluster sizes alone. This has a much smaller 
+ * variance than the fluctuations of the magnetisation. Below the critical 
+ * temperature <M>^2 is not subtracted, as for the direct estimator 
+ * <M^2> / T.
+ *
+ * parameters
+ * ----------
+ * const Wolff2D *cluster: The workspace holding the accumulated sizes.
+ * float temperature: The temperature the clusters were grown at.
+ *
+ * returns
+ * -------
+ * double susceptibility: The susceptibility of the whole system, or zero 
+ *      if no clusters have been grown.
+ */
+double susceptibility_wolff_2d(const Wolff2D *cluster, float temperature)
+{
+    if (cluster -> clusters == 0)
+    {
+        return 0.;
+    }
+
+    double number = (double) cluster -> length * cluster -> length;
+    double mean_size = (double) cluster -> sizes / cluster -> clusters;
+    return number * mean_size / temperature;
+}
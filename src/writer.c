@@ -0,0 +1,367 @@
+#include<time.h>
+#include<stdio.h>
+#include<sched.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+#include<pthread.h>
+#include<stdatomic.h>
+#include"include/rng.h"
+#include"include/lattice.h"
+#include"include/checkpoint.h"
+#include"include/trajectory.h"
+#include"include/writer.h"
+
+
+/*
+ * backoff_writer
+ * --------------
+ * Wait a little while for the other side of the queue. The first few
+ * waits only yield the processor and later ones sleep so that an idle
+ * writer does not occupy a core.
+ *
+ * parameters
+ * ----------
+ * int *attempts: The number of times the caller has waited in a row.
+ */
+static void backoff_writer(int *attempts)
+{
+    if ((*attempts)++ < 16)
+    {
+        sched_yield();
+        return;
+    }
+
+    struct timespec pause = {0, 100000};
+    nanosleep(&pause, NULL);
+}
+
+
+/*
+ * run_writer
+ * ----------
+ * The body of the writer thread. Jobs are taken from the head of the
+ * queue in order until the writer is stopped and the queue is empty.
+ *
+ * parameters
+ * ----------
+ * void *context: The Writer.
+ *
+ * returns
+ * -------
+ * void *result: Always NULL.
+ */
+static void *run_writer(void *context)
+{
+    Writer *writer = (Writer*) context;
+    int attempts = 0;
+
+    while (1)
+    {
+        Slot *slot = &writer -> slots[writer -> head & writer -> mask];
+        size_t sequence = atomic_load_explicit(&slot -> sequence, memory_order_acquire);
+
+        if (sequence != writer -> head + 1)
+        {
+            if (atomic_load_explicit(&writer -> stopping, memory_order_acquire) &&
+                (atomic_load(&writer -> tail) == writer -> head))
+            {
+                return NULL;
+            }
+
+            backoff_writer(&attempts);
+            continue;
+        }
+
+        Job job = slot -> job;
+        void *item = slot -> item;
+        atomic_store_explicit(&slot -> sequence, writer -> head + writer -> mask + 1,
+            memory_order_release);
+        writer -> head++;
+        attempts = 0;
+
+        job(item);
+        atomic_fetch_add_explicit(&writer -> completed, 1, memory_order_release);
+    }
+}
+
+
+/*
+ * init_writer
+ * -----------
+ * Start a writer thread.
+ *
+ * parameters
+ * ----------
+ * int capacity: The number of jobs that can wait at once, rounded up to
+ *      a power of two. Every waiting job holds a copy of its data so this
+ *      bounds the memory used by the output.
+ *
+ * returns
+ * -------
+ * Writer *writer: The running writer. It must be stopped with
+ *      free_writer.
+ */
+Writer *init_writer(int capacity)
+{
+    size_t size = 1;
+    while (size < (size_t) capacity)
+    {
+        size <<= 1;
+    }
+
+    Writer *writer = (Writer*) calloc(1, sizeof(Writer));
+    writer -> mask = size - 1;
+    writer -> slots = (Slot*) calloc(size, sizeof(Slot));
+
+    for (size_t position = 0; position < size; position++)
+    {
+        atomic_init(&writer -> slots[position].sequence, position);
+    }
+
+    atomic_init(&writer -> tail, 0);
+    atomic_init(&writer -> completed, 0);
+    atomic_init(&writer -> stopping, 0);
+
+    if (pthread_create(&writer -> thread, NULL, run_writer, writer) != 0)
+    {
+        printf("Error: Could not start the writer thread");
+        exit(1);
+    }
+
+    return writer;
+}
+
+
+/*
+ * submit_writer
+ * -------------
+ * Add a job to the queue. A position is claimed by advancing the tail
+ * and the slot is published by advancing its sequence, so several
+ * threads can add jobs at once without a lock. If the queue is full the
+ * caller waits until the writer has made room.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The running writer.
+ * Job job: The job to run on the writer thread.
+ * void *item: The data of the job, owned by the job from now on.
+ */
+void submit_writer(Writer *writer, Job job, void *item)
+{
+    size_t position = atomic_load_explicit(&writer -> tail, memory_order_relaxed);
+    int attempts = 0;
+    Slot *slot;
+
+    while (1)
+    {
+        slot = &writer -> slots[position & writer -> mask];
+        size_t sequence = atomic_load_explicit(&slot -> sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&writer -> tail, &position,
+                position + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            backoff_writer(&attempts);
+            position = atomic_load_explicit(&writer -> tail, memory_order_relaxed);
+        }
+        else
+        {
+            position = atomic_load_explicit(&writer -> tail, memory_order_relaxed);
+        }
+    }
+
+    slot -> job = job;
+    slot -> item = item;
+    atomic_store_explicit(&slot -> sequence, position + 1, memory_order_release);
+}
+
+
+/*
+ * flush_writer
+ * ------------
+ * Wait until every job added so far has finished.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The running writer.
+ */
+void flush_writer(Writer *writer)
+{
+    size_t submitted = atomic_load(&writer -> tail);
+    int attempts = 0;
+
+    while (atomic_load_explicit(&writer -> completed, memory_order_acquire) < submitted)
+    {
+        backoff_writer(&attempts);
+    }
+}
+
+
+/*
+ * free_writer
+ * -----------
+ * Finish the outstanding jobs and stop the writer thread.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The running writer.
+ */
+void free_writer(Writer *writer)
+{
+    flush_writer(writer);
+    atomic_store_explicit(&writer -> stopping, 1, memory_order_release);
+    pthread_join(writer -> thread, NULL);
+    free(writer -> slots);
+    free(writer);
+}
+
+
+/*
+ * FrameJob
+ * --------
+ * A frame waiting to be added to a trajectory.
+ *
+ * parameters
+ * ----------
+ * TrajectoryWriter *trajectory: The trajectory to add to.
+ * Lattice *lattice: A copy of the spins.
+ * Frame frame: The parameters of the system.
+ */
+typedef struct FrameJob
+{
+    TrajectoryWriter    *trajectory;
+    Lattice             *lattice;
+    Frame               frame;
+} FrameJob;
+
+
+/*
+ * frame_job
+ * ---------
+ * Encode and write a frame on the writer thread.
+ *
+ * parameters
+ * ----------
+ * void *item: The FrameJob.
+ */
+static void frame_job(void *item)
+{
+    FrameJob *job = (FrameJob*) item;
+    write_frame_trajectory(job -> trajectory, job -> lattice, &job -> frame);
+    free_lattice(job -> lattice);
+    free(job);
+}
+
+
+/*
+ * frame_writer
+ * ------------
+ * Hand a copy of a lattice to the writer to be added to a trajectory.
+ * The trajectory must only be closed after the writer has been flushed.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The running writer.
+ * TrajectoryWriter *trajectory: The trajectory to add to.
+ * const Lattice *lattice: The spins to store.
+ * const Frame *frame: The parameters of the system.
+ */
+void frame_writer(
+    Writer *writer,
+    TrajectoryWriter *trajectory,
+    const Lattice *lattice,
+    const Frame *frame)
+{
+    FrameJob *job = (FrameJob*) malloc(sizeof(FrameJob));
+    job -> trajectory = trajectory;
+    job -> lattice = clone_lattice(lattice);
+    job -> frame = *frame;
+    submit_writer(writer, frame_job, job);
+}
+
+
+/*
+ * CheckpointJob
+ * -------------
+ * A checkpoint waiting to be written.
+ *
+ * parameters
+ * ----------
+ * char *file_name: The file to write.
+ * Checkpoint header: The header of the checkpoint.
+ * Lattice *lattice: A copy of the spins.
+ * Random *streams: A copy of the row streams.
+ */
+typedef struct CheckpointJob
+{
+    char        *file_name;
+    Checkpoint  header;
+    Lattice     *lattice;
+    Random      *streams;
+} CheckpointJob;
+
+
+/*
+ * checkpoint_job
+ * --------------
+ * Write a checkpoint on the writer thread.
+ *
+ * parameters
+ * ----------
+ * void *item: The CheckpointJob.
+ */
+static void checkpoint_job(void *item)
+{
+    CheckpointJob *job = (CheckpointJob*) item;
+    write_checkpoint(job -> file_name, &job -> header, job -> lattice, job -> streams);
+    free_lattice(job -> lattice);
+    free(job -> streams);
+    free(job -> file_name);
+    free(job);
+}
+
+
+/*
+ * checkpoint_writer
+ * -----------------
+ * Hand a copy of the state of a system to the writer to be saved as a
+ * checkpoint.
+ *
+ * parameters
+ * ----------
+ * Writer *writer: The running writer.
+ * const char *file_name: The file to write.
+ * const Checkpoint *header: The header built by init_checkpoint.
+ * const Lattice *lattice: The spins to store.
+ * const Random *streams: The header -> num_streams row streams.
+ */
+void checkpoint_writer(
+    Writer *writer,
+    const char *file_name,
+    const Checkpoint *header,
+    const Lattice *lattice,
+    const Random *streams)
+{
+    size_t size = header -> num_streams * sizeof(Random);
+    CheckpointJob *job = (CheckpointJob*) malloc(sizeof(CheckpointJob));
+    job -> file_name = strdup(file_name);
+    job -> header = *header;
+    job -> lattice = clone_lattice(lattice);
+    job -> streams = NULL;
+
+    if (size > 0)
+    {
+        job -> streams = (Random*) malloc(size);
+        memcpy(job -> streams, streams, size);
+    }
+
+    submit_writer(writer, checkpoint_job, job);
+}